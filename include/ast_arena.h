@@ -0,0 +1,47 @@
+#ifndef COM_AST_ARENA_H
+#define COM_AST_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define AST_BLOCK_SIZE 65536
+
+// Owns every syntax tree node of a compilation unit. Nodes are bump allocated in large blocks and are never
+// freed or destroyed one by one, so they must not own memory outside the arena. All blocks are released at once.
+class ast_arena_t {
+private:
+    std::vector<char*> blocks;
+
+    // Next free byte and end of the current block
+    char* current;
+    char* end;
+
+    // Starts a new block that can hold at least size bytes
+    void grow(size_t size);
+
+public:
+    ast_arena_t();
+    ~ast_arena_t();
+
+    ast_arena_t(const ast_arena_t&) = delete;
+    ast_arena_t& operator=(const ast_arena_t&) = delete;
+
+    void* allocate(size_t size, size_t alignment);
+
+    // Constructs a value initialized node in the arena
+    template <typename T>
+    T* create() {
+        return new (allocate(sizeof(T), alignof(T))) T();
+    }
+
+    // Copies the string into the arena
+    std::string_view copy_string(const std::string& str);
+
+    // Releases every node allocated so far, keeping the first block for reuse
+    void clear();
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef COM_CONSTANT_PROPAGATION_H
+#define COM_CONSTANT_PROPAGATION_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "parser_types.h"
+#include "type_table.h"
+
+// Tracks the values of local variables through the statements of a function and marks the identifiers
+// whose value is known there, see id_term_t::is_constant. Expressions of marked identifiers are folded by
+// evaluate() when translated, so conditions that become constant remove their dead branches. Only
+// variables whose address is never taken are tracked, since pointers could change them unseen
+class constant_propagation_t {
+
+    type_table_t* types;
+
+    // Known values keyed by the declaring var_decl_t
+    std::unordered_map<const node_t*, int> values;
+
+    // Visible declarations, one map per scope. Untracked declarations are nullptr so they hide outer ones
+    std::vector<std::unordered_map<symbol_t, const var_decl_t*>> scopes;
+
+    // Names of the variables whose address is taken anywhere in the function
+    std::unordered_set<symbol_t> address_taken;
+
+    const var_decl_t* lookup(symbol_t name);
+
+    // Sets the known value of the variable, or forgets it if value is nullptr or does not fit in its type
+    void assign(symbol_t name, const int* value, const node_t* node);
+
+    // Forgets the values of the variables assigned anywhere in the statement
+    void forget_assigned(stmt_t* stmt);
+
+    void visit_stmt(stmt_t* stmt);
+    void visit_expr(expr_t* e);
+
+    // Warns if the folded arithmetic or left shift overflows 32 bits
+    void check_overflow(binop_expr_t* binop);
+
+    void find_address_taken(stmt_t* stmt);
+    void find_address_taken(expr_t* e);
+
+public:
+    constant_propagation_t();
+
+    // Marks the identifiers of the function with known values
+    void run(func_decl_t* func, type_table_t* type_table);
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef COM_DEAD_CODE_H
+#define COM_DEAD_CODE_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "parser_types.h"
+
+// Follows the calls of the program from main and clears decl_t::used of the functions that are never
+// reached and of the globals those functions do not refer to, which are then not emitted. Also removes
+// the statements of a block that follow a return, break or continue
+class dead_code_eliminator_t {
+
+    // Function definitions by name
+    std::unordered_map<symbol_t, func_decl_t*> functions;
+
+    // Names of the functions called and the variables referred to by reached code
+    std::unordered_set<symbol_t> referenced;
+
+    // Reached functions whose bodies have not been visited yet
+    std::vector<func_decl_t*> pending;
+
+    int removed_functions;
+    int removed_globals;
+
+    void reference(symbol_t name);
+
+    // References the words of an inline assembly literal, which may name a function or a global
+    void reference_asm(const std::string_view& literal);
+
+    void visit_stmt(stmt_t* stmt);
+    void visit_expr(expr_t* e);
+
+    // Removes the statements following one that never continues with the next statement
+    void remove_unreachable(block_stmt_t* block);
+
+public:
+    dead_code_eliminator_t();
+
+    void run(program_t* program);
+
+    int get_removed_functions() const { return removed_functions; }
+    int get_removed_globals() const { return removed_globals; }
+};
+
+#endif
@@ -9,7 +9,7 @@
 
 
 
-void output_warning(const std::string& warning, const undoable_t* node);
+void output_warning(const std::string& warning, const node_t* node);
 
 int get_warning_count();
 
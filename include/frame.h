@@ -0,0 +1,42 @@
+#ifndef COM_FRAME_H
+#define COM_FRAME_H
+
+#include <set>
+
+#include "ir.h"
+
+// Finishes the frame of a translated function. The callee saved registers the function writes are pushed
+// before BP is set and popped before every return, which moves the parameters on the stack further from
+// BP. A function that never addresses anything through BP gets no frame: BP is not set, and if nothing is
+// pushed or called either, the stack pointer is not moved for its locals. A jump to another function is a
+// tail call, the registers are popped before it like before a return
+class frame_builder_t {
+
+    // Callee saved registers pushed by all functions
+    int saved;
+
+    // Functions left without a frame
+    int frameless;
+
+    int tail_calls;
+
+    // Functions that may set BP jumped to by the function being translated
+    std::set<std::string> frame_targets;
+
+public:
+    frame_builder_t();
+
+    // Returns true if the function does not change BP. The registers of main are not saved, as it returns
+    // to the startup code
+    bool build(ir_function_t& func, bool save_registers);
+
+    // Records a tail call of a function that may set BP. Callers save BP only around functions with a frame,
+    // so a function jumping to another that sets it keeps its frame
+    void jumps_to_frame(const std::string& name);
+
+    int get_saved() const { return saved; }
+    int get_frameless() const { return frameless; }
+    int get_tail_calls() const { return tail_calls; }
+};
+
+#endif
@@ -6,6 +6,10 @@
 
 #define POINTER_SIZE 2
 
+// Instructions a mul is counted as when multiplying by a constant, shifts and adds are used if they take
+// fewer. Each other instruction counts as one
+#define MULT_COST 1
+
 std::string strip_quotations(const std::string& string_literal);
 
 char char_literal_to_ascii(const std::string& char_literal);
@@ -28,23 +32,55 @@ var_info_t* push_temp(translator_t* t, int reg);
 
 int pop_temp(translator_t* t, var_info_t* var);
 
-int translate_binop_imm(translator_t* t, binop_expr_t* binop, const std::string& instr, const std::string& imm_instr);
+// Returns true if evaluating the expression calls a function, which does not preserve registers
+bool contains_call(expr_t* e);
+
+// Returns true if the expression is a variable other than target that is not read after the current statement,
+// so its register can be handed over instead of copied
+bool is_dying_variable(translator_t* t, expr_t* e, var_info_t* target);
+
+// Returns the register the result of an operation is written to, an operand register holding a
+// temporary or a variable at its last use if there is one, otherwise a new temporary
+int allocate_result(translator_t* t, const std::string& name, int left_register, int right_register = -1);
+
+// Translates the left operand of a binary operation, the operand is kept in a temporary if the right one calls a function
+int translate_left_operand(translator_t* t, binop_expr_t* binop, bool right_success);
+
+// Translates the right operand of a binary operation, the left operand is saved across function calls
+int translate_right_operand(translator_t* t, binop_expr_t* binop, int* left_register);
+
+int translate_binop_imm(translator_t* t, binop_expr_t* binop, ir_opcode_t op, ir_opcode_t imm_op);
+
+int translate_binop(translator_t* t, binop_expr_t* binop, ir_opcode_t op);
+
+// Emits rd = ra * value, as shifts and an add or sub if that is cheaper than loading the value for a mul.
+// rd may be ra
+void mult_imm(translator_t* t, int rd, int ra, int value);
+
+// Translates a multiplication, by a constant operand with mult_imm
+int translate_mult(translator_t* t, binop_expr_t* binop);
+
+int translate_binop_relational(translator_t* t, binop_expr_t* binop, ir_opcode_t branch_op);
 
-int translate_binop(translator_t* t, binop_expr_t* binop, const std::string& instr);
+// Emits the test of an if or while condition, jumping to false_label if it is false. Comparisons branch
+// directly on their flags, and &&, || and !, & and | of comparisons are translated into jumps instead of
+// 0 or 1 values. Returns the registers at false_label, translation continues with those of the true path
+register_state_t translate_condition(translator_t* t, expr_t* cond, const std::string& false_label);
 
-int translate_binop_relational(translator_t* t, binop_expr_t* binop, const std::string& instr);
+// Translates && or || into jumps that skip the right operand once the left one decides the result,
+// then sets the result register to 0 or 1
+int translate_logical(translator_t* t, binop_expr_t* binop);
 
 // Instruction functions
 
-void tri_operand_instr(translator_t* t, const std::string& instr, int rd, int ra, int rb);
+void tri_operand_instr(translator_t* t, ir_opcode_t op, int rd, int ra, int rb);
 
-void tri_operand_imm_instr(translator_t* t, const std::string& instr, int rd, int ra, int imm);
+void tri_operand_imm_instr(translator_t* t, ir_opcode_t op, int rd, int ra, int imm);
 
-void tri_operand_imm_str_instr(translator_t* t, const std::string& instr, int rd, int ra, const std::string& imm);
+void tri_operand_imm_str_instr(translator_t* t, ir_opcode_t op, int rd, int ra, const std::string& imm);
 
-void di_operand_instr(translator_t* t, const std::string& instr, int rd, int ra);
+void di_operand_instr(translator_t* t, ir_opcode_t op, int rd, int ra);
 
-void di_operand_imm_instr(translator_t* t, const std::string& instr, int rd, int im);
 
 
 
@@ -98,7 +134,7 @@ void cmpi_instr(translator_t* t, int ra, int imm);
 
 void print_label(translator_t* t, const std::string& label);
 
-void branch_instr(translator_t* t, const std::string& instr, const std::string& label);
+void branch_instr(translator_t* t, ir_opcode_t op, const std::string& label);
 
 std::string get_register_string(translator_t* t, int reg);
 
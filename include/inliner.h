@@ -0,0 +1,139 @@
+#ifndef COM_INLINER_H
+#define COM_INLINER_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ast_arena.h"
+#include "parser_types.h"
+
+// Largest body, counted in statements and expressions, of a function inlined without the inline keyword
+#define INLINE_MAX_SIZE 16
+
+// Inlined bodies are not expanded further than this many levels into each other
+#define INLINE_MAX_DEPTH 4
+
+// Replaces calls of small functions that are not recursive with copies of their bodies. A call is expanded
+// before the statement it is in: the arguments initialize copies of the parameters in a new block, followed
+// by the body, whose returns assign a variable that takes the place of the call. The body is wrapped in a
+// while (1) loop that returns break out of, unless the only return is its last statement. Only calls that
+// are evaluated first in their statement are expanded, or after reads of local variables the body can not
+// change, so the order of side effects is kept
+class inliner_t {
+
+    // What the inliner needs to know about a function body
+    struct summary_t {
+        func_decl_t* func = nullptr;
+
+        // Statements and expressions of the body
+        int size = 0;
+
+        int returns = 0;
+        bool has_asm = false;
+
+        // A break or continue that leaves the function, which is an error reported when it is translated
+        bool escaping_jump = false;
+
+        // Functions called and variables referred to that are not declared by the function
+        std::unordered_set<symbol_t> calls;
+        std::unordered_set<symbol_t> free_names;
+
+        // Variables whose address is taken
+        std::unordered_set<symbol_t> address_taken;
+
+        bool inlinable = false;
+    };
+
+    // Owns the nodes created by the inliner, which live as long as the translator
+    ast_arena_t arena;
+
+    // Summaries of the defined functions by name
+    std::unordered_map<symbol_t, summary_t> summaries;
+
+    // Variables declared in each scope, of the function summarized or rewritten
+    std::vector<std::unordered_set<symbol_t>> scopes;
+
+    // Function being rewritten
+    summary_t* caller;
+
+    // Parameter names of the body being copied, by scope. Names declared by the body hide them
+    std::vector<std::unordered_map<symbol_t, symbol_t>> renames;
+
+    // Variable the copied returns assign, or -1 if the value of the call is not used
+    symbol_t result;
+
+    // Loops entered in the body being copied, and whether returns break out of a wrapping loop
+    int copy_loops;
+    bool copy_wrapped;
+
+    int depth;
+    int next_id;
+    int expanded;
+
+    bool is_visible(symbol_t name) const;
+
+    // A local variable that no inlined body can change
+    bool is_safe(symbol_t name) const;
+
+    void reference(symbol_t name, summary_t& summary);
+
+    void summarize_stmt(stmt_t* stmt, summary_t& summary, int loops);
+    void summarize_expr(expr_t* e, summary_t& summary);
+
+    bool is_recursive(symbol_t name);
+
+    bool can_inline(call_term_t* call) const;
+
+    // First call of the statement that can be expanded before it, or nullptr
+    call_term_t* find_call(stmt_t* stmt);
+    call_term_t* find_call(expr_t* e, bool* blocked);
+
+    // Replaces the call in the statement with the variable holding its value
+    void replace_call(stmt_t* stmt, call_term_t* call, id_term_t* value);
+
+    template <typename T>
+    bool replace(T*& slot, call_term_t* call, id_term_t* value);
+
+    // Adds the statements that compute the value of the call to out, returns the variable holding it
+    id_term_t* expand(call_term_t* call, std::vector<stmt_t*>& out, bool result_used);
+
+    void rewrite_block(block_stmt_t* block);
+
+    // Rewrites a statement that is not in a block, wrapping it in one if statements are added before it
+    stmt_t* rewrite_stmt(stmt_t* stmt);
+
+    // Adds the statement to out with the calls it expands before it
+    void rewrite_into(stmt_t* stmt, std::vector<stmt_t*>& out);
+
+    symbol_t rename(symbol_t name) const;
+
+    // Copies the statement of the body being inlined into out, returns become assignments of result
+    void copy_into(stmt_t* stmt, std::vector<stmt_t*>& out);
+    stmt_t* copy_stmt(stmt_t* stmt);
+
+    // Copies the statement of an if or a while, in a block if it does not copy to a single statement
+    stmt_t* copy_branch(stmt_t* stmt);
+
+    expr_t* copy_expr(expr_t* e);
+    term_t* copy_term(term_t* t) { return static_cast<term_t*>(copy_expr(t)); }
+
+    template <typename T>
+    T* copy(const T* node);
+
+    // Creates a node located at the tokens of origin
+    template <typename T>
+    T* create(const node_t* origin);
+
+    template <typename L, typename E>
+    L* create_list(const std::vector<E*>& items, const node_t* origin);
+
+public:
+    inliner_t();
+
+    void run(program_t* program);
+
+    int get_expanded() const { return expanded; }
+};
+
+#endif
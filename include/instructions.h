@@ -12,6 +12,12 @@
 #define NOT_INSTR       "not"
 #define NEG_INSTR       "neg"
 
+// Shift, left is logical and right is arithmetic since all integer types are signed
+#define LSL_INSTR       "lsl"
+#define LSL_IMM_INSTR   "lsli"
+#define ASR_INSTR       "asr"
+#define ASR_IMM_INSTR   "asri"
+
 #define CMP_INSTR       "cmp"
 #define CMP_IMM_INSTR   "cmpi"
 
@@ -10,21 +10,81 @@ class translator_t;
 
 class parser_t;
 
-struct printable_t {
-    virtual std::string get_string(parser_t* p) = 0;
+// Concrete type of a syntax tree node, used to dispatch on nodes without virtual functions
+enum node_kind_t : unsigned char {
+    NODE_PROGRAM,
+    NODE_DECLS,
+    NODE_FUNC_DECL,
+    NODE_PARAM_DECLS,
+    NODE_PARAM_DECL,
+    NODE_PARAMS,
+    NODE_INIT_LIST,
+    NODE_ASM_PARAMS,
+    NODE_VAR_DECL,
+    NODE_SIMPLE_ARRAY_DECL,
+    NODE_INIT_LIST_ARRAY_DECL,
+    NODE_STR_ARRAY_DECL,
+    NODE_STMTS,
+    NODE_BLOCK_STMT,
+    NODE_IF_STMT,
+    NODE_WHILE_STMT,
+    NODE_ASM_STMT,
+    NODE_BREAK_STMT,
+    NODE_CONTINUE_STMT,
+    NODE_ASSIGNMENT_STMT,
+    NODE_DEREF_ASSIGNMENT_STMT,
+    NODE_INDEXED_ASSIGNMENT_STMT,
+    NODE_RETURN_STMT,
+    NODE_EXPR_STMT,
+    NODE_NEG_EXPR,
+    NODE_NOT_EXPR,
+    NODE_TERM_EXPR,
+    NODE_ID_TERM,
+    NODE_CALL_TERM,
+    NODE_EXPR_TERM,
+    NODE_ADDR_OF_TERM,
+    NODE_DEREF_TERM,
+    NODE_INDEXED_TERM,
+    NODE_LIT_TERM,
+    NODE_ADD_BINOP,
+    NODE_SUB_BINOP,
+    NODE_MULT_BINOP,
+    NODE_SHIFT_LEFT_BINOP,
+    NODE_SHIFT_RIGHT_BINOP,
+    NODE_AND_BINOP,
+    NODE_OR_BINOP,
+    NODE_LOGICAL_AND_BINOP,
+    NODE_LOGICAL_OR_BINOP,
+    NODE_EQ_BINOP,
+    NODE_NEQ_BINOP,
+    NODE_LESS_BINOP,
+    NODE_GREATER_BINOP,
+    NODE_LESS_EQ_BINOP,
+    NODE_GREATER_EQ_BINOP
 };
 
-struct undoable_t {
-    std::vector<lex::token*> tokens;
-    virtual void undo(parser_t* p) = 0;
-    
-    undoable_t() = default;
-    virtual ~undoable_t(){}
-};
+// Exactly sized array of pointers stored in the AST arena, so nodes own no memory outside of it
+template <typename T>
+struct node_array_t {
+    T** items = nullptr;
+    int count = 0;
+
+    T** begin() const { return items; }
+    T** end() const { return items + count; }
 
-struct translateable_t {
+    T* front() const { return items[0]; }
+    T* back() const { return items[count - 1]; }
+    T* operator[](int i) const { return items[i]; }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+};
 
-    virtual int translate(translator_t* t) = 0;
+// Every syntax tree node keeps the tokens it was built from, used to locate errors and warnings.
+// Nodes have no virtual functions, the concrete type is given by kind and set by its constructor
+struct node_t {
+    node_array_t<lex::token> tokens;
+    node_kind_t kind;
 };
 
 
@@ -0,0 +1,35 @@
+#ifndef COM_INTERNER_H
+#define COM_INTERNER_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <deque>
+
+// Small integer identifying an interned identifier, symbols are handed out densely from 0
+typedef int symbol_t;
+
+class interner_t {
+    
+    // Views point into names, a deque never moves its elements so they stay valid
+    std::unordered_map<std::string_view, symbol_t> symbols;
+    std::deque<std::string> names;
+
+public:
+    interner_t();
+
+    // Returns the symbol of the text, adding it if it has not been seen before
+    symbol_t intern(const char* text, int length);
+    symbol_t intern(const std::string& text);
+
+    const std::string& get_name(symbol_t symbol) const;
+    int size() const;
+};
+
+// The interner shared by the lexer, parser and symbol table
+interner_t& get_interner();
+
+// Returns the identifier text of a symbol
+const std::string& symbol_name(symbol_t symbol);
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef COM_IR_H
+#define COM_IR_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+
+// Operation of an IR instruction, one for every instruction in instructions.h
+enum ir_opcode_t : unsigned char {
+    IR_ADD,
+    IR_SUB,
+    IR_ADDI,
+    IR_SUBI,
+    IR_MUL,
+    IR_AND,
+    IR_OR,
+    IR_XOR,
+    IR_NOT,
+    IR_NEG,
+    IR_LSL,
+    IR_LSLI,
+    IR_ASR,
+    IR_ASRI,
+    IR_CMP,
+    IR_CMPI,
+    IR_BREQ,
+    IR_BRNE,
+    IR_BRLT,
+    IR_BRGT,
+    IR_BRLE,
+    IR_BRGE,
+    IR_JMP,
+    IR_MOVLO,
+    IR_MOVHI,
+    IR_MOVE,
+    IR_LOAD,
+    IR_STORE,
+    IR_CALL,
+    IR_RET,
+    IR_PUSH,
+    IR_POP,
+    IR_ASM          // Inline assembly, printed as written. Passes have to assume it reads and writes anything
+};
+
+// Register operand. Registers are numbered like the hardware registers, numbers at or above
+// REGISTER_COUNT are virtual registers that a pass has to map onto hardware ones before printing
+typedef int vreg_t;
+
+#define NO_REGISTER -1
+
+// Three-address instruction. Which fields are used depends on the opcode:
+//      add rd, ra, rb          addi rd, ra, imm        not rd, ra          cmp ra, rb      cmpi ra, imm
+//      lsl rd, ra, rb          lsli rd, ra, imm
+//      load[size] rd, ra, imm  store[size] ra, rb, imm push[size] ra       pop[size] rd
+//      movhi rd, rd, imm       breq symbol             call symbol         ret
+// An immediate is symbolic, like the address of a global, if symbol is not empty
+struct ir_instr_t {
+    ir_opcode_t op;
+    vreg_t rd;
+    vreg_t ra;
+    vreg_t rb;
+    int imm;
+    int size;
+    std::string symbol;
+
+    ir_instr_t(ir_opcode_t _op, vreg_t _rd = NO_REGISTER, vreg_t _ra = NO_REGISTER, vreg_t _rb = NO_REGISTER, int _imm = 0) :
+        op(_op), rd(_rd), ra(_ra), rb(_rb), imm(_imm), size(0) { }
+
+    bool is_branch() const { return op >= IR_BREQ && op <= IR_JMP; }
+
+    // Control does not continue with the next instruction
+    bool is_terminator() const { return op == IR_JMP || op == IR_RET; }
+
+    bool ends_block() const { return is_branch() || op == IR_RET; }
+
+    // Returns the register written by the instruction, NO_REGISTER if there is none
+    vreg_t get_def() const;
+
+    // Returns the registers read by the instruction
+    std::vector<vreg_t> get_uses() const;
+};
+
+// Straight-line sequence of instructions, entered only at its label and left only at its last instruction.
+// Blocks that follow a branch without a label of their own have an empty label
+struct ir_block_t {
+    std::string label;
+    std::vector<ir_instr_t> instrs;
+};
+
+// Instructions of one function in the order they are printed, the first block is labeled with the function name
+class ir_function_t {
+
+    std::vector<ir_block_t> blocks;
+
+public:
+    ir_function_t() = default;
+
+    // Appends the instruction, branches end the current block
+    void emit(const ir_instr_t& instr);
+
+    // Starts a new block with the label
+    void label(const std::string& name);
+
+    void clear();
+    bool empty() const { return blocks.empty(); }
+
+    // Number of instructions in all blocks
+    int size() const;
+
+    std::vector<ir_block_t>& get_blocks() { return blocks; }
+    const std::vector<ir_block_t>& get_blocks() const { return blocks; }
+
+    // Prints the assembly text, registers found in names are printed with that name
+    void print(std::ostream& out, const std::unordered_map<int, std::string>& names) const;
+};
+
+// Returns the mnemonic of the opcode, as defined in instructions.h
+const char* ir_opcode_name(ir_opcode_t op);
+
+// Prints one instruction as a line of assembly
+void ir_print_instr(std::ostream& out, const ir_instr_t& instr, const std::unordered_map<int, std::string>& names);
+
+#endif
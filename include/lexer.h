@@ -3,72 +3,91 @@
 
 #include <unordered_map>
 #include <string>
-#include <fstream>
-#include <regex>
+#include <vector>
 
 #include "tokens.h"
-
-#define BUFFER_SIZE 1048576
-#define READ_SIZE BUFFER_SIZE - 1
-
-#define MAX_TOKEN_SIZE 64
+#include "token_arena.h"
+#include "interner.h"
 
 namespace lex {
 
+    // States of the scanning automaton, see the transition table in lexer.cpp
+    enum dfa_state_t : unsigned char {
+        S_ERROR,
+        S_START,
+        S_ID,
+        S_ZERO,
+        S_INT,
+        S_HEX_PREFIX,
+        S_HEX,
+        S_CHAR_OPEN,
+        S_CHAR_ESCAPE,
+        S_CHAR_BODY,
+        S_CHAR,
+        S_STR_BODY,
+        S_STR,
+        S_WHITESPACE,
+        S_SLASH,
+        S_LINE_COMMENT,
+        S_LINE_COMMENT_END,
+        S_BLOCK_COMMENT,
+        S_BLOCK_COMMENT_STAR,
+        S_BLOCK_COMMENT_END,
+        S_SINGLE,
+        S_AMPERSAND,
+        S_BAR,
+        S_LOGICAL,
+        S_LESS,
+        S_GREATER,
+        S_SHIFT,
+        S_RELATIONAL,
+        S_RELATIONAL_EQ,
+        STATE_COUNT
+    };
+
     class lexer {
     private:
 
-        // Keyword map
-        std::unordered_map<std::string, tag_t> reserved_words;
         
-        // Input stream and double buffer
-        std::ifstream file;
-        char *buffer_1;
-        const char* buffer_1_end;
-
-        char *buffer_2;
-        const char* buffer_2_end;
-        // True if currently on buffer 1, false if on buffer 2
-        bool buffer_switch;
+        // The whole source text, terminated by '\0'. Either a memory mapping of the file or the contents of buffer
+        const char* source;
+        size_t mapped_size;
+        std::vector<char> buffer;
 
         // Pointers for reading
-        char *lexeme_start;
+        const char* lexeme_start;
+
+        // Owns every token handed out by get_next_token
+        token_arena_t token_arena;
 
         // Current line and column
         int line;
         int column;
         
-        // Regular expressions
-        std::regex identifier_regex;
-        std::regex int_literal_regex;
-        std::regex str_literal_regex;
-        std::regex whitespace_regex;
-        std::regex half_str_literal_regex;
-        std::regex char_literal_regex;
-        std::regex hex_literal_regex;
-
         // Converts an ASCII digit character to its corresponding integer digit
         int char_to_digit(char c);
         
-        // Reads from the file into the non-current buffer and switches to it
-        char* switch_buffer();
+        // Maps the file into memory, or reads it into buffer if it can not be mapped (pipes, stdin)
+        void read_source(const std::string& filename);
 
-        // Handles tokens that are split between two buffers, returns whether the search was successful or not
-        void handle_split(std::regex r, std::string& result, unsigned int size);
+        // Runs the automaton from state over str until a character has no transition. Returns a pointer to that character.
+        // The longest accepted prefix is reported through accepted and accept_end, accept_end is left untouched if nothing was accepted
+        const char* run_dfa(const char* str, dfa_state_t& state, dfa_state_t& accepted, const char*& accept_end);
 
-        // Returns a pointer to the current buffer being read from
-        char* get_current_buffer();
+        // Creates the token for an accepted lexeme and updates line and column, returns nullptr for whitespace and comments
+        token* make_token(dfa_state_t accepted, const char* text, int length);
 
-        const char* get_current_buffer_end();
-
-        int get_trailing_whitespace_count(const std::string& str);
+        int get_trailing_whitespace_count(const char* str, int length);
     public:
         lexer(std::string filename);
         ~lexer();
 
-        // Acquires the next token from the buffer
+        // Acquires the next token from the source
         token* get_next_token();
 
+        // Returns the source text of a string literal token
+        std::string get_lexeme(const token* t) const;
+
     };
 
 }
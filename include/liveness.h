@@ -0,0 +1,111 @@
+#ifndef COM_LIVENESS_H
+#define COM_LIVENESS_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "parser_types.h"
+
+// Live range of a local variable or parameter in statement positions of its function. A variable is
+// live from the statement declaring it to the last statement reading or writing it
+struct live_range_t {
+    int start;
+    int end;
+
+    // Variables whose address is taken may be read through pointers, so they are always live
+    bool address_taken;
+
+    // Number of references, each weighted by 10 per enclosing loop, used as spill cost
+    int weight;
+
+    // Register given to the variable by graph coloring, -1 if it has none
+    int home;
+
+    // Position of the last statement in a loop that makes a call while the variable is live, if it is used
+    // after that statement, otherwise -1. Outside of loops storing and loading the variable around a call
+    // costs no more than saving a callee saved register
+    int last_call;
+
+    // Register the parameter is passed in, -1 for other variables
+    int arrives_in;
+
+    // The statement at end refers to the variable more than once, so its first reference is not the last use
+    bool repeated_at_end;
+
+    live_range_t() : start(0), end(-1), address_taken(false), weight(0), home(-1), last_call(-1), arrives_in(-1), repeated_at_end(false) { }
+
+    bool is_live_at(int position) const { return address_taken || end >= position; }
+};
+
+// Assignment of one local variable to another, a candidate for coalescing
+struct copy_t {
+    const node_t* dest;
+    const node_t* src;
+    int position;
+};
+
+// Numbers the statements of a function in translation order and computes the live range of every
+// variable declared in it. Ranges of variables used inside a loop but declared outside of it cover the
+// whole loop, since the back edge makes them live in all of it
+class liveness_t {
+
+    // Ranges keyed by the declaring node, a param_decl_t, var_decl_t or array_decl_t
+    std::unordered_map<const node_t*, live_range_t> ranges;
+
+    // Visible declarations, one map per scope like the symbol table while translating
+    std::vector<std::unordered_map<symbol_t, const node_t*>> scopes;
+
+    // Start positions of the loops enclosing the statement being visited, and the variables referenced inside them
+    struct loop_t {
+        const stmt_t* stmt;
+        int start;
+        std::vector<live_range_t*> referenced;
+
+        // Names of the referenced variables with their number of references
+        std::vector<std::pair<symbol_t, int>> uses;
+    };
+    std::vector<loop_t> loops;
+
+    // Variables declared outside of each loop and used in it, most used first
+    std::unordered_map<const stmt_t*, std::vector<symbol_t>> loop_variables;
+
+    std::vector<copy_t> copies;
+
+    // Positions of the statements in loops that make calls
+    std::vector<int> calls;
+
+    int position;
+
+    // Returns the innermost declaration of the name, nullptr for globals
+    const node_t* lookup(symbol_t name);
+
+    void declare(symbol_t name, const node_t* decl);
+    void reference(symbol_t name, bool address_taken = false);
+
+    // Records a copy if the value is a local variable other than the destination
+    void copy(symbol_t dest, expr_t* value);
+
+    void visit_stmt(stmt_t* stmt);
+    void visit_expr(expr_t* e);
+
+public:
+    liveness_t();
+
+    // Replaces the ranges with those of the given function
+    void analyze(func_decl_t* func);
+
+    // Returns the range of the variable declared by the node, nullptr if it was not part of the analyzed function
+    const live_range_t* range_of(const node_t* decl) const;
+
+    // Returns true if the function declares an array or takes the address of a variable, pointers to its
+    // stack may exist then
+    bool has_addressed_locals() const;
+
+    // Returns the variables declared before the loop and used in it, ordered by number of uses in the loop
+    const std::vector<symbol_t>& variables_of(const stmt_t* loop) const;
+
+    std::unordered_map<const node_t*, live_range_t>& get_ranges() { return ranges; }
+    const std::vector<copy_t>& get_copies() const { return copies; }
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef COM_LOOP_INVARIANT_H
+#define COM_LOOP_INVARIANT_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ast_arena.h"
+#include "parser_types.h"
+#include "symbol_table.h"
+#include "type_table.h"
+
+// Values hoisted out of one loop at most, each of them takes a register through the loop
+#define LOOP_INVARIANT_MAX 4
+
+// Moves computations whose value does not change in a while loop in front of it. The value initializes a
+// new variable declared before the loop, which takes the place of the computation in the condition and
+// the body. Hoisted are arithmetic on literals and on local variables that the loop does not assign and
+// whose address is never taken, addresses of variables, and addresses of array elements whose index does
+// not change, which are then read and written through a pointer. Arithmetic can not fail, so it is computed
+// even if the loop never runs. Loops with inline assembly are left as they are
+class loop_invariant_motion_t {
+
+    // What the pass needs to know about a visible variable
+    struct variable_t {
+        int type = 0;
+        bool is_pointer = false;
+        bool is_array = false;
+        bool is_global = false;
+    };
+
+    // A value hoisted out of the loop being rewritten and the variable holding it. Element addresses are
+    // kept as the indexed term they replace
+    struct hoisted_t {
+        expr_t* value;
+        indexed_term_t* element;
+        var_decl_t* decl;
+    };
+
+    // Owns the nodes created by the pass, which live as long as the translator
+    ast_arena_t arena;
+
+    // Globals are looked up in the symbol table, the function is not translated yet
+    symbol_table_t* symbol_table;
+    type_table_t* types;
+
+    // Variables declared in each scope of the function
+    std::vector<std::unordered_map<symbol_t, variable_t>> scopes;
+
+    // Names of the variables whose address is taken anywhere in the function
+    std::unordered_set<symbol_t> address_taken;
+
+    // Names assigned or declared in the loop being rewritten
+    std::unordered_set<symbol_t> assigned;
+
+    std::vector<hoisted_t> hoisted;
+
+    int next_id;
+    int count;
+
+    // Returns false if the name is not a known variable
+    bool lookup(symbol_t name, variable_t* result);
+
+    void declare(symbol_t name, const variable_t& variable);
+
+    void find_address_taken(stmt_t* stmt);
+    void find_address_taken(expr_t* e);
+
+    // Adds the names the statement assigns or declares to assigned, returns false if it has inline assembly
+    bool collect_assigned(stmt_t* stmt);
+
+    // The value of the expression is the same in every iteration of the loop
+    bool is_invariant(expr_t* e);
+
+    // The address of the element is the same in every iteration of the loop
+    bool is_invariant_element(indexed_term_t* element);
+
+    // Returns the variable holding the value, hoisting it if there is room. Returns -1 if it is not hoisted
+    symbol_t hoist(expr_t* value, indexed_term_t* element);
+
+    // Replaces the invariant parts of the expression in the slot. The computation of a whole value that
+    // takes a single instruction is left, an assignment of the hoisted variable would cost as much
+    template <typename T>
+    void rewrite_expr(T*& slot, bool whole);
+
+    // Rewrites the expressions of a statement in the loop, returns the statement taking its place
+    stmt_t* rewrite_loop_stmt(stmt_t* stmt);
+
+    // Adds the declarations of the values hoisted out of the loop to out
+    void rewrite_loop(while_stmt_t* loop, std::vector<stmt_t*>& out);
+
+    void rewrite_block(block_stmt_t* block);
+
+    // Rewrites a statement that is not in a block, wrapping it in one if declarations are added before it
+    stmt_t* rewrite_stmt(stmt_t* stmt);
+
+    // Adds the statement to out, preceded by the declarations hoisted out of it if it is a loop
+    void rewrite_into(stmt_t* stmt, std::vector<stmt_t*>& out);
+
+    // Creates a node located at the tokens of origin
+    template <typename T>
+    T* create(const node_t* origin);
+
+public:
+    loop_invariant_motion_t();
+
+    void run(func_decl_t* func, symbol_table_t* symbols, type_table_t* type_table);
+
+    int get_hoisted() const { return count; }
+};
+
+#endif
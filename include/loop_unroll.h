@@ -0,0 +1,127 @@
+#ifndef COM_LOOP_UNROLL_H
+#define COM_LOOP_UNROLL_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ast_arena.h"
+#include "parser_types.h"
+#include "type_table.h"
+
+// Largest unrolled loop, counted in statements and expressions of the copies of its body
+#define UNROLL_MAX_SIZE 64
+
+// Most iterations of a loop counted before giving up, and of a loop fully unrolled because of unroll
+#define UNROLL_MAX_TRIPS 1024
+#define UNROLL_HINT_MAX_TRIPS 256
+
+// Unrolls counted while loops. A loop is counted when the statement before it in the same block sets a
+// local variable to a constant, its condition compares the variable to a value that evaluate() folds, and
+// its body ends by adding a constant to it. The trip count is then known, and a loop whose copies fit in
+// UNROLL_MAX_SIZE is replaced by one copy of the body per iteration, with the variable replaced by its
+// value, which removes the compare and the branches. Other loops are unrolled by the factor given on the
+// command line: the iterations left over are copied in front of the loop, whose body then runs the copies
+// of one iteration after each other. Runs after constant propagation, so bounds held in variables with a
+// known value fold
+class loop_unroller_t {
+
+    // What the pass needs to know about a visible variable
+    struct variable_t {
+        int type = 0;
+        bool is_pointer = false;
+        bool is_array = false;
+    };
+
+    // A counted loop: the variable goes from first by step, and has last as value after trips iterations
+    struct counter_t {
+        symbol_t name;
+        int first;
+        int step;
+        int last;
+        int trips;
+
+        // Where the variable is set before the loop in the out list of the block
+        int init;
+
+        // Statements of the body before the increment, which ends it
+        std::vector<stmt_t*> body;
+        stmt_t* increment;
+    };
+
+    // Owns the nodes created by the pass, which live as long as the translator
+    ast_arena_t arena;
+
+    type_table_t* types;
+    int factor;
+
+    // Variables declared in each scope of the function, globals are not in them
+    std::vector<std::unordered_map<symbol_t, variable_t>> scopes;
+
+    // Names of the variables whose address is taken anywhere in the function
+    std::unordered_set<symbol_t> address_taken;
+
+    // Variable replaced by value in the copies, -1 to copy it as it is
+    symbol_t counter;
+    int value;
+
+    int unrolled;
+
+    // Returns false if the name is not a local variable
+    bool lookup(symbol_t name, variable_t* result);
+
+    void declare(symbol_t name, const variable_t& variable);
+
+    void find_address_taken(stmt_t* stmt);
+    void find_address_taken(expr_t* e);
+
+    // Returns true if the statement can be copied into the unrolled loop: it does not assign or declare
+    // the name, has no inline assembly, and its breaks and continues stay in loops nested in it
+    bool can_copy(stmt_t* stmt, symbol_t name, int loops);
+
+    // Returns true if the name is read or written anywhere in the statement
+    bool refers_to(stmt_t* stmt, symbol_t name);
+    bool refers_to(expr_t* e, symbol_t name);
+
+    // Statements and expressions of the statement
+    int size(stmt_t* stmt);
+    int size(expr_t* e);
+
+    // Recognizes the counted loop, out holds the statements of the block before it
+    bool find_counter(while_stmt_t* loop, const std::vector<stmt_t*>& out, counter_t* result);
+
+    // Adds the statements taking the place of the loop to out, or returns false if it is left as it is
+    bool unroll(while_stmt_t* loop, std::vector<stmt_t*>& out, stmts_t* statements, int next);
+
+    // Adds copies of the statements of one iteration to out, in a block if they declare variables
+    void copy_iteration(const std::vector<stmt_t*>& body, std::vector<stmt_t*>& out, const node_t* origin);
+
+    void rewrite_block(block_stmt_t* block);
+
+    // Rewrites the loops nested in the statement, inner ones first
+    void rewrite_stmt(stmt_t* stmt);
+
+    stmt_t* copy_stmt(stmt_t* stmt);
+    expr_t* copy_expr(expr_t* e);
+    term_t* copy_term(term_t* t) { return static_cast<term_t*>(copy_expr(t)); }
+
+    template <typename T>
+    T* copy(const T* node);
+
+    // Creates a node located at the tokens of origin
+    template <typename T>
+    T* create(const node_t* origin);
+
+    template <typename L, typename E>
+    L* create_list(const std::vector<E*>& items, const node_t* origin);
+
+public:
+    loop_unroller_t();
+
+    // Loops that are not unrolled fully are unrolled by unroll_factor, unless it is 1
+    void run(func_decl_t* func, type_table_t* type_table, int unroll_factor);
+
+    int get_unrolled() const { return unrolled; }
+};
+
+#endif
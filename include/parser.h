@@ -5,11 +5,12 @@
 #include <unordered_map>
 #include <vector>
 #include <functional>
-#include <deque>
+#include <initializer_list>
 
 #include "tokens.h"
 #include "lexer.h"
 #include "interfaces.h"
+#include "ast_arena.h"
 
 /* Predefine syntax tree structs */
 struct program_t;
@@ -60,7 +61,6 @@ struct addr_of_term_t;
 struct indexed_term_t;
 
 struct asm_params_t;
-struct asm_param_t;
 // New binary operation system
 
 struct binop_expr_t;
@@ -69,7 +69,11 @@ struct add_binop_t;
 struct sub_binop_t;
 struct and_binop_t;
 struct or_binop_t;
+struct logical_and_binop_t;
+struct logical_or_binop_t;
 struct mult_binop_t;
+struct shift_left_binop_t;
+struct shift_right_binop_t;
 
 struct eq_binop_t;
 struct neq_binop_t;
@@ -95,7 +99,7 @@ public:
 
     const char* what() const noexcept { return msg.c_str(); }
 
-    static void throw_error(const std::string& message, const lex::token* node);
+    [[noreturn]] static void throw_error(const std::string& message, const lex::token* node);
 };
 
 class parser_t {
@@ -106,21 +110,53 @@ private:
 
     // Maps reserved types to their byte size
     // TODO: Implement proper type handling for composite types
-    std::unordered_map<std::string, int> type_map;
+    std::unordered_map<symbol_t, int> type_map;
     std::unordered_map<int, std::string> type_name_map;
 
-    // Tokens will be loaded into this double ended queue to be processed
-    std::deque<lex::token*> token_queue;
-    size_t current_pos;
+    // Owns every node of the syntax tree, the tree lives as long as the parser
+    ast_arena_t ast_arena;
+
+    // Tokens read ahead of the current position, used as a ring buffer. The grammar never needs to look
+    // further than MAX_LOOKAHEAD tokens ahead to decide which production to follow
+    static constexpr int MAX_LOOKAHEAD = 4;
+    lex::token* lookahead[MAX_LOOKAHEAD];
+    int lookahead_start;
+    int lookahead_count;
+
+    // First token of the declaration or statement currently being matched, used to report
+    // a production that could not be completed
+    const lex::token* construct_start;
+    bool matching_stmt;
 
     inline lex::token* get_token();
 
-    inline bool is_type(const std::string& s);
+    // Stores the tokens a node was built from in the AST arena
+    void store_tokens(node_t* node, std::initializer_list<lex::token*> tokens);
+
+    // Children of the lists currently being matched. Lists nest, so each list owns the elements
+    // pushed after the size it started at
+    std::vector<void*> list_scratch;
+
+    // Moves the children pushed since start into a new list node in the AST arena
+    template <typename T>
+    T* store_list(size_t start);
+
+    // Consumes the next token if it has the given tag, otherwise fails the current construct
+    inline lex::token* match_token(lex::tag_t tag);
+
+    // Throws a syntax error for the declaration or statement currently being matched
+    [[noreturn]] void throw_construct_error();
+
+    inline bool is_type(symbol_t s);
     inline bool is_type(const lex::token* t);
 
-    inline int get_type(const std::string& s);
-    inline int get_type(const lex::id_token* t);
-    
+    inline int get_type(symbol_t s);
+    inline int get_type(const lex::token* t);
+
+    // Returns the source text of a string literal token
+    inline std::string get_lexeme(const lex::token* t);
+
+
     // Construct specific matching functions
     program_t* match_program();
     decls_t* match_decls();
@@ -135,7 +171,7 @@ private:
     params_t* match_params();
 
     asm_params_t* match_asm_params();
-    asm_param_t* match_asm_param();
+    term_t* match_asm_param();
     
     stmt_t* match_stmt();
     stmts_t* match_stmts();
@@ -143,21 +179,16 @@ private:
     expr_t* match_expr();
     term_t* match_term();
 
-    // Production specific matching functions
-    decls_t* match_decls_1();
-    decls_t* match_decls_2();
-
-    var_decl_t* match_decl_var_1();
-    var_decl_t* match_decl_var_2();
+    // Matches an expression where a malformed expression fails the whole construct
+    expr_t* match_construct_expr();
 
+    // Production specific matching functions
     init_list_t* match_init_list();
 
-    simple_array_decl_t* match_decl_array_simple();
-    init_list_array_decl_t* match_decl_array_init_list();
-    str_array_decl_t* match_decl_array_str();
-
-    func_decl_t* match_decl_func_1();
-    func_decl_t* match_decl_func_2();
+    // The array declaration productions share the prefix type id [ which is matched by match_decl_array
+    simple_array_decl_t* match_decl_array_simple(std::vector<lex::token*>& prefix_tokens);
+    init_list_array_decl_t* match_decl_array_init_list(std::vector<lex::token*>& prefix_tokens);
+    str_array_decl_t* match_decl_array_str(std::vector<lex::token*>& prefix_tokens);
 
     block_stmt_t* match_stmt_block();
     if_stmt_t* match_stmt_if();
@@ -165,22 +196,18 @@ private:
     asm_stmt_t* match_stmt_asm();
     break_stmt_t* match_stmt_break();
     continue_stmt_t* match_stmt_continue();
-    var_decl_t* match_stmt_decl();
     assignment_stmt_t* match_stmt_assign();
     deref_assignment_stmt_t* match_stmt_assign_deref();
-    indexed_assignment_stmt_t* match_stmt_assign_indexed();
+    stmt_t* match_stmt_indexed();
     return_stmt_t* match_stmt_return();
-    expr_stmt_t* match_stmt_expr();
-
-    stmts_t* match_stmts_1();
-    stmts_t* match_stmts_2();
+    expr_stmt_t* match_stmt_expr(term_t* first);
 
-    binop_expr_t* match_expr_binop();
     binop_expr_t* match_binop();
+    expr_t* match_operand();
+    expr_t* match_expr_binop(expr_t* left, int min_precedence);
 
     neg_expr_t* match_expr_negated();
     not_expr_t* match_expr_not();
-    term_t* match_expr_term();
 
     id_term_t* match_term_identifier();
     lit_term_t* match_term_literal();
@@ -196,8 +223,7 @@ public:
 
     program_t* parse_token_stream();
     std::string get_type_name(int type);
-    void put_back_token(lex::token* t);
-    const lex::token* peek();
+    const lex::token* peek(int k = 0);
 };
 
 #endif
\ No newline at end of file
@@ -2,8 +2,10 @@
 #define COM_PARSER_TYPES_H
 
 #include <string>
+#include <string_view>
 
 #include "interfaces.h"
+#include "interner.h"
 
 /* First tier C-- grammar
 
@@ -31,6 +33,7 @@
 
     func_decl   ->  type id ( param_decls ) ;
                 |   type id ( param_decls ) block_stmt
+                |   inline type id ( param_decls ) block_stmt
 
     param_decls ->  param_decl param_decls
                 |   e
@@ -58,20 +61,22 @@
 
     block_stmt  ->  { stmts }
 
-    expr        ->  term binop expr
-                |   "-" term
+    expr        ->  operand binop expr
+                |   operand
+
+    operand     ->  "-" term
                 |   "!" term
                 |   term
 
-    binop       ->  "+"
-                |   "-"
-                |   "*"
-                |   "=="
-                |   "!="
-                |   ">="
-                |   "<="
+    binop       ->  "*"                         // Highest precedence
+                |   "+" | "-"
+                |   "<<" | ">>"
+                |   "<" | ">" | "<=" | ">="
+                |   "==" | "!="
                 |   "&"
                 |   "|"
+                |   "&&"
+                |   "||"                        // Lowest precedence, all are left associative
 
     term        ->  id
                 |   literal
@@ -141,7 +146,6 @@ struct addr_of_term_t;
 struct indexed_term_t;
 
 struct asm_params_t;
-struct asm_param_t;
 
 // New binary operation system
 
@@ -151,7 +155,11 @@ struct add_binop_t;
 struct sub_binop_t;
 struct and_binop_t;
 struct or_binop_t;
+struct logical_and_binop_t;
+struct logical_or_binop_t;
 struct mult_binop_t;
+struct shift_left_binop_t;
+struct shift_right_binop_t;
 
 struct eq_binop_t;
 struct neq_binop_t;
@@ -166,117 +174,125 @@ class parser_t;
 class translator_t;
 struct func_info_t;
 
-struct program_t : undoable_t, printable_t, translateable_t {
+struct program_t : node_t {
     decls_t* decls;
 
-    program_t() = default;
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    program_t() { kind = NODE_PROGRAM; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+};
+
+// Base of all statements and declarations
+struct stmt_t : node_t {
+
+    // Position of the statement and of the last statement nested in it, numbered by the liveness analysis
+    int position = 0;
+    int last_position = 0;
+
+    // Dispatched on kind to the node type
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 /*      Declarations      */
-struct decls_t : undoable_t, printable_t, translateable_t {
-    decl_t*   first;
-    decls_t*  rest;
+struct decls_t : node_t, node_array_t<decl_t> {
 
-    decls_t() = default;
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    decls_t() { kind = NODE_DECLS; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
-struct decl_t : virtual undoable_t, virtual printable_t, virtual translateable_t {
-    
-    decl_t() = default;
+// Declarations may also appear as statements, except for functions which the parser only accepts at the top level
+struct decl_t : stmt_t {
+
+    // Cleared by the dead code elimination for functions not reached from main and globals not referred to,
+    // which are translated but not emitted
+    bool used = true;
 };
 
 struct func_decl_t : decl_t {
     int type;
-    std::string id;
+    symbol_t id;
     param_decls_t* param_list;
     block_stmt_t* stmt;
 
-    func_decl_t() = default;
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    // Declared with the inline keyword, inlined whatever the size of its body
+    bool is_inline = false;
+
+    func_decl_t() { kind = NODE_FUNC_DECL; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 /* ---------------------- */
 
 /*       Parameters       */
 
-struct param_decls_t : undoable_t, virtual printable_t {
-    param_decl_t* first;
-    param_decls_t* rest;
+struct param_decls_t : node_t, node_array_t<param_decl_t> {
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t, func_info_t* f, int param_index);
+    param_decls_t() { kind = NODE_PARAM_DECLS; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t, func_info_t* f);
 };
 
-struct param_decl_t : undoable_t, virtual printable_t {
+struct param_decl_t : node_t {
     int type;
-    std::string id;
+    symbol_t id;
     bool is_pointer;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
+    param_decl_t() { kind = NODE_PARAM_DECL; }
+    std::string get_string(parser_t* p);
+
+    // Returns the stack space to allocate for a parameter passed in a register
     int translate(translator_t* t, func_info_t* f, int param_index);
 };
 
-struct params_t : undoable_t, virtual printable_t {
-    expr_t* first;
-    params_t* rest;
+struct params_t : node_t, node_array_t<expr_t> {
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t, func_info_t* func, int param_index);
-};
+    params_t() { kind = NODE_PARAMS; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t, func_info_t* func);
 
-struct init_list_t : undoable_t, printable_t {
+    // Pushes a single argument on the stack
+    int translate_param(translator_t* t, func_info_t* func, expr_t* param, int param_index);
 
-    expr_t* first;
-    init_list_t* rest;
-
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
+    // Evaluates the arguments passed in registers, after those on the stack, into temporaries. Fills registers
+    // with the register holding each one, they stay allocated until the context is stored for the call
+    void translate_registers(translator_t* t, std::vector<int>& registers);
 };
 
-struct asm_params_t : undoable_t, virtual printable_t, translateable_t {
-
-    asm_param_t* first;
-    asm_params_t* rest;
+struct init_list_t : node_t, node_array_t<expr_t> {
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    init_list_t() { kind = NODE_INIT_LIST; }
+    std::string get_string(parser_t* p);
 };
 
-struct asm_param_t : virtual undoable_t, virtual printable_t, virtual translateable_t { };
+// Parameters of inline assembly are identifiers or literals
+struct asm_params_t : node_t, node_array_t<term_t> {
 
+    asm_params_t() { kind = NODE_ASM_PARAMS; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+};
 
 /* ---------------------- */
 
 /*       Statements       */
 
-struct stmt_t : virtual undoable_t, virtual printable_t, virtual translateable_t { };
-
-struct var_decl_t : decl_t, stmt_t {
+struct var_decl_t : decl_t {
     int type;
-    std::string id;
+    symbol_t id;
     bool is_pointer;
     expr_t* value;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    var_decl_t() { kind = NODE_VAR_DECL; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
-struct array_decl_t : decl_t, stmt_t {
+struct array_decl_t : decl_t {
     int type;
-    std::string identifier;
+    symbol_t identifier;
 
 };
 
@@ -284,44 +300,43 @@ struct simple_array_decl_t : array_decl_t {
 
     expr_t* size;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    simple_array_decl_t() { kind = NODE_SIMPLE_ARRAY_DECL; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct init_list_array_decl_t : array_decl_t {
     
     init_list_t* init_list;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    init_list_array_decl_t() { kind = NODE_INIT_LIST_ARRAY_DECL; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct str_array_decl_t : array_decl_t {
 
-    std::string string_literal;
+    // Source text of the literal, quotation marks included, stored in the AST arena
+    std::string_view string_literal;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    str_array_decl_t() { kind = NODE_STR_ARRAY_DECL; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
-struct stmts_t : undoable_t, printable_t, translateable_t {
-    stmt_t* first;
-    stmts_t* rest;
+struct stmts_t : node_t, node_array_t<stmt_t> {
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    stmts_t() { kind = NODE_STMTS; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct block_stmt_t : stmt_t {
     stmts_t* statements;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    block_stmt_t() { kind = NODE_BLOCK_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct if_stmt_t : stmt_t {
@@ -329,333 +344,345 @@ struct if_stmt_t : stmt_t {
     stmt_t* actions;
     stmt_t* else_actions;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    if_stmt_t() { kind = NODE_IF_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct while_stmt_t : stmt_t {
     expr_t* cond;
     stmt_t* actions;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    // Preceded by unroll, the loop is unrolled fully regardless of its size, see loop_unroller_t
+    bool is_unroll = false;
+
+    while_stmt_t() { kind = NODE_WHILE_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct asm_stmt_t : stmt_t {
     
-    std::string literal;
+    // Stored in the AST arena
+    std::string_view literal;
     asm_params_t* params;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    asm_stmt_t() { kind = NODE_ASM_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct break_stmt_t : stmt_t {
     int loop_id;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    break_stmt_t() { kind = NODE_BREAK_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct continue_stmt_t : stmt_t {
     int loop_id;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    continue_stmt_t() { kind = NODE_CONTINUE_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct assignment_stmt_t : stmt_t {
-    std::string identifier;
+    symbol_t identifier;
     expr_t* rvalue;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    assignment_stmt_t() { kind = NODE_ASSIGNMENT_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct deref_assignment_stmt_t : stmt_t {
     
-    std::string identifier;
+    symbol_t identifier;
     expr_t* rvalue;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    deref_assignment_stmt_t() { kind = NODE_DEREF_ASSIGNMENT_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct indexed_assignment_stmt_t : stmt_t {
     
-    std::string identifier;
+    symbol_t identifier;
     expr_t* index;
     expr_t* rvalue;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    indexed_assignment_stmt_t() { kind = NODE_INDEXED_ASSIGNMENT_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct return_stmt_t : stmt_t {
     expr_t* return_value;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    return_stmt_t() { kind = NODE_RETURN_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 struct expr_stmt_t : stmt_t {
     expr_t* e;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
+    expr_stmt_t() { kind = NODE_EXPR_STMT; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
 };
 
 /* ---------------------- */
 
-struct expr_t : virtual undoable_t, virtual printable_t, virtual translateable_t {
-    virtual bool evaluate(int* result) = 0;
+struct expr_t : node_t {
+
+    // Dispatched on kind to the node type
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
+
+    bool is_binop() const { return kind >= NODE_ADD_BINOP && kind <= NODE_GREATER_EQ_BINOP; }
 };
 
 struct neg_expr_t : expr_t {
     term_t* value;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    neg_expr_t() { kind = NODE_NEG_EXPR; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
 };
 
 struct not_expr_t : expr_t {
     term_t* value;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    not_expr_t() { kind = NODE_NOT_EXPR; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
 };
 
 struct term_expr_t : expr_t {
     term_t* t;
 
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    term_expr_t() { kind = NODE_TERM_EXPR; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
 };
 
 struct term_t : expr_t {
     bool is_literal;
-
-    virtual void undo(parser_t* p) override;
-    virtual bool evaluate(int* result) = 0;
 };
 
-struct id_term_t : term_t, asm_param_t {
-    std::string identifier;
+struct id_term_t : term_t {
+    symbol_t identifier;
 
-    id_term_t() { is_literal = false; }
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    // Value of the variable at this point, if known by the constant propagation of the function
+    bool is_constant = false;
+    int constant = 0;
+
+    id_term_t() { kind = NODE_ID_TERM; is_literal = false; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
 };
 
 struct call_term_t : term_t {
-    std::string function_identifier;
+    symbol_t function_identifier;
     params_t* params;
 
-    call_term_t() { is_literal = false; }
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    call_term_t() { kind = NODE_CALL_TERM; is_literal = false; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
+
+    // Returns true if the call can be translated by translate_jump when its value is returned
+    bool can_jump(translator_t* t);
+
+    // Tail call: moves the arguments into their registers, pops the locals and jumps to the function, which
+    // returns to the caller of the current one
+    int translate_jump(translator_t* t);
 };
 
 struct expr_term_t : term_t {
     expr_t* expr;
 
-    expr_term_t() { is_literal = false; }
-    void undo(parser_t* p) override;
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    expr_term_t() { kind = NODE_EXPR_TERM; is_literal = false; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
 };
 
 struct addr_of_term_t : term_t {
-    std::string identifier;
+    symbol_t identifier;
 
-    void undo(parser_t* p) override;
-    addr_of_term_t() { is_literal = false; }
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    addr_of_term_t() { kind = NODE_ADDR_OF_TERM; is_literal = false; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
 };
 
 struct deref_term_t : term_t {
-    std::string identifier;
+    symbol_t identifier;
 
-    void undo(parser_t* p) override;
-    deref_term_t() { is_literal = false; }
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    deref_term_t() { kind = NODE_DEREF_TERM; is_literal = false; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
 };
 
 struct indexed_term_t : term_t {
     
-    std::string identifier;
+    symbol_t identifier;
     expr_t* index;
 
-    void undo(parser_t* p) override;
-    indexed_term_t() { is_literal = false; }
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    indexed_term_t() { kind = NODE_INDEXED_TERM; is_literal = false; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
 };
 
-struct lit_term_t : term_t, asm_param_t {
+struct lit_term_t : term_t {
     int literal;
 
-    lit_term_t() { is_literal = true; }
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* t) override;
-    bool evaluate(int* result) override;
+    lit_term_t() { kind = NODE_LIT_TERM; is_literal = true; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* t);
+    bool evaluate(int* result);
 };
 
 // New binary operation system
 
 struct binop_expr_t : expr_t {
     
-    // if left assoc this is the right term, if right assoc this is the left term
-    expr_t* term; 
-    
-    // The rest
-    expr_t* rest; 
-    
-    // Associativity
-    bool left_assoc;
+    // Operands, built with precedence and left associativity by the parser
+    expr_t* left;
+    expr_t* right;
 
-    void undo(parser_t* p) override;
-    binop_expr_t() : term(nullptr), rest(nullptr), left_assoc(false) { }
-
-    // Note that this transfers tokens aswell
-    virtual binop_expr_t* duplicate() = 0;
-    
-    static expr_t* rewrite(expr_t* e);
+    binop_expr_t() : left(nullptr), right(nullptr) { }
 };
 
 // Arithmetic addition
 struct add_binop_t : binop_expr_t {
-    add_binop_t() : binop_expr_t() {}
-
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    add_binop_t* duplicate() override;
+    add_binop_t() { kind = NODE_ADD_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Arithmetic subtraction
 struct sub_binop_t : binop_expr_t {
-    sub_binop_t() : binop_expr_t() {}
-
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    sub_binop_t* duplicate() override;
+    sub_binop_t() { kind = NODE_SUB_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Arithmetic multiplication
 struct mult_binop_t : binop_expr_t {
-    mult_binop_t() : binop_expr_t() {}
+    mult_binop_t() { kind = NODE_MULT_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
+};
+
+// Shift left, by the number of bits given by the right operand
+struct shift_left_binop_t : binop_expr_t {
+    shift_left_binop_t() { kind = NODE_SHIFT_LEFT_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
+};
 
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    mult_binop_t* duplicate() override;
+// Arithmetic shift right, the sign bit is kept
+struct shift_right_binop_t : binop_expr_t {
+    shift_right_binop_t() { kind = NODE_SHIFT_RIGHT_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Logical and
 struct and_binop_t : binop_expr_t {
-    and_binop_t() : binop_expr_t() {}
-
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    and_binop_t* duplicate() override;
+    and_binop_t() { kind = NODE_AND_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Logical or
 struct or_binop_t : binop_expr_t {
-    or_binop_t() : binop_expr_t() {}
+    or_binop_t() { kind = NODE_OR_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
+};
 
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    or_binop_t* duplicate() override;
+// Short-circuit and, the right operand is only evaluated if the left one is not zero
+struct logical_and_binop_t : binop_expr_t {
+    logical_and_binop_t() { kind = NODE_LOGICAL_AND_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
+};
+
+// Short-circuit or, the right operand is only evaluated if the left one is zero
+struct logical_or_binop_t : binop_expr_t {
+    logical_or_binop_t() { kind = NODE_LOGICAL_OR_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Relational equal
 struct eq_binop_t : binop_expr_t {
-    eq_binop_t() : binop_expr_t() {}
-
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    eq_binop_t* duplicate() override;
+    eq_binop_t() { kind = NODE_EQ_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Relational not-equal
 struct neq_binop_t : binop_expr_t {
-    neq_binop_t() : binop_expr_t() {}
-
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    neq_binop_t* duplicate() override;
+    neq_binop_t() { kind = NODE_NEQ_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Relational less
 struct less_binop_t : binop_expr_t {
-    less_binop_t() : binop_expr_t() {}
-
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    less_binop_t* duplicate() override;
+    less_binop_t() { kind = NODE_LESS_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Relational greater
 struct greater_binop_t : binop_expr_t {
-    greater_binop_t() : binop_expr_t() {}
-
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    greater_binop_t* duplicate() override;
+    greater_binop_t() { kind = NODE_GREATER_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Relational less or equal
 struct less_eq_binop_t : binop_expr_t {
-    less_eq_binop_t() : binop_expr_t() {}
-
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    less_eq_binop_t* duplicate() override;
+    less_eq_binop_t() { kind = NODE_LESS_EQ_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 // Relational greater or equal
 struct greater_eq_binop_t : binop_expr_t {
-    greater_eq_binop_t() : binop_expr_t() {}
-
-    std::string get_string(parser_t* p) override;
-    int translate(translator_t* p) override;
-    bool evaluate(int* result) override;
-    greater_eq_binop_t* duplicate() override;
+    greater_eq_binop_t() { kind = NODE_GREATER_EQ_BINOP; }
+    std::string get_string(parser_t* p);
+    int translate(translator_t* p);
+    bool evaluate(int* result);
 };
 
 #endif
\ No newline at end of file
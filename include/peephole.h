@@ -0,0 +1,22 @@
+#ifndef COM_PEEPHOLE_H
+#define COM_PEEPHOLE_H
+
+#include "ir.h"
+
+// Rewrites short instruction sequences of a function into cheaper ones, by the patterns in the table of
+// peephole.cpp. A pattern looks at the instructions starting at one position of a block
+class peephole_optimizer_t {
+
+    // Instructions removed from all optimized functions
+    int removed;
+
+public:
+    peephole_optimizer_t();
+
+    // Applies the patterns until none of them matches, returns the number of instructions removed
+    int optimize(ir_function_t& func);
+
+    int get_removed() const { return removed; }
+};
+
+#endif
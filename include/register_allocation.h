@@ -1,6 +1,7 @@
 #ifndef COM_REGISTER_ALLOC_H
 #define COM_REGISTER_ALLOC_H
 
+#include <unordered_set>
 #include <vector>
 
 #include "symbol_table.h"
@@ -10,10 +11,18 @@ class translator_t;
 #define REGISTER_COUNT  16
 #define RESERVE_COUNT   4
 
+// Registers below CALLER_SAVED_COUNT may be changed by a call. The other allocatable registers keep their
+// values across calls, a function pushes those it writes on entry and pops them before returning
+#define CALLER_SAVED_COUNT      6
+
+// The first arguments of a call are passed in r0 and up, the rest are pushed to the stack
+#define REGISTER_PARAM_COUNT    4
+
 struct reg_t {
     int index;
     var_info_t* content;
     long last_changed;
+    int position;       // Statement position at which the content was last allocated or touched
     
     bool locked;        // The register is temporarily locked and cannot be modified
     bool changed;       // Keeps track of if the register value has changed since loading the variable
@@ -23,13 +32,39 @@ struct reg_t {
     reg_t();
 };
 
+// Contents of every register at a point of the program, indexed by register
+typedef std::vector<reg_t> register_state_t;
+
 class register_allocator_t {
 
     std::vector<reg_t*> registers;
     translator_t* parent;
 
+    // Position of the statement being translated, see liveness_t
+    int position;
+
     reg_t* get_register(int index);
-    void free(reg_t* reg, bool store, bool sort = true);
+    void free(reg_t* reg, bool store);
+
+    // Gives the register to the variable, storing the previous content if needed
+    void assign(reg_t* reg, var_info_t* var, bool load_variable, bool temp);
+
+    void load(reg_t* reg, var_info_t* var);
+    void write_back(reg_t* reg);
+
+    // Returns true if the content of the register is never read again and can be discarded without storing
+    bool is_dead(const reg_t* reg);
+
+    // Picks the register to allocate next, see allocate. Ties go to a callee saved register if preserved is set,
+    // otherwise to a caller saved one
+    reg_t* choose_register(bool preserved);
+
+    // Returns true if the variable is live across a call in a loop at or after the current statement, so it
+    // is best kept in a register the call does not change
+    bool is_preserved(const var_info_t* var);
+
+    // Returns the home register given to the variable by graph coloring if it can be used, otherwise nullptr
+    reg_t* choose_home(var_info_t* var);
 
 public:
 
@@ -38,6 +73,13 @@ public:
 
     void set_parent(translator_t* _parent);
 
+    // Sets the position of the statement being translated, registers whose content is not live at the
+    // position are reused first and are never stored. Outside of functions the position is 0
+    void set_position(int _position);
+
+    // Returns true if the variable is a local that is not read after the current statement, nor again in it
+    bool is_last_use(var_info_t* var);
+
     int allocate(var_info_t* var_to_alloc, bool load_variable, bool temp);
 
     bool already_allocated(var_info_t* var);
@@ -48,12 +90,69 @@ public:
     // If a given variable is stored in a register, frees it and potentially stores
     void free(var_info_t* var, bool store);
 
+    // Frees the registers a call may change, storing changed variables. Local variables in callee saved
+    // registers stay there, unless their address is taken. Preserved variables in caller saved registers
+    // are moved to a free callee saved register if there is one
     void store_context();
+
+    // Frees the variables whose address is taken, storing them if they changed
+    void release_address_taken();
+
+    // Frees all registers holding temporaries, their values stay in the registers until overwritten
+    void free_temporaries();
+
+    // Frees the temporaries that are not in the state, those of an enclosing expression stay allocated
+    void free_temporaries(const register_state_t& keep);
+
+    // Returns the contents of the registers, see reconcile. States do not carry locks
+    register_state_t get_state();
+
+    // Replaces the contents of the registers without emitting code, used when translation continues
+    // on a path whose registers are known to be in the state, like the else branch of an if statement.
+    // Locks stay as they are
+    void set_state(const register_state_t& state);
+
+    // Returns the variables and temporaries both states keep in the same register. Unlike join_state nothing
+    // else is dropped, so the result is valid on both paths without emitting code as long as the dropped
+    // registers were unchanged
+    register_state_t common_state(const register_state_t& a, const register_state_t& b);
+
+    // Locks the registers holding changed variables or temporaries and returns the previous locks. A locked
+    // register is never given to another variable, so its value stays where earlier branches left it
+    std::vector<bool> lock_registers();
+
+    // Puts back the locks returned by lock_registers
+    void restore_locks(const std::vector<bool>& locks);
+
+    // Number of registers lock_registers would lock
+    int count_lockable();
+
+    // Stores the changed variables, they stay in their registers
+    void store_changed();
+
+    // Returns the contents two paths agree on, without variables that are dead or whose address is taken
+    register_state_t join_state(const register_state_t& a, const register_state_t& b);
+
+    // Returns the current contents that may be kept at the start of a loop. The variables the loop assigns
+    // are marked as changed, so that the back edge never has to store them, nullptr marks every variable.
+    // Array bases are addresses, they are never changed
+    register_state_t loop_state(const std::unordered_set<symbol_t>* assigned);
+
+    // Emits the stores and loads that bring the registers into the state, used where control flow joins.
+    // Variables in registers the state does not agree with are stored if needed and the missing ones loaded
+    void reconcile(const register_state_t& state);
+
+    // Loads the variable into a register if it can be done without evicting anything and more than
+    // spare registers stay free. Returns true if the variable is in a register afterwards
+    bool preload(var_info_t* var, int spare);
     void free_scope(scope_t* scope_to_free, bool store_globals = false);
 
     void touch(int register_index, bool has_changed);
     bool is_temporary(int register_index);
 
+    // Returns the variable in the register, nullptr if it is empty
+    var_info_t* get_content(int register_index);
+
     // Changes the content of the register, without loading or storing anything
     // used when a register already has the desired value but the value changes variable
     // ie. a temporary expression is assigned to a variable. Returns the old variable
@@ -0,0 +1,63 @@
+#ifndef COM_REGISTER_COLORING_H
+#define COM_REGISTER_COLORING_H
+
+#include <set>
+#include <vector>
+#include <unordered_map>
+
+#include "liveness.h"
+#include "register_allocation.h"
+
+// Registers left to temporaries and to variables that get no color
+#define SCRATCH_COUNT   4
+#define COLOR_COUNT     (REGISTER_COUNT - RESERVE_COUNT - SCRATCH_COUNT)
+
+// Chaitin/Briggs style coloring of the interference graph of a function. Two variables interfere when their
+// live ranges overlap, except for the statement copying one into the other. Copies are coalesced when the
+// merged node is guaranteed to stay colorable (the Briggs test), which removes the move between them.
+// The color of a variable becomes its home register, where the register allocator keeps it whenever it can
+class register_coloring_t {
+
+    struct node_info_t {
+        live_range_t* range;
+        std::set<int> adjacent;
+        int alias;
+        int weight;
+        int color;
+    };
+
+    std::vector<node_info_t> nodes;
+    std::unordered_map<const node_t*, int> node_index;
+
+    // Home register and range of every colored variable
+    struct claim_t {
+        int home;
+        int start;
+        int end;
+    };
+    std::vector<claim_t> claims;
+
+    int find(int node);
+
+    // Register the parameter of the node, or of a node merged into it, is passed in, -1 if none is
+    int arrives_in(int node);
+    int degree(int node, const std::vector<bool>& removed);
+
+    void build(liveness_t& liveness);
+    void coalesce(liveness_t& liveness);
+    void simplify_and_select();
+
+public:
+    register_coloring_t() = default;
+
+    // Sets the home register of every range of the analyzed function that could be colored
+    void color(liveness_t& liveness);
+
+    // Removes all homes, used when a function is translated without coloring
+    void clear();
+
+    // Returns true if the register is the home of a variable that is live at the position
+    bool is_claimed(int reg, int position) const;
+};
+
+#endif
@@ -6,6 +6,8 @@
 #include <deque>
 
 #include "parser_types.h"
+#include "interner.h"
+#include "liveness.h"
 
 struct addr_info_t {
     
@@ -38,7 +40,8 @@ class scope_name_allocator_t {
 
 public:
     scope_name_allocator_t();
-    std::string get_name(const std::string& id);
+    // Returns a new unique symbol of the form id:N
+    symbol_t get_name(const std::string& id);
 };
 
 class label_allocator_t {
@@ -52,8 +55,7 @@ public:
 class scope_t;
 
 struct var_info_t {
-    std::string name;
-    std::string id;
+    symbol_t name;
     int type;
     bool is_pointer;
     bool is_array;
@@ -61,6 +63,9 @@ struct var_info_t {
     addr_info_t* address; // Relative address to the base pointer ?
     scope_t* scope;
 
+    // Live range of a local variable, nullptr for globals and temporaries
+    const live_range_t* range = nullptr;
+
     var_info_t() = default;
     ~var_info_t() = default;
 
@@ -76,7 +81,7 @@ struct alignment_info_t {
 
 struct func_info_t {
 
-    std::string identifier;
+    symbol_t identifier;
     int return_type;
     bool defined;
     std::vector<var_info_t> param_vector;
@@ -86,6 +91,9 @@ struct func_info_t {
     int params_size;
     int total_stack_size;
 
+    // The translated function never changes BP, so calls of it do not have to save it
+    bool frameless = false;
+
     func_info_t() = default;
     func_info_t(const func_decl_t* decl, translator_t* t);
 
@@ -96,7 +104,7 @@ struct func_info_t {
 };
 
 class scope_t {
-    std::unordered_map<std::string, var_info_t*> data;
+    std::unordered_map<symbol_t, var_info_t*> data;
 
     int total_size;
     int base_offset;
@@ -118,39 +126,36 @@ public:
 
     int align(int size_to_align_to);
     
-    var_info_t* at(const std::string& key);
-    var_info_t* operator[](const std::string& key);
+    var_info_t* at(symbol_t key);
+    var_info_t* operator[](symbol_t key);
 
-    void add(const std::string& name, int size, var_info_t* varinfo);
+    void add(symbol_t name, int size, var_info_t* varinfo);
 
-    void remove(const std::string &name);
+    void remove(symbol_t name);
 };
 
 class symbol_table_t {
     std::deque<scope_t*> scope_stack;
-    std::unordered_map<std::string, func_info_t*> function_table;
-
-    scope_name_allocator_t name_alloc;
-
+    std::unordered_map<symbol_t, func_info_t*> function_table;
 
 public:
     symbol_table_t();
     ~symbol_table_t();
 
     // Get variable info
-    var_info_t* get_var(const std::string& key);
+    var_info_t* get_var(symbol_t key);
 
     // Add a variable to the current scope
-    var_info_t* add_var(const std::string& name, const int type, const int size, addr_info_t* addr);
+    var_info_t* add_var(symbol_t name, const int type, const int size, addr_info_t* addr);
 
     // Get function info
-    func_info_t* get_func(const std::string& name);
+    func_info_t* get_func(symbol_t name);
 
     // Remove a function declaration/definition
-    void remove_func(const std::string& name);
+    void remove_func(symbol_t name);
 
     // Add function to the global scope
-    void add_func(const std::string& name, func_info_t* f);
+    void add_func(symbol_t name, func_info_t* f);
     
     bool is_scope_reachable(scope_t* scope);
     bool is_global_scope();
@@ -0,0 +1,34 @@
+#ifndef COM_TOKEN_ARENA_H
+#define COM_TOKEN_ARENA_H
+
+#include <vector>
+
+#include "tokens.h"
+
+#define TOKEN_BLOCK_SIZE 4096
+
+namespace lex {
+
+    // Allocates tokens in large blocks. Tokens are never freed one by one, all blocks are released when the arena is destroyed
+    class token_arena_t {
+    private:
+        std::vector<token*> blocks;
+
+        // Number of tokens used in the last block
+        int used;
+    public:
+        token_arena_t();
+        ~token_arena_t();
+
+        token_arena_t(const token_arena_t&) = delete;
+        token_arena_t& operator=(const token_arena_t&) = delete;
+
+        token* allocate(tag_t tag, int line, int column);
+
+        // Frees every token allocated so far
+        void clear();
+    };
+
+}
+
+#endif
@@ -16,6 +16,8 @@ namespace lex {
         ASM,
         CONTINUE,
         BREAK,
+        INLINE,
+        UNROLL,
 
         // Other
         ID,
@@ -27,6 +29,10 @@ namespace lex {
         MINUS,
         AND,
         OR,
+        LOGICAL_AND,
+        LOGICAL_OR,
+        SHIFT_LEFT,
+        SHIFT_RIGHT,
         NOT,
         EQUALS,
         NOT_EQUALS,
@@ -58,6 +64,8 @@ namespace lex {
         "asm keyword",
         "continue keyword",
         "break keyword",
+        "inline keyword",
+        "unroll keyword",
         "identifier", 
         "integer literal", 
         "string literal",
@@ -65,6 +73,10 @@ namespace lex {
         "minus operator",
         "& operator",
         "or operator",
+        "&& operator",
+        "|| operator",
+        "<< operator",
+        ">> operator",
         "not operator",
         "equals operator",
         "not equals operator",
@@ -85,35 +97,22 @@ namespace lex {
         "unknown"
     };
 
+    // Position of a lexeme in the source text
+    struct lexeme_t {
+        unsigned int offset;
+        unsigned int length;
+    };
+
+    // Tokens are plain data allocated in the token arena of the lexer. Identifiers carry their interned symbol,
+    // integer literals their value and string literals refer to their text in the source
     struct token {
-        const tag_t tag;
-        token(tag_t _tag) : tag(_tag) { }
+        tag_t tag;
         int line_number;
         int column_number;
-    };
-
-    struct id_token : token {
-        std::string lexeme;
-        id_token(const std::string& _lexeme) : token(tag_t::ID) { lexeme = _lexeme; }
-        id_token(const std::string&& _lexeme) : token(tag_t::ID) { lexeme = _lexeme; }
-
-    };
-
-    struct keyword_token : token {
-        keyword_token(tag_t _tag) : token(_tag) { }
-    };
-
-    struct int_literal_token : token {
-        int value;
-        int_literal_token(int _value) : token(tag_t::INT_LITERAL), value(_value) {}
-
-    };
-
-    struct str_literal_token : token {
-        std::string value;
-        str_literal_token(const std::string& _value) : token(tag_t::STRING_LITERAL) { value = _value; }
-        str_literal_token(const std::string&& _value) : token(tag_t::STRING_LITERAL) { value = _value; }
-
+        union {
+            int value;      // Value of integer literals, symbol of identifiers
+            lexeme_t lexeme;
+        };
     };
 
 }
@@ -7,6 +7,16 @@
 #include "symbol_table.h"
 #include "type_table.h"
 #include "register_allocation.h"
+#include "liveness.h"
+#include "register_coloring.h"
+#include "ir.h"
+#include "peephole.h"
+#include "frame.h"
+#include "constant_propagation.h"
+#include "loop_invariant.h"
+#include "loop_unroll.h"
+#include "dead_code.h"
+#include "inliner.h"
 #include "interfaces.h"
 
 #define STACK_POINTER   15
@@ -23,12 +33,50 @@ public:
 
     const char* what() const noexcept { return msg.c_str(); }
 
-    static void throw_error(const std::string& error, const undoable_t* node);
+    static void throw_error(const std::string& error, const node_t* node);
+};
+
+// Code generation options given on the command line
+struct translator_options_t {
+
+    // Color the interference graph of every function to give its variables home registers, --regalloc=graph
+    bool graph_coloring = false;
+
+    // Run the peephole optimizer over every function, disabled by --no-peephole
+    bool peephole = true;
+
+    // Replace variables with the values they are known to have, disabled by --no-constant-propagation
+    bool constant_propagation = true;
+
+    // Leave out functions not reached from main and unused globals, disabled by --no-dead-code-elimination
+    bool dead_code_elimination = true;
+
+    // Replace calls of small functions with their bodies, disabled by --no-inline
+    bool inlining = true;
+
+    // Move computations that do not change in a loop in front of it, disabled by --no-loop-invariant-motion
+    bool loop_invariant_motion = true;
+
+    // Unroll counted loops fully when they are small, disabled by --no-unroll
+    bool unrolling = true;
+
+    // Copies of the body per iteration of counted loops that are not unrolled fully, --unroll=N
+    int unroll_factor = 1;
+
+    // Jump to functions whose value is returned instead of calling them, disabled by --no-tail-calls
+    bool tail_calls = true;
 };
 
 struct loop_info_t {
     std::string start_label;
     std::string end_label;
+
+    // End offset of the scope enclosing the loop, break and continue pop the variables declared after it
+    int stack_offset;
+
+    // Registers expected when jumping to the labels, see register_allocator_t::reconcile
+    register_state_t start_state;
+    register_state_t end_state;
 };
 
 class translator_t {
@@ -36,10 +84,15 @@ class translator_t {
     std::stringstream defines_and_global_output;
     std::stringstream output;
 
+    // Instructions of the function being translated, printed to output when it ends
+    ir_function_t code;
+
     bool data_mode;
 
 public:
 
+    const translator_options_t options;
+
     std::unordered_map<int, std::string> special_registers;
 
     symbol_table_t              symbol_table;
@@ -48,11 +101,20 @@ public:
     scope_name_allocator_t      name_allocator;
     label_allocator_t           label_allocator;
     std::vector<loop_info_t>    loop_info;
+    liveness_t                  liveness;
+    register_coloring_t         coloring;
+    peephole_optimizer_t        peephole;
+    frame_builder_t             frame;
+    constant_propagation_t      constant_propagation;
+    loop_invariant_motion_t     loop_invariants;
+    loop_unroller_t             unroller;
+    dead_code_eliminator_t      dead_code;
+    inliner_t                   inliner;
 
     long instr_cnt;
     bool last_was_ret;
 
-    translator_t();
+    translator_t(const translator_options_t& _options = translator_options_t());
     ~translator_t() = default;
 
     void print_to_file(std::ofstream& file);
@@ -62,6 +124,20 @@ public:
     bool get_data_mode();
 
     void print_instruction_row(const std::string& instr, bool tab, bool ret = false);
+
+    // Appends an instruction or a label to the function being translated
+    void emit(const ir_instr_t& instr);
+    void emit_label(const std::string& label);
+
+    // Saves the callee saved registers the translated function writes and removes its frame if it needs
+    // none, returns true if the function does not change BP
+    bool build_frame(bool save_registers);
+
+    // Prints the instructions of the translated function and starts a new one
+    void end_function();
+
+    // Drops the instructions of the translated function instead of printing them
+    void discard_function();
     void static_alloc(const std::string& name, int size, int value);
     
     void static_alloc_array(const std::string& name, int size, int length);
@@ -0,0 +1,59 @@
+#include "../include/ast_arena.h"
+
+#include <cstring>
+#include <cstdint>
+
+ast_arena_t::ast_arena_t() {
+    current = nullptr;
+    end = nullptr;
+}
+
+ast_arena_t::~ast_arena_t() {
+    for (char* block : blocks) delete[] block;
+}
+
+void ast_arena_t::grow(size_t size) {
+
+    // Allocations larger than a block get a block of their own
+    size_t block_size = (size > AST_BLOCK_SIZE) ? size : AST_BLOCK_SIZE;
+
+    blocks.push_back(new char[block_size]);
+    current = blocks.back();
+    end = current + block_size;
+}
+
+void* ast_arena_t::allocate(size_t size, size_t alignment) {
+
+    uintptr_t address = reinterpret_cast<uintptr_t>(current);
+    size_t padding = (alignment - address % alignment) % alignment;
+
+    if (current == nullptr || padding + size > (size_t) (end - current)) {
+        
+        // New blocks are aligned for any type
+        grow(size);
+        padding = 0;
+    }
+
+    void* result = current + padding;
+    current += padding + size;
+    return result;
+}
+
+std::string_view ast_arena_t::copy_string(const std::string& str) {
+
+    char* result = static_cast<char*>(allocate(str.size(), 1));
+    memcpy(result, str.data(), str.size());
+    return std::string_view(result, str.size());
+}
+
+void ast_arena_t::clear() {
+
+    if (blocks.empty()) return;
+
+    for (size_t i = 1; i < blocks.size(); i++) delete[] blocks[i];
+    blocks.resize(1);
+
+    // The first block is reused, a block of its own may be smaller than a regular block
+    current = blocks.front();
+    end = current + AST_BLOCK_SIZE;
+}
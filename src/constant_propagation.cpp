@@ -0,0 +1,389 @@
+#include "../include/constant_propagation.h"
+#include "../include/error_handling.h"
+
+#include <climits>
+
+constant_propagation_t::constant_propagation_t() {
+    types = nullptr;
+}
+
+void constant_propagation_t::run(func_decl_t* func, type_table_t* type_table) {
+
+    types = type_table;
+
+    values.clear();
+    scopes.clear();
+    address_taken.clear();
+
+    if (func->stmt != nullptr) find_address_taken(func->stmt);
+
+    // Parameters are not known
+    scopes.emplace_back();
+    if (func->param_list != nullptr) {
+        for (param_decl_t* param : *func->param_list) scopes.back()[param->id] = nullptr;
+    }
+
+    if (func->stmt != nullptr) visit_stmt(func->stmt);
+
+    scopes.clear();
+}
+
+const var_decl_t* constant_propagation_t::lookup(symbol_t name) {
+
+    for (int i = scopes.size() - 1; i >= 0; i--) {
+        auto it = scopes[i].find(name);
+        if (it != scopes[i].end()) return it->second;
+    }
+
+    // Globals are not tracked
+    return nullptr;
+}
+
+void constant_propagation_t::assign(symbol_t name, const int* value, const node_t* node) {
+
+    const var_decl_t* decl = lookup(name);
+    if (decl == nullptr) return;
+
+    values.erase(decl);
+    if (value == nullptr) return;
+
+    int size = types->at(decl->type)->size;
+
+    // Integer types are signed, see the README
+    if (size < 4) {
+        int min = -(1 << (8 * size - 1));
+        int max = (1 << (8 * size - 1)) - 1;
+
+        if (*value < min || *value > max) {
+            output_warning("Constant " + std::to_string(*value) + " does not fit in the " + std::to_string(8 * size) + " bits of variable " + symbol_name(name), node);
+            return;
+        }
+    }
+
+    values[decl] = *value;
+}
+
+// Appends the names of the variables assigned in the statement or written by inline assembly
+static void collect_assigned(stmt_t* stmt, std::vector<symbol_t>& names) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) collect_assigned(s, names);
+            }
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            collect_assigned(if_stmt->actions, names);
+            if (if_stmt->else_actions != nullptr) collect_assigned(if_stmt->else_actions, names);
+            break;
+        }
+        case NODE_WHILE_STMT:
+            collect_assigned(static_cast<while_stmt_t*>(stmt)->actions, names);
+            break;
+        case NODE_ASSIGNMENT_STMT:
+            names.push_back(static_cast<assignment_stmt_t*>(stmt)->identifier);
+            break;
+        case NODE_ASM_STMT: {
+            for (term_t* param : *static_cast<asm_stmt_t*>(stmt)->params) {
+                if (param->kind == NODE_ID_TERM) names.push_back(static_cast<id_term_t*>(param)->identifier);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void constant_propagation_t::forget_assigned(stmt_t* stmt) {
+
+    // Names declared inside the statement resolve to the visible variable with the same name, which is
+    // forgotten as well
+    std::vector<symbol_t> names;
+    collect_assigned(stmt, names);
+
+    for (symbol_t name : names) assign(name, nullptr, stmt);
+}
+
+void constant_propagation_t::visit_stmt(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+
+            scopes.emplace_back();
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) visit_stmt(s);
+            }
+            scopes.pop_back();
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+
+            visit_expr(if_stmt->cond);
+
+            // Only the branch taken by a constant condition is translated
+            int value = 0;
+            if (if_stmt->cond->evaluate(&value)) {
+                if (value) visit_stmt(if_stmt->actions);
+                else if (if_stmt->else_actions != nullptr) visit_stmt(if_stmt->else_actions);
+                break;
+            }
+
+            std::unordered_map<const node_t*, int> before = values;
+            visit_stmt(if_stmt->actions);
+
+            std::unordered_map<const node_t*, int> after_actions = values;
+            values = before;
+            if (if_stmt->else_actions != nullptr) visit_stmt(if_stmt->else_actions);
+
+            // Keep the values both paths agree on
+            for (auto it = values.begin(); it != values.end();) {
+                auto other = after_actions.find(it->first);
+                if (other == after_actions.end() || other->second != it->second) it = values.erase(it);
+                else it++;
+            }
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+
+            // Variables assigned in the loop may have any of their values at the start of an iteration
+            forget_assigned(while_stmt);
+
+            visit_expr(while_stmt->cond);
+
+            int value = 0;
+            if (while_stmt->cond->evaluate(&value) && !value) break;
+
+            visit_stmt(while_stmt->actions);
+            forget_assigned(while_stmt);
+            break;
+        }
+        case NODE_ASM_STMT: {
+            asm_stmt_t* asm_stmt = static_cast<asm_stmt_t*>(stmt);
+
+            // Parameters are given in registers and may be written, so they are never replaced by constants
+            for (term_t* param : *asm_stmt->params) {
+                if (param->kind != NODE_ID_TERM) continue;
+
+                id_term_t* id = static_cast<id_term_t*>(param);
+                id->is_constant = false;
+                assign(id->identifier, nullptr, stmt);
+            }
+            break;
+        }
+        case NODE_ASSIGNMENT_STMT: {
+            assignment_stmt_t* assignment = static_cast<assignment_stmt_t*>(stmt);
+
+            visit_expr(assignment->rvalue);
+
+            int value = 0;
+            bool evaluated = assignment->rvalue->evaluate(&value);
+            assign(assignment->identifier, (evaluated) ? &value : nullptr, stmt);
+            break;
+        }
+        case NODE_DEREF_ASSIGNMENT_STMT:
+            visit_expr(static_cast<deref_assignment_stmt_t*>(stmt)->rvalue);
+            break;
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+
+            visit_expr(assignment->index);
+            visit_expr(assignment->rvalue);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            visit_expr(static_cast<return_stmt_t*>(stmt)->return_value);
+            break;
+        case NODE_EXPR_STMT:
+            visit_expr(static_cast<expr_stmt_t*>(stmt)->e);
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+
+            // The variable is in scope of its own initializer, as when translating
+            bool tracked = !decl->is_pointer && address_taken.count(decl->id) == 0;
+            scopes.back()[decl->id] = (tracked) ? decl : nullptr;
+
+            if (decl->value != nullptr) {
+                visit_expr(decl->value);
+
+                int value = 0;
+                bool evaluated = decl->value->evaluate(&value);
+                assign(decl->id, (evaluated) ? &value : nullptr, stmt);
+            }
+            break;
+        }
+        case NODE_SIMPLE_ARRAY_DECL: {
+            simple_array_decl_t* decl = static_cast<simple_array_decl_t*>(stmt);
+
+            visit_expr(decl->size);
+            scopes.back()[decl->identifier] = nullptr;
+            break;
+        }
+        case NODE_INIT_LIST_ARRAY_DECL: {
+            init_list_array_decl_t* decl = static_cast<init_list_array_decl_t*>(stmt);
+
+            for (expr_t* e : *decl->init_list) visit_expr(e);
+            scopes.back()[decl->identifier] = nullptr;
+            break;
+        }
+        case NODE_STR_ARRAY_DECL:
+            scopes.back()[static_cast<str_array_decl_t*>(stmt)->identifier] = nullptr;
+            break;
+        default:
+            break;
+    }
+}
+
+void constant_propagation_t::visit_expr(expr_t* e) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        visit_expr(binop->left);
+        visit_expr(binop->right);
+        check_overflow(binop);
+        return;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:     visit_expr(static_cast<neg_expr_t*>(e)->value); break;
+        case NODE_NOT_EXPR:     visit_expr(static_cast<not_expr_t*>(e)->value); break;
+        case NODE_TERM_EXPR:    visit_expr(static_cast<term_expr_t*>(e)->t); break;
+        case NODE_EXPR_TERM:    visit_expr(static_cast<expr_term_t*>(e)->expr); break;
+        case NODE_INDEXED_TERM: visit_expr(static_cast<indexed_term_t*>(e)->index); break;
+        case NODE_ID_TERM: {
+            id_term_t* id = static_cast<id_term_t*>(e);
+
+            const var_decl_t* decl = lookup(id->identifier);
+            auto it = (decl != nullptr) ? values.find(decl) : values.end();
+
+            id->is_constant = it != values.end();
+            if (id->is_constant) id->constant = it->second;
+            break;
+        }
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+            if (call->params != nullptr) {
+                for (expr_t* param : *call->params) visit_expr(param);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void constant_propagation_t::check_overflow(binop_expr_t* binop) {
+
+    bool arithmetic = binop->kind == NODE_ADD_BINOP || binop->kind == NODE_SUB_BINOP || binop->kind == NODE_MULT_BINOP;
+    if (!arithmetic && binop->kind != NODE_SHIFT_LEFT_BINOP) return;
+
+    int left = 0;
+    int right = 0;
+    if (!binop->left->evaluate(&left) || !binop->right->evaluate(&right)) return;
+    if (binop->kind == NODE_SHIFT_LEFT_BINOP && (right < 0 || right >= 32)) return;
+
+    long long result = 0;
+    switch (binop->kind) {
+        case NODE_ADD_BINOP:        result = (long long)left + right; break;
+        case NODE_SUB_BINOP:        result = (long long)left - right; break;
+        case NODE_SHIFT_LEFT_BINOP: result = (long long)left * (1LL << right); break;
+        default:                    result = (long long)left * right; break;
+    }
+
+    if (result < INT_MIN || result > INT_MAX) output_warning("Constant expression overflows 32 bits", binop);
+}
+
+void constant_propagation_t::find_address_taken(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) find_address_taken(s);
+            }
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+
+            find_address_taken(if_stmt->cond);
+            find_address_taken(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) find_address_taken(if_stmt->else_actions);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+
+            find_address_taken(while_stmt->cond);
+            find_address_taken(while_stmt->actions);
+            break;
+        }
+        case NODE_ASSIGNMENT_STMT:
+            find_address_taken(static_cast<assignment_stmt_t*>(stmt)->rvalue);
+            break;
+        case NODE_DEREF_ASSIGNMENT_STMT:
+            find_address_taken(static_cast<deref_assignment_stmt_t*>(stmt)->rvalue);
+            break;
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+
+            find_address_taken(assignment->index);
+            find_address_taken(assignment->rvalue);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            find_address_taken(static_cast<return_stmt_t*>(stmt)->return_value);
+            break;
+        case NODE_EXPR_STMT:
+            find_address_taken(static_cast<expr_stmt_t*>(stmt)->e);
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+            if (decl->value != nullptr) find_address_taken(decl->value);
+            break;
+        }
+        case NODE_SIMPLE_ARRAY_DECL:
+            find_address_taken(static_cast<simple_array_decl_t*>(stmt)->size);
+            break;
+        case NODE_INIT_LIST_ARRAY_DECL: {
+            for (expr_t* e : *static_cast<init_list_array_decl_t*>(stmt)->init_list) find_address_taken(e);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void constant_propagation_t::find_address_taken(expr_t* e) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        find_address_taken(binop->left);
+        find_address_taken(binop->right);
+        return;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:     find_address_taken(static_cast<neg_expr_t*>(e)->value); break;
+        case NODE_NOT_EXPR:     find_address_taken(static_cast<not_expr_t*>(e)->value); break;
+        case NODE_TERM_EXPR:    find_address_taken(static_cast<term_expr_t*>(e)->t); break;
+        case NODE_EXPR_TERM:    find_address_taken(static_cast<expr_term_t*>(e)->expr); break;
+        case NODE_INDEXED_TERM: find_address_taken(static_cast<indexed_term_t*>(e)->index); break;
+        case NODE_ADDR_OF_TERM: address_taken.insert(static_cast<addr_of_term_t*>(e)->identifier); break;
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+            if (call->params != nullptr) {
+                for (expr_t* param : *call->params) find_address_taken(param);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
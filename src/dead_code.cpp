@@ -0,0 +1,243 @@
+#include "../include/dead_code.h"
+
+#include <cctype>
+
+dead_code_eliminator_t::dead_code_eliminator_t() {
+    removed_functions = 0;
+    removed_globals = 0;
+}
+
+void dead_code_eliminator_t::run(program_t* program) {
+
+    functions.clear();
+    referenced.clear();
+    pending.clear();
+    removed_functions = 0;
+    removed_globals = 0;
+
+    for (decl_t* decl : *program->decls) {
+        if (decl->kind != NODE_FUNC_DECL) continue;
+
+        func_decl_t* func = static_cast<func_decl_t*>(decl);
+        if (func->stmt != nullptr) functions[func->id] = func;
+    }
+
+    // Initializers of globals that are not constant run before main
+    for (decl_t* decl : *program->decls) {
+        if (decl->kind != NODE_VAR_DECL) continue;
+
+        var_decl_t* var = static_cast<var_decl_t*>(decl);
+
+        int value = 0;
+        if (var->value != nullptr && !var->value->evaluate(&value)) visit_expr(var->value);
+    }
+
+    // Without a main every function may be called from elsewhere
+    symbol_t main_id = get_interner().intern("main");
+    if (functions.count(main_id)) {
+        reference(main_id);
+    } else {
+        for (auto& kv : functions) reference(kv.first);
+    }
+
+    while (!pending.empty()) {
+        func_decl_t* func = pending.back();
+        pending.pop_back();
+
+        visit_stmt(func->stmt);
+    }
+
+    for (decl_t* decl : *program->decls) {
+
+        symbol_t name;
+        switch (decl->kind) {
+            case NODE_FUNC_DECL: {
+                func_decl_t* func = static_cast<func_decl_t*>(decl);
+
+                // Declarations without a body emit nothing
+                if (func->stmt == nullptr) continue;
+
+                func->used = referenced.count(func->id) != 0;
+                if (!func->used) removed_functions++;
+                continue;
+            }
+            case NODE_VAR_DECL: {
+                var_decl_t* var = static_cast<var_decl_t*>(decl);
+
+                int value = 0;
+                if (var->value != nullptr && !var->value->evaluate(&value)) continue;
+
+                name = var->id;
+                break;
+            }
+            case NODE_SIMPLE_ARRAY_DECL:
+            case NODE_INIT_LIST_ARRAY_DECL:
+            case NODE_STR_ARRAY_DECL:
+                name = static_cast<array_decl_t*>(decl)->identifier;
+                break;
+            default:
+                continue;
+        }
+
+        decl->used = referenced.count(name) != 0;
+        if (!decl->used) removed_globals++;
+    }
+}
+
+void dead_code_eliminator_t::reference(symbol_t name) {
+
+    if (!referenced.insert(name).second) return;
+
+    auto it = functions.find(name);
+    if (it != functions.end()) pending.push_back(it->second);
+}
+
+void dead_code_eliminator_t::reference_asm(const std::string_view& literal) {
+
+    for (int i = 0; i < (int) literal.size();) {
+
+        if (!std::isalpha(literal[i]) && literal[i] != '_') {
+            i++;
+            continue;
+        }
+
+        int start = i;
+        while (i < (int) literal.size() && (std::isalnum(literal[i]) || literal[i] == '_')) i++;
+
+        reference(get_interner().intern(literal.data() + start, i - start));
+    }
+}
+
+void dead_code_eliminator_t::remove_unreachable(block_stmt_t* block) {
+
+    if (block->statements == nullptr) return;
+
+    stmts_t* statements = block->statements;
+    for (int i = 0; i < statements->count; i++) {
+
+        node_kind_t kind = (*statements)[i]->kind;
+        if (kind == NODE_RETURN_STMT || kind == NODE_BREAK_STMT || kind == NODE_CONTINUE_STMT) {
+            statements->count = i + 1;
+            return;
+        }
+    }
+}
+
+void dead_code_eliminator_t::visit_stmt(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+
+            remove_unreachable(block);
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) visit_stmt(s);
+            }
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+
+            visit_expr(if_stmt->cond);
+            visit_stmt(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) visit_stmt(if_stmt->else_actions);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+
+            visit_expr(while_stmt->cond);
+            visit_stmt(while_stmt->actions);
+            break;
+        }
+        case NODE_ASM_STMT: {
+            asm_stmt_t* asm_stmt = static_cast<asm_stmt_t*>(stmt);
+
+            reference_asm(asm_stmt->literal);
+            for (term_t* param : *asm_stmt->params) visit_expr(param);
+            break;
+        }
+        case NODE_ASSIGNMENT_STMT: {
+            assignment_stmt_t* assignment = static_cast<assignment_stmt_t*>(stmt);
+
+            reference(assignment->identifier);
+            visit_expr(assignment->rvalue);
+            break;
+        }
+        case NODE_DEREF_ASSIGNMENT_STMT: {
+            deref_assignment_stmt_t* assignment = static_cast<deref_assignment_stmt_t*>(stmt);
+
+            reference(assignment->identifier);
+            visit_expr(assignment->rvalue);
+            break;
+        }
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+
+            reference(assignment->identifier);
+            visit_expr(assignment->index);
+            visit_expr(assignment->rvalue);
+            break;
+        }
+        case NODE_RETURN_STMT: {
+            return_stmt_t* return_stmt = static_cast<return_stmt_t*>(stmt);
+            if (return_stmt->return_value != nullptr) visit_expr(return_stmt->return_value);
+            break;
+        }
+        case NODE_EXPR_STMT:
+            visit_expr(static_cast<expr_stmt_t*>(stmt)->e);
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+            if (decl->value != nullptr) visit_expr(decl->value);
+            break;
+        }
+        case NODE_SIMPLE_ARRAY_DECL:
+            visit_expr(static_cast<simple_array_decl_t*>(stmt)->size);
+            break;
+        case NODE_INIT_LIST_ARRAY_DECL: {
+            for (expr_t* e : *static_cast<init_list_array_decl_t*>(stmt)->init_list) visit_expr(e);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void dead_code_eliminator_t::visit_expr(expr_t* e) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        visit_expr(binop->left);
+        visit_expr(binop->right);
+        return;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:     visit_expr(static_cast<neg_expr_t*>(e)->value); break;
+        case NODE_NOT_EXPR:     visit_expr(static_cast<not_expr_t*>(e)->value); break;
+        case NODE_TERM_EXPR:    visit_expr(static_cast<term_expr_t*>(e)->t); break;
+        case NODE_EXPR_TERM:    visit_expr(static_cast<expr_term_t*>(e)->expr); break;
+        case NODE_ID_TERM:      reference(static_cast<id_term_t*>(e)->identifier); break;
+        case NODE_DEREF_TERM:   reference(static_cast<deref_term_t*>(e)->identifier); break;
+        case NODE_ADDR_OF_TERM: reference(static_cast<addr_of_term_t*>(e)->identifier); break;
+        case NODE_INDEXED_TERM: {
+            indexed_term_t* indexed = static_cast<indexed_term_t*>(e);
+
+            reference(indexed->identifier);
+            visit_expr(indexed->index);
+            break;
+        }
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+
+            reference(call->function_identifier);
+            if (call->params != nullptr) {
+                for (expr_t* param : *call->params) visit_expr(param);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
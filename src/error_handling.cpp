@@ -3,7 +3,7 @@
 
 static int warning_count = 0;
 
-void output_warning(const std::string& warning, const undoable_t* node) {
+void output_warning(const std::string& warning, const node_t* node) {
 
     warning_count++;
 
@@ -0,0 +1,151 @@
+#include "../include/frame.h"
+#include "../include/translator.h"
+
+#include <cctype>
+
+// Instructions saving and restoring BP around a call, they work the same without a frame
+static bool saves_base_pointer(const ir_instr_t& instr) {
+    return (instr.op == IR_PUSH && instr.ra == BASE_POINTER) || (instr.op == IR_POP && instr.rd == BASE_POINTER);
+}
+
+static bool uses_base_pointer(const ir_instr_t& instr) {
+
+    if (saves_base_pointer(instr)) return false;
+    if (instr.get_def() == BASE_POINTER) return true;
+
+    for (vreg_t reg : instr.get_uses()) {
+        if (reg == BASE_POINTER) return true;
+    }
+    return false;
+}
+
+// Adds the registers named rN in the text of inline assembly
+static void named_registers(const std::string& text, std::set<int>& result) {
+
+    for (int i = 0; i + 1 < (int) text.size(); i++) {
+
+        if (text[i] != 'r' || !std::isdigit(text[i + 1])) continue;
+        if (i > 0 && (std::isalnum(text[i - 1]) || text[i - 1] == '_')) continue;
+
+        int end = i + 1;
+        while (end < (int) text.size() && std::isdigit(text[end])) end++;
+        if (end < (int) text.size() && (std::isalnum(text[end]) || text[end] == '_')) continue;
+
+        result.insert(std::stoi(text.substr(i + 1, end - i - 1)));
+    }
+}
+
+// A jump to a label that is not in the function
+static bool is_tail_call(const ir_instr_t& instr, const std::set<std::string>& labels) {
+    return instr.op == IR_JMP && !labels.count(instr.symbol);
+}
+
+frame_builder_t::frame_builder_t() {
+    saved = 0;
+    frameless = 0;
+    tail_calls = 0;
+}
+
+void frame_builder_t::jumps_to_frame(const std::string& name) {
+    frame_targets.insert(name);
+}
+
+bool frame_builder_t::build(ir_function_t& func, bool save_registers) {
+
+    std::set<std::string> targets;
+    targets.swap(frame_targets);
+
+    std::vector<ir_block_t>& blocks = func.get_blocks();
+    if (blocks.empty() || blocks.front().instrs.empty()) return false;
+
+    std::set<std::string> labels;
+    for (const ir_block_t& block : blocks) labels.insert(block.label);
+
+    // Jumping to itself the function leaves BP as it found it
+    targets.erase(blocks.front().label);
+
+    // The prologue is move BP, SP
+    std::vector<ir_instr_t>& entry = blocks.front().instrs;
+    const ir_instr_t& prologue = entry.front();
+    if (prologue.op != IR_MOVE || prologue.rd != BASE_POINTER || prologue.ra != STACK_POINTER) return false;
+
+    bool uses_frame = false;
+    bool uses_stack = false;
+    std::set<int> written;
+
+    for (const ir_block_t& block : blocks) {
+        for (const ir_instr_t& instr : block.instrs) {
+
+            if (&instr == &prologue) continue;
+
+            if (instr.op == IR_ASM) {
+                uses_frame = true;
+                named_registers(instr.symbol, written);
+            }
+
+            uses_frame |= uses_base_pointer(instr);
+            tail_calls += is_tail_call(instr, labels);
+            uses_stack |= instr.op == IR_PUSH || instr.op == IR_POP || instr.op == IR_CALL;
+
+            if (instr.get_def() != NO_REGISTER) written.insert(instr.get_def());
+        }
+    }
+
+    // Locals that are never stored do not need their stack space
+    for (ir_block_t& block : blocks) {
+        for (int i = 0; i < (int) block.instrs.size() && !uses_frame && !uses_stack; i++) {
+
+            const ir_instr_t& instr = block.instrs[i];
+            bool adjusts_stack = (instr.op == IR_ADDI || instr.op == IR_SUBI) && instr.rd == STACK_POINTER && instr.ra == STACK_POINTER;
+
+            if (adjusts_stack) block.instrs.erase(block.instrs.begin() + i--);
+        }
+    }
+
+    bool has_frame = uses_frame || !targets.empty();
+
+    if (!has_frame) {
+        entry.erase(entry.begin());
+        frameless++;
+    }
+
+    std::vector<int> callee_saved;
+    for (int reg = CALLER_SAVED_COUNT; reg < REGISTER_COUNT - RESERVE_COUNT && save_registers; reg++) {
+        if (written.count(reg)) callee_saved.push_back(reg);
+    }
+
+    if (callee_saved.empty()) return !has_frame;
+
+    int saved_size = 4 * callee_saved.size();
+    saved += callee_saved.size();
+
+    // Parameters on the stack are the only data above BP
+    for (ir_block_t& block : blocks) {
+        for (ir_instr_t& instr : block.instrs) {
+
+            bool addresses = instr.op == IR_LOAD || instr.op == IR_STORE || instr.op == IR_ADDI;
+            if (addresses && instr.ra == BASE_POINTER && instr.symbol.empty() && instr.imm > 0) instr.imm += saved_size;
+        }
+    }
+
+    for (ir_block_t& block : blocks) {
+        for (int i = 0; i < (int) block.instrs.size(); i++) {
+
+            if (block.instrs[i].op != IR_RET && !is_tail_call(block.instrs[i], labels)) continue;
+
+            for (int j = callee_saved.size() - 1; j >= 0; j--) {
+                ir_instr_t pop(IR_POP, callee_saved[j]);
+                pop.size = 4;
+                block.instrs.insert(block.instrs.begin() + i++, pop);
+            }
+        }
+    }
+
+    for (int j = callee_saved.size() - 1; j >= 0; j--) {
+        ir_instr_t push(IR_PUSH, NO_REGISTER, callee_saved[j]);
+        push.size = 4;
+        entry.insert(entry.begin(), push);
+    }
+
+    return !has_frame;
+}
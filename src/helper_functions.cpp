@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <iostream>
 #include <regex>
+#include <limits>
+#include <stdexcept>
 
 std::string strip_quotations(const std::string& string_literal) {
     return string_literal.substr(1, string_literal.size() - 2);
@@ -84,19 +86,14 @@ void str_lit_to_str(const std::string& str, std::string& result) {
 
 void init_list_to_vector(init_list_t* init_list, std::vector<int>& result) {
 
-    init_list_t* current = init_list;
-
-    while (current != nullptr) {
+    for (expr_t* e : *init_list) {
         
-        expr_t* e = current->first;
         int value;
         bool evaluated = e->evaluate(&value);
 
         if (!evaluated) translation_error::throw_error("Non-static value in array initializer list", e);
 
         result.push_back(value);
-
-        current = current->rest;
     }
 } 
 
@@ -119,7 +116,7 @@ void load_immediate(translator_t* t, int reg, int value) {
 
 int allocate_temp_imm(translator_t* t, const std::string& name, int value, var_info_t** var) {
     
-    std::string temp_name = t->name_allocator.get_name(name);
+    symbol_t temp_name = t->name_allocator.get_name(name);
 
     // Add temporary variable to scope to allow register allocation
     var_info_t* temp_var = t->symbol_table.add_var(temp_name, 0, 0, nullptr);
@@ -137,7 +134,7 @@ int allocate_temp_imm(translator_t* t, const std::string& name, int value, var_i
 
 int allocate_temp(translator_t* t, const std::string& name, var_info_t** var) {
     
-    std::string temp_name = t->name_allocator.get_name(name);
+    symbol_t temp_name = t->name_allocator.get_name(name);
 
     // Add temporary variable to scope to allow register allocation
     var_info_t* temp_var = t->symbol_table.add_var(temp_name, 0, 0, nullptr);
@@ -152,7 +149,7 @@ int allocate_temp(translator_t* t, const std::string& name, var_info_t** var) {
 var_info_t* give_ownership_temp(translator_t* t, const std::string& name, int reg) {
 
     // Add temporary variable to scope to allow register allocation
-    std::string left_temp_name = t->name_allocator.get_name(name);
+    symbol_t left_temp_name = t->name_allocator.get_name(name);
     var_info_t* temp_var = t->symbol_table.add_var(left_temp_name, 0, 0, nullptr);
     temp_var->is_temp = true;
 
@@ -162,21 +159,29 @@ var_info_t* give_ownership_temp(translator_t* t, const std::string& name, int re
 
 int take_ownership_or_allocate(translator_t* t, const std::string& name, int reg) {
     
+    var_info_t* owner = t->reg_alloc.get_content(reg);
+
+    // A variable read again later stays in its register, the value is copied instead
+    bool copy = reg != RETURN_REGISTER && owner != nullptr && !owner->is_temp && !t->reg_alloc.is_last_use(owner);
+
     // If the allocated register is not temporary, take ownership of it
-    if (!t->reg_alloc.is_temporary(reg) && reg != RETURN_REGISTER) {
-        
+    if (!t->reg_alloc.is_temporary(reg) && reg != RETURN_REGISTER && !copy) {
+
+        // A variable at its last use does not have to be stored
+        if (owner != nullptr) t->reg_alloc.free(owner, false);
+
         give_ownership_temp(t, name, reg);
 
-    } else if (reg == RETURN_REGISTER) {
+    } else if (reg == RETURN_REGISTER || copy) {
 
         // Add temporary variable to scope to allow register allocation
-        std::string left_temp_name = t->name_allocator.get_name(name);
+        symbol_t left_temp_name = t->name_allocator.get_name(name);
         var_info_t* temp_var = t->symbol_table.add_var(left_temp_name, 0, 0, nullptr);
         temp_var->is_temp = true;
         
         int new_reg = t->reg_alloc.allocate(temp_var, false, false);
 
-        move_instr(t, new_reg, RETURN_REGISTER);
+        move_instr(t, new_reg, reg);
         return new_reg;
 
     }
@@ -203,19 +208,105 @@ int pop_temp(translator_t* t, var_info_t* var) {
     return reg;
 }
 
-int translate_binop_imm(translator_t*t, binop_expr_t* binop, const std::string& instr, const std::string& imm_instr) {
+bool contains_call(expr_t* e) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        return contains_call(binop->left) || contains_call(binop->right);
+    }
+
+    switch (e->kind) {
+        case NODE_CALL_TERM:    return true;
+        case NODE_EXPR_TERM:    return contains_call(static_cast<expr_term_t*>(e)->expr);
+        case NODE_INDEXED_TERM: return contains_call(static_cast<indexed_term_t*>(e)->index);
+        case NODE_NEG_EXPR:     return contains_call(static_cast<neg_expr_t*>(e)->value);
+        case NODE_NOT_EXPR:     return contains_call(static_cast<not_expr_t*>(e)->value);
+        default:                return false;
+    }
+}
+
+bool is_dying_variable(translator_t* t, expr_t* e, var_info_t* target) {
+
+    if (e->kind != NODE_ID_TERM || static_cast<id_term_t*>(e)->is_constant) return false;
+
+    var_info_t* var = t->symbol_table.get_var(static_cast<id_term_t*>(e)->identifier);
+    return var != target && !var->is_array && t->reg_alloc.is_last_use(var);
+}
+
+int translate_right_operand(translator_t* t, binop_expr_t* binop, int* left_register) {
+
+    bool is_function_call = contains_call(binop->right);
+    var_info_t* var;
+
+    // If right operand calls a function save temporary value on stack
+    if (is_function_call) {
+        var = push_temp(t, *left_register);
+    }
+
+    // Translate right operand
+    int right_register = binop->right->translate(t);
+
+    // If right operand called a function restore temporary value
+    if (is_function_call) {
+
+        // A computed right operand must not be evicted when the left operand is restored
+        if (right_register != RETURN_REGISTER) {
+            right_register = take_ownership_or_allocate(t, "__temp__", right_register);
+            t->reg_alloc.touch(right_register, false);
+        }
+
+        *left_register = pop_temp(t, var);
+
+        // The restored value is used right away, it must not be the next register to be evicted
+        t->reg_alloc.touch(*left_register, false);
+    }
+
+    return right_register;
+}
+
+int allocate_result(translator_t* t, const std::string& name, int left_register, int right_register) {
+
+    for (int reg : {left_register, right_register}) {
+
+        if (reg < 0 || reg == RETURN_REGISTER) continue;
+        if (t->reg_alloc.is_temporary(reg)) return reg;
+
+        // A variable at its last use gives up its register without being stored
+        var_info_t* owner = t->reg_alloc.get_content(reg);
+        if (owner != nullptr && t->reg_alloc.is_last_use(owner)) {
+            t->reg_alloc.free(owner, false);
+            give_ownership_temp(t, name, reg);
+            return reg;
+        }
+    }
+
+    var_info_t* var;
+    return allocate_temp(t, name, &var);
+}
+
+int translate_left_operand(translator_t* t, binop_expr_t* binop, bool right_success) {
+
+    int left_register = binop->left->translate(t);
+
+    // A call in the right operand saves the left value on the stack, which takes a temporary
+    if (!right_success && contains_call(binop->right)) {
+        left_register = take_ownership_or_allocate(t, "__temp__", left_register);
+    }
+
+    return left_register;
+}
+
+int translate_binop_imm(translator_t*t, binop_expr_t* binop, ir_opcode_t op, ir_opcode_t imm_op) {
 
-    // Assume left associativity
-    if (!binop->left_assoc) translation_error::throw_error("Expression is right-associative", binop);
-    
     int left_value = 0;
-    bool left_success = binop->rest->evaluate(&left_value);
+    bool left_success = binop->left->evaluate(&left_value);
 
     int right_value = 0;
-    bool right_success = binop->term->evaluate(&right_value);
+    bool right_success = binop->right->evaluate(&right_value);
 
     int left_register;
     int right_register;
+    int result_register;
 
 
     if (left_success) {
@@ -226,10 +317,7 @@ int translate_binop_imm(translator_t*t, binop_expr_t* binop, const std::string&
 
     } else {
 
-        left_register = binop->rest->translate(t);
-
-        // If the allocated register is not temporary, take ownership of it
-        left_register = take_ownership_or_allocate(t, "__temp__", left_register);
+        left_register = translate_left_operand(t, binop, right_success);
 
     }
 
@@ -240,44 +328,30 @@ int translate_binop_imm(translator_t*t, binop_expr_t* binop, const std::string&
             translation_error::throw_error("Constant can't be larger than 16-bits", binop);
         }
 
+        result_register = allocate_result(t, "__temp__", left_register);
+
         // Print imm instr
-        tri_operand_imm_instr(t, imm_instr, left_register, left_register, right_value);
+        tri_operand_imm_instr(t, imm_op, result_register, left_register, right_value);
 
     } else {
 
-        bool is_function_call = dynamic_cast<call_term_t*>(binop->term) != nullptr;
-        var_info_t* var;
-
-        // If term is a function call save temporary value on stack
-        if (is_function_call) {
-            var = push_temp(t, left_register);
-        }
-
-        // Translate term
-        right_register = binop->term->translate(t);
-
-        // If term is a function call restore temporary value
-        if (is_function_call) {
-            left_register = pop_temp(t, var);
-        }
+        right_register = translate_right_operand(t, binop, &left_register);
+        result_register = allocate_result(t, "__temp__", left_register, right_register);
 
         // Print non-imm instruction
-        tri_operand_instr(t, instr, left_register, left_register, right_register);
+        tri_operand_instr(t, op, result_register, left_register, right_register);
 
     }
-    return left_register;
+    return result_register;
 }
 
-int translate_binop(translator_t* t, binop_expr_t* binop, const std::string& instr) {
+int translate_binop(translator_t* t, binop_expr_t* binop, ir_opcode_t op) {
 
-    // Assume left associativity
-    if (!binop->left_assoc) translation_error::throw_error("Expression is right-associative", binop);
-    
     int left_value = 0;
-    bool left_success = binop->rest->evaluate(&left_value);
+    bool left_success = binop->left->evaluate(&left_value);
 
     int right_value = 0;
-    bool right_success = binop->term->evaluate(&right_value);
+    bool right_success = binop->right->evaluate(&right_value);
 
     int left_register;
     int right_register;
@@ -290,10 +364,7 @@ int translate_binop(translator_t* t, binop_expr_t* binop, const std::string& ins
 
     } else {
 
-        left_register = binop->rest->translate(t);
-
-        // If the allocated register is not temporary, take ownership of it
-        left_register = take_ownership_or_allocate(t, "__temp__", left_register);
+        left_register = translate_left_operand(t, binop, right_success);
     }
 
     if (right_success) {
@@ -306,42 +377,157 @@ int translate_binop(translator_t* t, binop_expr_t* binop, const std::string& ins
         
     } else {
 
-        bool is_function_call = dynamic_cast<call_term_t*>(binop->term) != nullptr;
-        var_info_t* var;
+        right_register = translate_right_operand(t, binop, &left_register);
 
-        // If term is a function call save temporary value on stack
-        if (is_function_call) {
-            var = push_temp(t, left_register);
-        }
+    }
+
+    // The result goes to an operand register if it is not needed afterwards
+    int result_register = allocate_result(t, "__temp__", left_register, right_register);
+    
+    tri_operand_instr(t, op, result_register, left_register, right_register);
+
+    return result_register;
+}
 
-        // Translate term
-        right_register = binop->term->translate(t);
+// Multiplication by a constant as (x << first) + (x << second) or (x << first) - (x << second), or only
+// x << first if second is -1
+struct shift_sequence_t {
+    int first;
+    int second;
+    bool subtract;
 
-        // If term is a function call restore temporary value
-        if (is_function_call) {
-            left_register = pop_temp(t, var);
+    // Number of instructions
+    int cost;
+};
+
+// Finds the shifts that multiply by a positive value, returns false if it takes more than two
+static bool find_shifts(long long value, shift_sequence_t* seq) {
+
+    if (value <= 0) return false;
+
+    // Exponent of the lowest set bit
+    int low = 0;
+    while (((value >> low) & 1) == 0) low++;
+
+    long long rest = value - (1LL << low);
+
+    if (rest == 0) {
+        *seq = { low, -1, false, 1 };
+        return true;
+    }
+
+    // 2^a + 2^low
+    if ((rest & (rest - 1)) == 0) {
+        int high = 0;
+        while ((1LL << high) != rest) high++;
+
+        *seq = { high, low, false, (low == 0) ? 2 : 3 };
+        return true;
+    }
+
+    // 2^a - 2^low
+    long long sum = value + (1LL << low);
+    if ((sum & (sum - 1)) == 0) {
+        int high = 0;
+        while ((1LL << high) != sum) high++;
+        if (high >= 32) return false;
+
+        *seq = { high, low, true, (low == 0) ? 2 : 3 };
+        return true;
+    }
+
+    return false;
+}
+
+void mult_imm(translator_t* t, int rd, int ra, int value) {
+
+    // x * 0 does not read x and x * -1 is a single neg
+    if (value == 0) {
+        load_immediate(t, rd, 0);
+        return;
+    }
+    if (value == -1) {
+        neg_instr(t, rd, ra);
+        return;
+    }
+
+    long long magnitude = (value < 0) ? -(long long)value : value;
+
+    // Loading the value for a mul takes movhi and movlo if it does not fit in 16 bits
+    bool is_short = value >= std::numeric_limits<short>().min() && value <= std::numeric_limits<short>().max();
+    int mult_cost = ((is_short) ? 1 : 2) + MULT_COST;
+
+    shift_sequence_t seq;
+    if (!find_shifts(magnitude, &seq) || seq.cost + (value < 0) >= mult_cost) {
+
+        var_info_t* size_const_var;
+        int size_const_reg = allocate_temp_imm(t, "__temp__", value, &size_const_var);
+        mult_instr(t, rd, ra, size_const_reg);
+        t->reg_alloc.free(size_const_var, false);
+        return;
+    }
+
+    if (seq.second < 0) {
+
+        if (seq.first != 0) tri_operand_imm_instr(t, IR_LSLI, rd, ra, seq.first);
+        else if (rd != ra) move_instr(t, rd, ra);
+
+    } else {
+
+        // The first shift goes to a temporary since rd may be ra, which the second shift still reads
+        var_info_t* shifted_var;
+        int shifted_reg = allocate_temp(t, "__temp__", &shifted_var);
+        tri_operand_imm_instr(t, IR_LSLI, shifted_reg, ra, seq.first);
+
+        ir_opcode_t op = (seq.subtract) ? IR_SUB : IR_ADD;
+
+        if (seq.second == 0) {
+            tri_operand_instr(t, op, rd, shifted_reg, ra);
+        } else {
+            tri_operand_imm_instr(t, IR_LSLI, rd, ra, seq.second);
+            tri_operand_instr(t, op, rd, shifted_reg, rd);
         }
 
+        t->reg_alloc.free(shifted_var, false);
     }
-    
-    tri_operand_instr(t, instr, left_register, left_register, right_register);
 
-    return left_register;
+    if (value < 0) neg_instr(t, rd, rd);
 }
 
-int translate_binop_relational(translator_t* t, binop_expr_t* binop, const std::string& instr) {
-    
-    // Assume left associativity
-    if (!binop->left_assoc) translation_error::throw_error("Expression is right-associative", binop);
-    
+int translate_mult(translator_t* t, binop_expr_t* binop) {
+
     int left_value = 0;
-    bool left_success = binop->rest->evaluate(&left_value);
+    bool left_success = binop->left->evaluate(&left_value);
 
     int right_value = 0;
-    bool right_success = binop->term->evaluate(&right_value);
+    bool right_success = binop->right->evaluate(&right_value);
+
+    if (left_success == right_success) return translate_binop(t, binop, IR_MUL);
+
+    // Multiplication commutes, a constant left operand is handled like a right one
+    expr_t* operand = (left_success) ? binop->right : binop->left;
+    int value = (left_success) ? left_value : right_value;
+
+    int operand_register = operand->translate(t);
+    int result_register = allocate_result(t, "__temp__", operand_register);
+
+    mult_imm(t, result_register, operand_register, value);
+
+    return result_register;
+}
+
+// Emits the compare of a relational operation. The result register, if wanted, is allocated before the
+// compare so that no store or load is emitted between the compare and the branch
+static void translate_compare(translator_t* t, binop_expr_t* binop, int* result_register) {
+
+    int left_value = 0;
+    bool left_success = binop->left->evaluate(&left_value);
+
+    int right_value = 0;
+    bool right_success = binop->right->evaluate(&right_value);
 
     int left_register;
-    int right_register;
+    int right_register = -1;
 
     if (left_success) {
 
@@ -352,10 +538,7 @@ int translate_binop_relational(translator_t* t, binop_expr_t* binop, const std::
 
     } else {
 
-        left_register = binop->rest->translate(t);
-
-        // If the allocated register is not temporary, take ownership of it
-        left_register = take_ownership_or_allocate(t, "__temp__", left_register);
+        left_register = translate_left_operand(t, binop, right_success);
     }
 
     if (right_success) {
@@ -364,10 +547,13 @@ int translate_binop_relational(translator_t* t, binop_expr_t* binop, const std::
 
             var_info_t* temp_var;
             int reg = allocate_temp_imm(t, "__temp__", right_value, &temp_var);
+            if (result_register) *result_register = allocate_result(t, "__temp__", left_register);
             cmp_instr(t, left_register, reg);
             t->reg_alloc.free(temp_var, false);
 
         } else {
+            if (result_register) *result_register = allocate_result(t, "__temp__", left_register);
+
             // Print cmp immediate instruction
             cmpi_instr(t, left_register, right_value);
         }
@@ -375,316 +561,505 @@ int translate_binop_relational(translator_t* t, binop_expr_t* binop, const std::
 
     } else {
 
-        bool is_function_call = dynamic_cast<call_term_t*>(binop->term) != nullptr;
-        var_info_t* var;
-
-        // If term is a function call save temporary value on stack
-        if (is_function_call) {
-            var = push_temp(t, left_register);
-        }
-
-        // Translate term
-        right_register = binop->term->translate(t);
-
-        // If term is a function call restore temporary value
-        if (is_function_call) {
-            left_register = pop_temp(t, var);
-        }
+        right_register = translate_right_operand(t, binop, &left_register);
+        if (result_register) *result_register = allocate_result(t, "__temp__", left_register, right_register);
 
         // Print cmp instruction
         cmp_instr(t, left_register, right_register);
     }
+}
+
+int translate_binop_relational(translator_t* t, binop_expr_t* binop, ir_opcode_t branch_op) {
+
+    int result_register;
+    translate_compare(t, binop, &result_register);
 
     std::string true_label = t->label_allocator.get_label_name();
     std::string end_label = t->label_allocator.get_label_name();
     
     // eg. breq L1
-    branch_instr(t, instr, true_label);
+    branch_instr(t, branch_op, true_label);
 
     // addi r, NULL, 0
-    addi_instr(t, left_register, NULL_REGISTER, 0);
+    addi_instr(t, result_register, NULL_REGISTER, 0);
 
     // jmp L2
-    branch_instr(t, JMP_INSTR, end_label);
+    branch_instr(t, IR_JMP, end_label);
 
     // L1:
     print_label(t, true_label);
 
     // addi r, NULL, 1
-    addi_instr(t, left_register, NULL_REGISTER, 1);
+    addi_instr(t, result_register, NULL_REGISTER, 1);
 
     // L2:
     print_label(t, end_label);
 
-    return left_register;
+    return result_register;
 }
 
+// Skips parentheses around an expression
+static expr_t* strip_parentheses(expr_t* e) {
 
-std::string get_register_string(translator_t* t, int reg) {
-    return (t->special_registers.count(reg)) ? t->special_registers[reg] : t->reg_alloc.get_register_string(reg);
+    while (e->kind == NODE_EXPR_TERM || e->kind == NODE_TERM_EXPR) {
+        if (e->kind == NODE_EXPR_TERM) e = static_cast<expr_term_t*>(e)->expr;
+        else e = static_cast<term_expr_t*>(e)->t;
+    }
+    return e;
 }
 
-void tri_operand_instr(translator_t* t, const std::string& instr, int rd, int ra, int rb) {
+static bool is_relational(expr_t* e) {
+    return e->kind >= NODE_EQ_BINOP && e->kind <= NODE_GREATER_EQ_BINOP;
+}
 
-    std::string rd_str = get_register_string(t, rd);
-    std::string ra_str = get_register_string(t, ra);
-    std::string rb_str = get_register_string(t, rb);
+// Returns the branch taken when the relational operation is true
+static ir_opcode_t relational_branch(expr_t* e) {
 
-    std::stringstream output;
+    switch (e->kind) {
+        case NODE_EQ_BINOP:         return IR_BREQ;
+        case NODE_NEQ_BINOP:        return IR_BRNE;
+        case NODE_LESS_BINOP:       return IR_BRLT;
+        case NODE_GREATER_BINOP:    return IR_BRGT;
+        case NODE_LESS_EQ_BINOP:    return IR_BRLE;
+        default:                    return IR_BRGE;
+    }
+}
+
+// Returns the branch taken when the given one is not
+static ir_opcode_t inverse_branch(ir_opcode_t op) {
 
-    output  << instr << " " << rd_str << ", " << ra_str << ", " << rb_str;
-    t->print_instruction_row(output.str(), true);
+    switch (op) {
+        case IR_BREQ:   return IR_BRNE;
+        case IR_BRNE:   return IR_BREQ;
+        case IR_BRLT:   return IR_BRGE;
+        case IR_BRGT:   return IR_BRLE;
+        case IR_BRLE:   return IR_BRGT;
+        default:        return IR_BRLT;
+    }
 }
 
-void tri_operand_imm_instr(translator_t* t, const std::string& instr, int rd, int ra, int imm) {
+// Returns true if the expression is && or ||, or & or | of operands that are always 0 or 1 where the bitwise
+// operation is the logical one. Each operand can then be tested with a jump of its own. The right operand
+// of & and | may be skipped that way, so it must not call a function
+static bool is_logical(expr_t* e) {
 
-    std::string rd_str = get_register_string(t, rd);
-    std::string ra_str = get_register_string(t, ra);
+    e = strip_parentheses(e);
+    if (e->kind == NODE_LOGICAL_AND_BINOP || e->kind == NODE_LOGICAL_OR_BINOP) return true;
+    if (e->kind != NODE_AND_BINOP && e->kind != NODE_OR_BINOP) return false;
 
-    std::stringstream output;
+    binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+    if (contains_call(binop->right)) return false;
 
-    output  << instr << " " << rd_str << ", " << ra_str << ", " << imm;
-    t->print_instruction_row(output.str(), true);
+    for (expr_t* operand : {binop->left, binop->right}) {
+
+        operand = strip_parentheses(operand);
+        if (!is_relational(operand) && operand->kind != NODE_NOT_EXPR && !is_logical(operand)) return false;
+    }
+    return true;
 }
 
-void tri_operand_imm_str_instr(translator_t* t, const std::string& instr, int rd, int ra, const std::string& imm) {
+// Returns true if the condition is translated into more than one jump
+static bool is_chained(expr_t* e) {
 
-    std::string rd_str = get_register_string(t, rd);
-    std::string ra_str = get_register_string(t, ra);
+    e = strip_parentheses(e);
+    if (e->kind == NODE_NOT_EXPR) return is_chained(static_cast<not_expr_t*>(e)->value);
+    return is_logical(e);
+}
 
-    std::stringstream output;
+// Upper bound of the registers held at once while the expression is translated, one per node
+// and two more for the address and element size of an indexed term
+static int count_registers(expr_t* e) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        return 1 + count_registers(binop->left) + count_registers(binop->right);
+    }
 
-    output  << instr << " " << rd_str << ", " << ra_str << ", " << imm;
-    t->print_instruction_row(output.str(), true);
+    switch (e->kind) {
+        case NODE_EXPR_TERM:    return count_registers(static_cast<expr_term_t*>(e)->expr);
+        case NODE_TERM_EXPR:    return count_registers(static_cast<term_expr_t*>(e)->t);
+        case NODE_INDEXED_TERM: return 3 + count_registers(static_cast<indexed_term_t*>(e)->index);
+        case NODE_NEG_EXPR:     return 1 + count_registers(static_cast<neg_expr_t*>(e)->value);
+        case NODE_NOT_EXPR:     return 1 + count_registers(static_cast<not_expr_t*>(e)->value);
+        default:                return 1;
+    }
 }
 
-void di_operand_instr(translator_t* t, const std::string& instr, int rd, int ra) {
-    
-    std::string ra_str = get_register_string(t, rd);
-    std::string rb_str = get_register_string(t, ra);
+// Registers needed by the tests of a condition, the temporaries of one test are freed before the next.
+// One more is counted for a constant that does not fit an immediate
+static int condition_registers(expr_t* e) {
 
-    std::stringstream output;
+    e = strip_parentheses(e);
+    if (e->kind == NODE_NOT_EXPR) return condition_registers(static_cast<not_expr_t*>(e)->value);
+
+    if (is_logical(e)) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        return std::max(condition_registers(binop->left), condition_registers(binop->right));
+    }
 
-    output << instr << " " << ra_str << ", " << rb_str;
-    t->print_instruction_row(output.str(), true);
+    return count_registers(e) + 1;
 }
 
-void di_operand_imm_instr(translator_t* t, const std::string& instr, int rd, int imm) {
-    
-    std::string ra_str = get_register_string(t, rd);
+// Jumps taken to a label, the registers at the label are what all of them agree on
+struct branch_target_t {
+    std::string label;
+    register_state_t state;
+    bool reached;
+};
 
-    std::stringstream output;
+static void jump_to(translator_t* t, ir_opcode_t op, branch_target_t* target) {
+
+    register_state_t state = t->reg_alloc.get_state();
+    target->state = (target->reached) ? t->reg_alloc.common_state(target->state, state) : state;
+    target->reached = true;
+
+    branch_instr(t, op, target->label);
+}
+
+// Emits the jumps to the target taken when the condition equals jump_if. &&, || and chained & and | jump as
+// soon as one operand decides the result, ! swaps the sense of the jump. The temporaries of each test are
+// freed before its jump
+static void translate_jump(translator_t* t, expr_t* cond, bool jump_if, branch_target_t* target) {
+
+    cond = strip_parentheses(cond);
+
+    int value = 0;
+    if (cond->evaluate(&value)) {
+        if ((value != 0) == jump_if) jump_to(t, IR_JMP, target);
+        return;
+    }
+
+    if (cond->kind == NODE_NOT_EXPR) {
+        translate_jump(t, static_cast<not_expr_t*>(cond)->value, !jump_if, target);
+        return;
+    }
+
+    register_state_t before = t->reg_alloc.get_state();
+
+    if (is_relational(cond)) {
+
+        translate_compare(t, static_cast<binop_expr_t*>(cond), nullptr);
+        t->reg_alloc.free_temporaries(before);
+
+        ir_opcode_t op = relational_branch(cond);
+        jump_to(t, (jump_if) ? op : inverse_branch(op), target);
+        return;
+    }
+
+    if (is_logical(cond)) {
+
+        binop_expr_t* binop = static_cast<binop_expr_t*>(cond);
+
+        // a & b is false as soon as a is, a | b is true as soon as a is
+        bool decides = cond->kind == NODE_OR_BINOP || cond->kind == NODE_LOGICAL_OR_BINOP;
+
+        if (jump_if == decides) {
+            translate_jump(t, binop->left, jump_if, target);
+            translate_jump(t, binop->right, jump_if, target);
+            return;
+        }
+
+        // Otherwise the left operand can only skip the test of the right one
+        branch_target_t skip = { t->label_allocator.get_label_name(), {}, false };
+
+        translate_jump(t, binop->left, decides, &skip);
+        translate_jump(t, binop->right, jump_if, target);
+
+        print_label(t, skip.label);
+        if (skip.reached) t->reg_alloc.set_state(t->reg_alloc.common_state(skip.state, t->reg_alloc.get_state()));
+        return;
+    }
+
+    int reg = cond->translate(t);
+    cmpi_instr(t, reg, 0);
+    t->reg_alloc.free_temporaries(before);
+
+    jump_to(t, (jump_if) ? IR_BRNE : IR_BREQ, target);
+}
+
+// Emits the jumps of a condition with more than one of them. Jumps from several points must find changed
+// variables and temporaries in the same registers, so they are locked while the condition is translated.
+// Calls store every register and the tests may need more registers than are left unlocked, then the
+// changed variables are stored first
+static void translate_jumps(translator_t* t, expr_t* cond, bool jump_if, branch_target_t* target) {
+
+    if (!is_chained(cond)) {
+        translate_jump(t, cond, jump_if, target);
+        return;
+    }
+
+    int needed = t->reg_alloc.count_lockable() + condition_registers(cond);
+    if (contains_call(cond) || needed > REGISTER_COUNT - RESERVE_COUNT) t->reg_alloc.store_changed();
+
+    std::vector<bool> locks = t->reg_alloc.lock_registers();
+    translate_jump(t, cond, jump_if, target);
+    t->reg_alloc.restore_locks(locks);
+}
+
+register_state_t translate_condition(translator_t* t, expr_t* cond, const std::string& false_label) {
+
+    branch_target_t target = { false_label, {}, false };
+    translate_jumps(t, cond, false, &target);
+
+    t->reg_alloc.free_temporaries();
+
+    register_state_t true_state = t->reg_alloc.get_state();
+
+    // A condition that is never false does not jump
+    if (!target.reached) return true_state;
+
+    // The temporaries at the jumps are not needed after the condition
+    t->reg_alloc.set_state(target.state);
+    t->reg_alloc.free_temporaries();
+
+    register_state_t false_state = t->reg_alloc.get_state();
+    t->reg_alloc.set_state(true_state);
+
+    return false_state;
+}
+
+int translate_logical(translator_t* t, binop_expr_t* binop) {
 
-    output << instr << " " << ra_str << ", " << imm;
-    t->print_instruction_row(output.str(), true);
+    int value = 0;
+    if (binop->evaluate(&value)) {
+        var_info_t* var;
+        return allocate_temp_imm(t, "__temp__", value, &var);
+    }
+
+    branch_target_t false_target = { t->label_allocator.get_label_name(), {}, false };
+    translate_jumps(t, binop, false, &false_target);
+
+    // Both paths continue with the registers they agree on. The result register is allocated on each path
+    // from the same registers, so both paths pick the same one and emit the same stores if any
+    register_state_t joined = t->reg_alloc.get_state();
+    if (false_target.reached) joined = t->reg_alloc.common_state(false_target.state, joined);
+
+    t->reg_alloc.set_state(joined);
+
+    var_info_t* result;
+    int result_register = allocate_temp(t, "__temp__", &result);
+    addi_instr(t, result_register, NULL_REGISTER, 1);
+
+    if (!false_target.reached) return result_register;
+
+    std::string end_label = t->label_allocator.get_label_name();
+    register_state_t true_state = t->reg_alloc.get_state();
+
+    branch_instr(t, IR_JMP, end_label);
+    print_label(t, false_target.label);
+
+    t->reg_alloc.set_state(joined);
+    if (t->reg_alloc.allocate(result, false, false) != result_register) {
+        throw std::logic_error("Result of a short-circuit operation allocated to different registers");
+    }
+    addi_instr(t, result_register, NULL_REGISTER, 0);
+
+    print_label(t, end_label);
+    t->reg_alloc.set_state(true_state);
+
+    return result_register;
+}
+
+std::string get_register_string(translator_t* t, int reg) {
+    return (t->special_registers.count(reg)) ? t->special_registers[reg] : t->reg_alloc.get_register_string(reg);
+}
+
+void tri_operand_instr(translator_t* t, ir_opcode_t op, int rd, int ra, int rb) {
+
+    t->emit(ir_instr_t(op, rd, ra, rb));
+}
+
+void tri_operand_imm_instr(translator_t* t, ir_opcode_t op, int rd, int ra, int imm) {
+
+    t->emit(ir_instr_t(op, rd, ra, NO_REGISTER, imm));
+}
+
+void tri_operand_imm_str_instr(translator_t* t, ir_opcode_t op, int rd, int ra, const std::string& imm) {
+
+    ir_instr_t instr(op, rd, ra);
+    instr.symbol = imm;
+    t->emit(instr);
+}
+
+void di_operand_instr(translator_t* t, ir_opcode_t op, int rd, int ra) {
+    
+    t->emit(ir_instr_t(op, rd, ra));
 }
 
 void add_instr(translator_t* t, int rd, int ra, int rb) {
 
-    tri_operand_instr(t, ADD_INSTR, rd, ra, rb);
+    tri_operand_instr(t, IR_ADD, rd, ra, rb);
 
 }
 
 void addi_instr(translator_t* t, int rd, int ra, int imm) {
     
-    tri_operand_imm_instr(t, ADD_IMM_INSTR, rd, ra, imm);
+    tri_operand_imm_instr(t, IR_ADDI, rd, ra, imm);
 
 }
 
 void addi_instr(translator_t* t, int rd, int ra, const std::string& imm) {
     
-    tri_operand_imm_str_instr(t, ADD_IMM_INSTR, rd, ra, imm);
+    tri_operand_imm_str_instr(t, IR_ADDI, rd, ra, imm);
 
 }
 
 void sub_instr(translator_t* t, int rd, int ra, int rb) {
     
-    tri_operand_instr(t, SUB_INSTR, rd, ra, rb);
+    tri_operand_instr(t, IR_SUB, rd, ra, rb);
 
 }
 
 void subi_instr(translator_t* t, int rd, int ra, int imm) {
     
-    tri_operand_imm_instr(t, SUB_IMM_INSTR, rd, ra, imm);
+    tri_operand_imm_instr(t, IR_SUBI, rd, ra, imm);
 
 }
 
 void mult_instr(translator_t* t, int rd, int ra, int rb) {
     
-    tri_operand_instr(t, MULT_INSTR, rd, ra, rb);
+    tri_operand_instr(t, IR_MUL, rd, ra, rb);
 
 }
 
 
 void and_instr(translator_t* t, int rd, int ra, int rb) {
     
-    tri_operand_instr(t, AND_INSTR, rd, ra, rb);
+    tri_operand_instr(t, IR_AND, rd, ra, rb);
 
 }
 
 void or_instr(translator_t* t, int rd, int ra, int rb) {
     
-    tri_operand_instr(t, OR_INSTR, rd, ra, rb);
+    tri_operand_instr(t, IR_OR, rd, ra, rb);
 
 }
 
 void not_instr(translator_t* t, int rd, int ra) {
 
-    di_operand_instr(t, NOT_INSTR, rd, ra);
+    di_operand_instr(t, IR_NOT, rd, ra);
 
 }
 
 void neg_instr(translator_t* t, int rd, int ra) {
 
-    di_operand_instr(t, NEG_INSTR, rd, ra);
+    di_operand_instr(t, IR_NEG, rd, ra);
 
 }
 
 void xor_instr(translator_t* t, int rd, int ra, int rb) {
 
-    tri_operand_instr(t, XOR_INSTR, rd, ra, rb);
+    tri_operand_instr(t, IR_XOR, rd, ra, rb);
 
 }
 
 void push_instr(translator_t* t, int rd, int size) {
 
-    std::string rd_str = get_register_string(t, rd);
-
-    std::stringstream output;
-
     t->symbol_table.get_current_scope()->push(size);
 
-    output << PUSH_INSTR << "[" << size << "] " << rd_str;
-    t->print_instruction_row(output.str(), true);
+    ir_instr_t instr(IR_PUSH, NO_REGISTER, rd);
+    instr.size = size;
+    t->emit(instr);
 
 } 
 
 void pop_instr(translator_t* t, int rd, int size) {
 
-    std::string rd_str = get_register_string(t, rd);
-
-    std::stringstream output;
-
     t->symbol_table.get_current_scope()->pop(size);
 
-    output << POP_INSTR << "[" << size << "] " << rd_str;
-    t->print_instruction_row(output.str(), true);
+    ir_instr_t instr(IR_POP, rd);
+    instr.size = size;
+    t->emit(instr);
     
 } 
 
 void call_instr(translator_t* t, const std::string& function_identifier) {
 
-    std::stringstream output;
-    
-    output << CALL_INSTR << " " << function_identifier;
-    t->print_instruction_row(output.str(), true);
+    ir_instr_t instr(IR_CALL);
+    instr.symbol = function_identifier;
+    t->emit(instr);
 }
 
 void ret_instr(translator_t* t) {
 
-    std::stringstream output;
+    t->emit(ir_instr_t(IR_RET));
+}
+
+// Offsets from the base pointer are kept as numbers, so the frame can be moved after translation
+static void set_address(ir_instr_t& instr, addr_info_t* offset) {
+
+    local_addr_info_t* local = dynamic_cast<local_addr_info_t*>(offset);
 
-    output << RETURN_INSTR;
-    t->print_instruction_row(output.str(), true, true);
+    if (local != nullptr) instr.imm = local->base_offset;
+    else if (offset) instr.symbol = offset->get_address_string();
 }
 
 void store_instr(translator_t* t, int rd, int ra, addr_info_t* offset, int size) {
     
-    std::string rd_str = get_register_string(t, rd);
-    std::string ra_str = get_register_string(t, ra);
-    std::string offset_string = (offset) ? offset->get_address_string() : "0";
-
-    std::stringstream output;
-
-    output << STORE_INSTR << "[" << size << "] " << rd_str << ", " << ra_str << ", " << offset_string;
-    t->print_instruction_row(output.str(), true);
+    ir_instr_t instr(IR_STORE, NO_REGISTER, rd, ra);
+    instr.size = size;
+    set_address(instr, offset);
+    t->emit(instr);
 }
 
 void store_instr(translator_t* t, int rd, int ra, int offset, int size) {
     
-    std::string rd_str = get_register_string(t, rd);
-    std::string ra_str = get_register_string(t, ra);
-
-    std::stringstream output;
-
-    output << STORE_INSTR << "[" << size << "] " << rd_str << ", " << ra_str << ", " << offset;
-    t->print_instruction_row(output.str(), true);
+    ir_instr_t instr(IR_STORE, NO_REGISTER, rd, ra, offset);
+    instr.size = size;
+    t->emit(instr);
 }
 
 void load_instr(translator_t* t, int rd, int ra, addr_info_t* offset, int size) {
     
-    std::string rd_str = get_register_string(t, rd);
-    std::string ra_str = get_register_string(t, ra);
-    std::string offset_string = (offset) ? offset->get_address_string() : "0";
-
-    std::stringstream output;
-
-    output << LOAD_INSTR << "[" << size << "] " << rd_str << ", " << ra_str << ", " << offset_string;
-    t->print_instruction_row(output.str(), true);
+    ir_instr_t instr(IR_LOAD, rd, ra);
+    instr.size = size;
+    set_address(instr, offset);
+    t->emit(instr);
 }
 
 void load_instr(translator_t* t, int rd, int ra, int offset, int size) {
     
-    std::string rd_str = get_register_string(t, rd);
-    std::string ra_str = get_register_string(t, ra);
-
-    std::stringstream output;
-
-    output << LOAD_INSTR << "[" << size << "] " << rd_str << ", " << ra_str << ", " << offset;
-    t->print_instruction_row(output.str(), true);
+    ir_instr_t instr(IR_LOAD, rd, ra, NO_REGISTER, offset);
+    instr.size = size;
+    t->emit(instr);
 }
 
 void movhi_instr(translator_t* t, int rd, int imm) {
 
-    std::string rd_str = get_register_string(t, rd);
-
-    std::stringstream output;
-
-    output << MOVHI_INSTR << " " << rd_str << ", " << rd_str << ", " << imm;
-    t->print_instruction_row(output.str(), true);
+    t->emit(ir_instr_t(IR_MOVHI, rd, NO_REGISTER, NO_REGISTER, imm));
 }
 
 void movlo_instr(translator_t* t, int rd, int imm) {
 
-    std::string rd_str = get_register_string(t, rd);
-
-    std::stringstream output;
-
-    output << MOVLO_INSTR << " " << rd_str << ", " << rd_str << ", " << imm;
-    t->print_instruction_row(output.str(), true);
+    t->emit(ir_instr_t(IR_MOVLO, rd, NO_REGISTER, NO_REGISTER, imm));
 }
 
 void move_instr(translator_t* t, int rd, int ra) {
 
-    di_operand_instr(t, MOVE_INSTR, rd, ra);
+    di_operand_instr(t, IR_MOVE, rd, ra);
 
 }
 
 void cmp_instr(translator_t* t, int ra, int rb) {
     
-    di_operand_instr(t, CMP_INSTR, ra, rb);
+    t->emit(ir_instr_t(IR_CMP, NO_REGISTER, ra, rb));
 
 }
 
 void cmpi_instr(translator_t* t, int ra, int imm) {
     
-    di_operand_imm_instr(t, CMP_IMM_INSTR, ra, imm);
+    t->emit(ir_instr_t(IR_CMPI, NO_REGISTER, ra, NO_REGISTER, imm));
 
 }
 
 void print_label(translator_t* t, const std::string& label) {
 
-    std::stringstream output;
-
-    output << label << ":";
-    t->print_instruction_row(output.str(), false);
+    t->emit_label(label);
 }
 
-void branch_instr(translator_t* t, const std::string& instr, const std::string& label) {
+void branch_instr(translator_t* t, ir_opcode_t op, const std::string& label) {
     
-    std::stringstream output;
-
-    output << instr << " " << label;
-    t->print_instruction_row(output.str(), true);
-
-}
\ No newline at end of file
+    ir_instr_t instr(op);
+    instr.symbol = label;
+    t->emit(instr);
+}
@@ -0,0 +1,976 @@
+#include "../include/inliner.h"
+#include "../include/error_handling.h"
+
+// Skips the parentheses and term wrappers around an expression
+static expr_t* unwrap(expr_t* e) {
+
+    while (true) {
+        if (e->kind == NODE_TERM_EXPR) e = static_cast<term_expr_t*>(e)->t;
+        else if (e->kind == NODE_EXPR_TERM) e = static_cast<expr_term_t*>(e)->expr;
+        else return e;
+    }
+}
+
+static bool contains_call(expr_t* e) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        return contains_call(binop->left) || contains_call(binop->right);
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:      return contains_call(static_cast<neg_expr_t*>(e)->value);
+        case NODE_NOT_EXPR:      return contains_call(static_cast<not_expr_t*>(e)->value);
+        case NODE_TERM_EXPR:     return contains_call(static_cast<term_expr_t*>(e)->t);
+        case NODE_EXPR_TERM:     return contains_call(static_cast<expr_term_t*>(e)->expr);
+        case NODE_INDEXED_TERM:  return contains_call(static_cast<indexed_term_t*>(e)->index);
+        case NODE_CALL_TERM:     return true;
+        default:                 return false;
+    }
+}
+
+template <typename T>
+T* inliner_t::copy(const T* node) {
+
+    T* duplicate = arena.create<T>();
+    *duplicate = *node;
+    return duplicate;
+}
+
+template <typename T>
+T* inliner_t::create(const node_t* origin) {
+
+    T* node = arena.create<T>();
+    node->tokens = origin->tokens;
+    return node;
+}
+
+template <typename L, typename E>
+L* inliner_t::create_list(const std::vector<E*>& items, const node_t* origin) {
+
+    // Empty lists are represented by nullptr, like the parser does
+    if (items.empty()) return nullptr;
+
+    L* list = create<L>(origin);
+    list->count = items.size();
+    list->items = static_cast<E**>(arena.allocate(items.size() * sizeof(E*), alignof(E*)));
+
+    for (int i = 0; i < list->count; i++) list->items[i] = items[i];
+    return list;
+}
+
+inliner_t::inliner_t() {
+    caller = nullptr;
+    result = -1;
+    copy_loops = 0;
+    copy_wrapped = false;
+    depth = 0;
+    next_id = 0;
+    expanded = 0;
+}
+
+void inliner_t::run(program_t* program) {
+
+    summaries.clear();
+    expanded = 0;
+
+    for (decl_t* decl : *program->decls) {
+        if (decl->kind != NODE_FUNC_DECL) continue;
+
+        func_decl_t* func = static_cast<func_decl_t*>(decl);
+
+        // Multiple definitions are reported when translated
+        if (func->stmt == nullptr || summaries.count(func->id)) continue;
+
+        summary_t& summary = summaries[func->id];
+        summary.func = func;
+
+        scopes.clear();
+        scopes.emplace_back();
+        if (func->param_list != nullptr) {
+            for (param_decl_t* param : *func->param_list) scopes.back().insert(param->id);
+        }
+
+        summarize_stmt(func->stmt, summary, 0);
+    }
+
+    symbol_t main_id = get_interner().intern("main");
+
+    for (decl_t* decl : *program->decls) {
+        if (decl->kind != NODE_FUNC_DECL) continue;
+
+        func_decl_t* func = static_cast<func_decl_t*>(decl);
+
+        auto it = summaries.find(func->id);
+        if (it == summaries.end() || it->second.func != func) continue;
+
+        summary_t& summary = it->second;
+        bool recursive = is_recursive(func->id);
+
+        summary.inlinable = (summary.size <= INLINE_MAX_SIZE || func->is_inline) && !recursive &&
+            !summary.has_asm && !summary.escaping_jump && func->id != main_id;
+
+        if (func->is_inline && recursive) {
+            output_warning("Recursive function \"" + symbol_name(func->id) + "\" is not inlined", func);
+        } else if (func->is_inline && summary.has_asm) {
+            output_warning("Function \"" + symbol_name(func->id) + "\" with inline assembly is not inlined", func);
+        }
+    }
+
+    for (decl_t* decl : *program->decls) {
+        if (decl->kind != NODE_FUNC_DECL) continue;
+
+        func_decl_t* func = static_cast<func_decl_t*>(decl);
+
+        auto it = summaries.find(func->id);
+        if (it == summaries.end() || it->second.func != func) continue;
+
+        caller = &it->second;
+
+        scopes.clear();
+        scopes.emplace_back();
+        if (func->param_list != nullptr) {
+            for (param_decl_t* param : *func->param_list) scopes.back().insert(param->id);
+        }
+
+        rewrite_block(func->stmt);
+    }
+
+    scopes.clear();
+    renames.clear();
+    caller = nullptr;
+}
+
+bool inliner_t::is_visible(symbol_t name) const {
+
+    for (const auto& scope : scopes) {
+        if (scope.count(name)) return true;
+    }
+    return false;
+}
+
+bool inliner_t::is_safe(symbol_t name) const {
+    return is_visible(name) && !caller->address_taken.count(name);
+}
+
+void inliner_t::reference(symbol_t name, summary_t& summary) {
+
+    // Names not declared by the function refer to globals
+    if (!is_visible(name)) summary.free_names.insert(name);
+}
+
+void inliner_t::summarize_stmt(stmt_t* stmt, summary_t& summary, int loops) {
+
+    summary.size++;
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+
+            scopes.emplace_back();
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) summarize_stmt(s, summary, loops);
+            }
+            scopes.pop_back();
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+
+            summarize_expr(if_stmt->cond, summary);
+            summarize_stmt(if_stmt->actions, summary, loops);
+            if (if_stmt->else_actions != nullptr) summarize_stmt(if_stmt->else_actions, summary, loops);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+
+            summarize_expr(while_stmt->cond, summary);
+            summarize_stmt(while_stmt->actions, summary, loops + 1);
+            break;
+        }
+        case NODE_ASM_STMT: {
+            asm_stmt_t* asm_stmt = static_cast<asm_stmt_t*>(stmt);
+
+            summary.has_asm = true;
+            if (asm_stmt->params != nullptr) {
+                for (term_t* param : *asm_stmt->params) summarize_expr(param, summary);
+            }
+            break;
+        }
+        case NODE_BREAK_STMT:
+            if (static_cast<break_stmt_t*>(stmt)->loop_id >= loops) summary.escaping_jump = true;
+            break;
+        case NODE_CONTINUE_STMT:
+            if (static_cast<continue_stmt_t*>(stmt)->loop_id >= loops) summary.escaping_jump = true;
+            break;
+        case NODE_ASSIGNMENT_STMT: {
+            assignment_stmt_t* assignment = static_cast<assignment_stmt_t*>(stmt);
+
+            reference(assignment->identifier, summary);
+            summarize_expr(assignment->rvalue, summary);
+            break;
+        }
+        case NODE_DEREF_ASSIGNMENT_STMT: {
+            deref_assignment_stmt_t* assignment = static_cast<deref_assignment_stmt_t*>(stmt);
+
+            reference(assignment->identifier, summary);
+            summarize_expr(assignment->rvalue, summary);
+            break;
+        }
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+
+            reference(assignment->identifier, summary);
+            summarize_expr(assignment->index, summary);
+            summarize_expr(assignment->rvalue, summary);
+            break;
+        }
+        case NODE_RETURN_STMT: {
+            return_stmt_t* return_stmt = static_cast<return_stmt_t*>(stmt);
+
+            summary.returns++;
+            if (return_stmt->return_value != nullptr) summarize_expr(return_stmt->return_value, summary);
+            break;
+        }
+        case NODE_EXPR_STMT:
+            summarize_expr(static_cast<expr_stmt_t*>(stmt)->e, summary);
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+
+            // The variable is declared before its value is translated
+            scopes.back().insert(decl->id);
+            if (decl->value != nullptr) summarize_expr(decl->value, summary);
+            break;
+        }
+        case NODE_SIMPLE_ARRAY_DECL: {
+            simple_array_decl_t* decl = static_cast<simple_array_decl_t*>(stmt);
+
+            summarize_expr(decl->size, summary);
+            scopes.back().insert(decl->identifier);
+            break;
+        }
+        case NODE_INIT_LIST_ARRAY_DECL: {
+            init_list_array_decl_t* decl = static_cast<init_list_array_decl_t*>(stmt);
+
+            if (decl->init_list != nullptr) {
+                for (expr_t* e : *decl->init_list) summarize_expr(e, summary);
+            }
+            scopes.back().insert(decl->identifier);
+            break;
+        }
+        case NODE_STR_ARRAY_DECL:
+            scopes.back().insert(static_cast<str_array_decl_t*>(stmt)->identifier);
+            break;
+        default:
+            break;
+    }
+}
+
+void inliner_t::summarize_expr(expr_t* e, summary_t& summary) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+
+        summary.size++;
+        summarize_expr(binop->left, summary);
+        summarize_expr(binop->right, summary);
+        return;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:
+            summary.size++;
+            summarize_expr(static_cast<neg_expr_t*>(e)->value, summary);
+            break;
+        case NODE_NOT_EXPR:
+            summary.size++;
+            summarize_expr(static_cast<not_expr_t*>(e)->value, summary);
+            break;
+        case NODE_TERM_EXPR:
+            summarize_expr(static_cast<term_expr_t*>(e)->t, summary);
+            break;
+        case NODE_EXPR_TERM:
+            summarize_expr(static_cast<expr_term_t*>(e)->expr, summary);
+            break;
+        case NODE_ID_TERM:
+            summary.size++;
+            reference(static_cast<id_term_t*>(e)->identifier, summary);
+            break;
+        case NODE_DEREF_TERM:
+            summary.size++;
+            reference(static_cast<deref_term_t*>(e)->identifier, summary);
+            break;
+        case NODE_ADDR_OF_TERM: {
+            addr_of_term_t* addr_of = static_cast<addr_of_term_t*>(e);
+
+            summary.size++;
+            reference(addr_of->identifier, summary);
+            summary.address_taken.insert(addr_of->identifier);
+            break;
+        }
+        case NODE_INDEXED_TERM: {
+            indexed_term_t* indexed = static_cast<indexed_term_t*>(e);
+
+            summary.size++;
+            reference(indexed->identifier, summary);
+            summarize_expr(indexed->index, summary);
+            break;
+        }
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+
+            summary.size++;
+            summary.calls.insert(call->function_identifier);
+            if (call->params != nullptr) {
+                for (expr_t* param : *call->params) summarize_expr(param, summary);
+            }
+            break;
+        }
+        default:
+            summary.size++;
+            break;
+    }
+}
+
+bool inliner_t::is_recursive(symbol_t name) {
+
+    std::unordered_set<symbol_t> visited;
+    std::vector<symbol_t> pending(summaries[name].calls.begin(), summaries[name].calls.end());
+
+    while (!pending.empty()) {
+        symbol_t callee = pending.back();
+        pending.pop_back();
+
+        if (callee == name) return true;
+        if (!visited.insert(callee).second) continue;
+
+        auto it = summaries.find(callee);
+        if (it != summaries.end()) pending.insert(pending.end(), it->second.calls.begin(), it->second.calls.end());
+    }
+    return false;
+}
+
+bool inliner_t::can_inline(call_term_t* call) const {
+
+    if (depth >= INLINE_MAX_DEPTH) return false;
+
+    auto it = summaries.find(call->function_identifier);
+    if (it == summaries.end() || !it->second.inlinable) return false;
+
+    const summary_t& callee = it->second;
+
+    // Wrong argument counts are reported when the call is translated
+    int arguments = (call->params != nullptr) ? call->params->count : 0;
+    int params = (callee.func->param_list != nullptr) ? callee.func->param_list->count : 0;
+    if (arguments != params) return false;
+
+    // A global the body refers to must not be hidden by a local of the caller
+    for (symbol_t name : callee.free_names) {
+        if (is_visible(name)) return false;
+    }
+
+    return true;
+}
+
+call_term_t* inliner_t::find_call(stmt_t* stmt) {
+
+    bool blocked = false;
+
+    switch (stmt->kind) {
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+            return (decl->value != nullptr) ? find_call(decl->value, &blocked) : nullptr;
+        }
+        case NODE_ASSIGNMENT_STMT:
+            return find_call(static_cast<assignment_stmt_t*>(stmt)->rvalue, &blocked);
+        case NODE_RETURN_STMT: {
+            return_stmt_t* return_stmt = static_cast<return_stmt_t*>(stmt);
+            return (return_stmt->return_value != nullptr) ? find_call(return_stmt->return_value, &blocked) : nullptr;
+        }
+        case NODE_EXPR_STMT:
+            return find_call(static_cast<expr_stmt_t*>(stmt)->e, &blocked);
+        case NODE_IF_STMT:
+            return find_call(static_cast<if_stmt_t*>(stmt)->cond, &blocked);
+        case NODE_DEREF_ASSIGNMENT_STMT: {
+            deref_assignment_stmt_t* assignment = static_cast<deref_assignment_stmt_t*>(stmt);
+
+            if (!is_safe(assignment->identifier)) return nullptr;
+            return find_call(assignment->rvalue, &blocked);
+        }
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+
+            if (!is_safe(assignment->identifier)) return nullptr;
+
+            // The call may be expanded before the other operand if that one has no effects either way
+            call_term_t* index_call = find_call(assignment->index, &blocked);
+            bool index_safe = index_call == nullptr && !blocked;
+
+            blocked = false;
+            call_term_t* rvalue_call = find_call(assignment->rvalue, &blocked);
+            bool rvalue_safe = rvalue_call == nullptr && !blocked;
+
+            if (index_call != nullptr && rvalue_safe) return index_call;
+            if (rvalue_call != nullptr && index_safe) return rvalue_call;
+            return nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+call_term_t* inliner_t::find_call(expr_t* e, bool* blocked) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+
+        call_term_t* call = find_call(binop->left, blocked);
+        if (call != nullptr || *blocked) return call;
+
+        // The right operand of && and || is not always evaluated
+        if (e->kind == NODE_LOGICAL_AND_BINOP || e->kind == NODE_LOGICAL_OR_BINOP) {
+            *blocked = true;
+            return nullptr;
+        }
+
+        return find_call(binop->right, blocked);
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:     return find_call(static_cast<neg_expr_t*>(e)->value, blocked);
+        case NODE_NOT_EXPR:     return find_call(static_cast<not_expr_t*>(e)->value, blocked);
+        case NODE_TERM_EXPR:    return find_call(static_cast<term_expr_t*>(e)->t, blocked);
+        case NODE_EXPR_TERM:    return find_call(static_cast<expr_term_t*>(e)->expr, blocked);
+        case NODE_LIT_TERM:
+        case NODE_ADDR_OF_TERM:
+            return nullptr;
+        case NODE_ID_TERM:
+            if (!is_safe(static_cast<id_term_t*>(e)->identifier)) *blocked = true;
+            return nullptr;
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+
+            if (can_inline(call)) return call;
+
+            // Arguments are pushed from the last to the first
+            if (call->params != nullptr) {
+                for (int i = call->params->count - 1; i >= 0; i--) {
+                    call_term_t* inner = find_call((*call->params)[i], blocked);
+                    if (inner != nullptr || *blocked) return inner;
+                }
+            }
+
+            *blocked = true;
+            return nullptr;
+        }
+        default:
+            // Loads through pointers may read what the body writes
+            *blocked = true;
+            return nullptr;
+    }
+}
+
+template <typename T>
+bool inliner_t::replace(T*& slot, call_term_t* call, id_term_t* value) {
+
+    if (slot == nullptr) return false;
+
+    if (slot == call) {
+        slot = value;
+        return true;
+    }
+
+    expr_t* e = slot;
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        return replace(binop->left, call, value) || replace(binop->right, call, value);
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:      return replace(static_cast<neg_expr_t*>(e)->value, call, value);
+        case NODE_NOT_EXPR:      return replace(static_cast<not_expr_t*>(e)->value, call, value);
+        case NODE_TERM_EXPR:     return replace(static_cast<term_expr_t*>(e)->t, call, value);
+        case NODE_EXPR_TERM:     return replace(static_cast<expr_term_t*>(e)->expr, call, value);
+        case NODE_INDEXED_TERM:  return replace(static_cast<indexed_term_t*>(e)->index, call, value);
+        case NODE_CALL_TERM: {
+            params_t* params = static_cast<call_term_t*>(e)->params;
+
+            if (params != nullptr) {
+                for (int i = 0; i < params->count; i++) {
+                    if (replace(params->items[i], call, value)) return true;
+                }
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+void inliner_t::replace_call(stmt_t* stmt, call_term_t* call, id_term_t* value) {
+
+    switch (stmt->kind) {
+        case NODE_VAR_DECL:
+            replace(static_cast<var_decl_t*>(stmt)->value, call, value);
+            break;
+        case NODE_ASSIGNMENT_STMT:
+            replace(static_cast<assignment_stmt_t*>(stmt)->rvalue, call, value);
+            break;
+        case NODE_RETURN_STMT:
+            replace(static_cast<return_stmt_t*>(stmt)->return_value, call, value);
+            break;
+        case NODE_EXPR_STMT:
+            replace(static_cast<expr_stmt_t*>(stmt)->e, call, value);
+            break;
+        case NODE_IF_STMT:
+            replace(static_cast<if_stmt_t*>(stmt)->cond, call, value);
+            break;
+        case NODE_DEREF_ASSIGNMENT_STMT:
+            replace(static_cast<deref_assignment_stmt_t*>(stmt)->rvalue, call, value);
+            break;
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+            if (!replace(assignment->index, call, value)) replace(assignment->rvalue, call, value);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+id_term_t* inliner_t::expand(call_term_t* call, std::vector<stmt_t*>& out, bool result_used) {
+
+    summary_t& callee = summaries[call->function_identifier];
+    func_decl_t* func = callee.func;
+
+    std::string prefix = "__inline_" + std::to_string(next_id++);
+
+    stmts_t* body = func->stmt->statements;
+    bool last_is_return = body != nullptr && body->back()->kind == NODE_RETURN_STMT;
+
+    id_term_t* value = nullptr;
+    result = -1;
+
+    if (result_used) {
+        result = get_interner().intern(prefix);
+
+        var_decl_t* decl = create<var_decl_t>(call);
+        decl->type = func->type;
+        decl->id = result;
+        decl->is_pointer = false;
+
+        // Falling off the end of a function returns 0
+        if (!last_is_return) {
+            lit_term_t* zero = create<lit_term_t>(call);
+            zero->literal = 0;
+            decl->value = zero;
+        }
+
+        out.push_back(decl);
+        scopes.back().insert(result);
+
+        value = create<id_term_t>(call);
+        value->identifier = result;
+    }
+
+    std::vector<stmt_t*> statements;
+    renames.clear();
+    renames.emplace_back();
+
+    // Arguments are evaluated from the last to the first, like they are pushed by a call
+    int count = (func->param_list != nullptr) ? func->param_list->count : 0;
+    for (int i = count - 1; i >= 0; i--) {
+        param_decl_t* param = (*func->param_list)[i];
+        expr_t* argument = (*call->params)[i];
+
+        var_decl_t* decl = create<var_decl_t>(argument);
+        decl->type = param->type;
+        decl->id = get_interner().intern(prefix + "_" + symbol_name(param->id));
+        decl->is_pointer = param->is_pointer;
+        decl->value = argument;
+
+        renames.back()[param->id] = decl->id;
+        statements.push_back(decl);
+    }
+
+    copy_loops = 0;
+    copy_wrapped = callee.returns > 1 || (callee.returns == 1 && !last_is_return);
+
+    // The body is a scope of its own, so it may declare the names of the parameters
+    std::vector<stmt_t*> copied;
+    renames.emplace_back();
+    if (body != nullptr) {
+        for (stmt_t* stmt : *body) copy_into(stmt, copied);
+    }
+    renames.clear();
+
+    if (copy_wrapped) {
+
+        // The copy of a last return already breaks out of the loop
+        if (!last_is_return) {
+            break_stmt_t* exit = create<break_stmt_t>(call);
+            exit->loop_id = 0;
+            copied.push_back(exit);
+        }
+
+        lit_term_t* one = create<lit_term_t>(call);
+        one->literal = 1;
+
+        block_stmt_t* loop_body = create<block_stmt_t>(call);
+        loop_body->statements = create_list<stmts_t>(copied, call);
+
+        while_stmt_t* loop = create<while_stmt_t>(call);
+        loop->cond = one;
+        loop->actions = loop_body;
+
+        statements.push_back(loop);
+
+    } else {
+        statements.insert(statements.end(), copied.begin(), copied.end());
+    }
+
+    block_stmt_t* block = create<block_stmt_t>(call);
+    block->statements = create_list<stmts_t>(statements, call);
+
+    // The caller now refers to the globals of the body
+    caller->free_names.insert(callee.free_names.begin(), callee.free_names.end());
+    expanded++;
+
+    // Calls in the arguments and the body are expanded in turn
+    depth++;
+    rewrite_block(block);
+    depth--;
+
+    out.push_back(block);
+    return value;
+}
+
+void inliner_t::rewrite_block(block_stmt_t* block) {
+
+    if (block->statements == nullptr) return;
+
+    stmts_t* statements = block->statements;
+    std::vector<stmt_t*> out;
+
+    scopes.emplace_back();
+    for (stmt_t* stmt : *statements) rewrite_into(stmt, out);
+    scopes.pop_back();
+
+    bool changed = (int) out.size() != statements->count;
+    for (int i = 0; !changed && i < statements->count; i++) changed = out[i] != (*statements)[i];
+
+    if (changed) block->statements = create_list<stmts_t>(out, statements);
+}
+
+stmt_t* inliner_t::rewrite_stmt(stmt_t* stmt) {
+
+    std::vector<stmt_t*> out;
+
+    scopes.emplace_back();
+    rewrite_into(stmt, out);
+    scopes.pop_back();
+
+    if (out.size() == 1) return out[0];
+
+    block_stmt_t* block = create<block_stmt_t>(stmt);
+    block->statements = create_list<stmts_t>(out, stmt);
+    return block;
+}
+
+void inliner_t::rewrite_into(stmt_t* stmt, std::vector<stmt_t*>& out) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT:
+            rewrite_block(static_cast<block_stmt_t*>(stmt));
+            out.push_back(stmt);
+            return;
+        case NODE_WHILE_STMT: {
+            // The condition is evaluated on every iteration, calls in it are left as they are
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+            while_stmt->actions = rewrite_stmt(while_stmt->actions);
+            out.push_back(stmt);
+            return;
+        }
+        default:
+            break;
+    }
+
+    call_term_t* call;
+    while ((call = find_call(stmt)) != nullptr) {
+
+        // A call whose value is not used replaces its statement
+        if (stmt->kind == NODE_EXPR_STMT && unwrap(static_cast<expr_stmt_t*>(stmt)->e) == call) {
+            expand(call, out, false);
+            return;
+        }
+
+        id_term_t* value = expand(call, out, true);
+        replace_call(stmt, call, value);
+    }
+
+    switch (stmt->kind) {
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+
+            if_stmt->actions = rewrite_stmt(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) if_stmt->else_actions = rewrite_stmt(if_stmt->else_actions);
+            break;
+        }
+        case NODE_VAR_DECL:
+            scopes.back().insert(static_cast<var_decl_t*>(stmt)->id);
+            break;
+        case NODE_SIMPLE_ARRAY_DECL:
+        case NODE_INIT_LIST_ARRAY_DECL:
+        case NODE_STR_ARRAY_DECL:
+            scopes.back().insert(static_cast<array_decl_t*>(stmt)->identifier);
+            break;
+        default:
+            break;
+    }
+
+    out.push_back(stmt);
+}
+
+symbol_t inliner_t::rename(symbol_t name) const {
+
+    for (int i = renames.size() - 1; i >= 0; i--) {
+        auto it = renames[i].find(name);
+        if (it != renames[i].end()) return it->second;
+    }
+    return name;
+}
+
+void inliner_t::copy_into(stmt_t* stmt, std::vector<stmt_t*>& out) {
+
+    if (stmt->kind != NODE_RETURN_STMT) {
+        out.push_back(copy_stmt(stmt));
+        return;
+    }
+
+    expr_t* value = static_cast<return_stmt_t*>(stmt)->return_value;
+
+    if (value != nullptr && result != -1) {
+
+        assignment_stmt_t* assignment = create<assignment_stmt_t>(stmt);
+        assignment->identifier = result;
+        assignment->rvalue = copy_expr(value);
+        out.push_back(assignment);
+
+    } else if (value != nullptr && contains_call(value)) {
+
+        // The value is not used but its calls still have to be made
+        expr_stmt_t* expr_stmt = create<expr_stmt_t>(stmt);
+        expr_stmt->e = copy_expr(value);
+        out.push_back(expr_stmt);
+    }
+
+    if (copy_wrapped) {
+        break_stmt_t* exit = create<break_stmt_t>(stmt);
+        exit->loop_id = copy_loops;
+        out.push_back(exit);
+    }
+}
+
+stmt_t* inliner_t::copy_branch(stmt_t* stmt) {
+
+    std::vector<stmt_t*> statements;
+    copy_into(stmt, statements);
+
+    if (statements.size() == 1) return statements[0];
+
+    block_stmt_t* block = create<block_stmt_t>(stmt);
+    block->statements = create_list<stmts_t>(statements, stmt);
+    return block;
+}
+
+stmt_t* inliner_t::copy_stmt(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = copy(static_cast<block_stmt_t*>(stmt));
+
+            std::vector<stmt_t*> statements;
+            renames.emplace_back();
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) copy_into(s, statements);
+            }
+            renames.pop_back();
+
+            block->statements = create_list<stmts_t>(statements, block);
+            return block;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = copy(static_cast<if_stmt_t*>(stmt));
+
+            if_stmt->cond = copy_expr(if_stmt->cond);
+            if_stmt->actions = copy_branch(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) if_stmt->else_actions = copy_branch(if_stmt->else_actions);
+            return if_stmt;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = copy(static_cast<while_stmt_t*>(stmt));
+
+            while_stmt->cond = copy_expr(while_stmt->cond);
+            copy_loops++;
+            while_stmt->actions = copy_branch(while_stmt->actions);
+            copy_loops--;
+            return while_stmt;
+        }
+        case NODE_BREAK_STMT:
+            return copy(static_cast<break_stmt_t*>(stmt));
+        case NODE_CONTINUE_STMT:
+            return copy(static_cast<continue_stmt_t*>(stmt));
+        case NODE_ASSIGNMENT_STMT: {
+            assignment_stmt_t* assignment = copy(static_cast<assignment_stmt_t*>(stmt));
+
+            assignment->identifier = rename(assignment->identifier);
+            assignment->rvalue = copy_expr(assignment->rvalue);
+            return assignment;
+        }
+        case NODE_DEREF_ASSIGNMENT_STMT: {
+            deref_assignment_stmt_t* assignment = copy(static_cast<deref_assignment_stmt_t*>(stmt));
+
+            assignment->identifier = rename(assignment->identifier);
+            assignment->rvalue = copy_expr(assignment->rvalue);
+            return assignment;
+        }
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = copy(static_cast<indexed_assignment_stmt_t*>(stmt));
+
+            assignment->identifier = rename(assignment->identifier);
+            assignment->index = copy_expr(assignment->index);
+            assignment->rvalue = copy_expr(assignment->rvalue);
+            return assignment;
+        }
+        case NODE_EXPR_STMT: {
+            expr_stmt_t* expr_stmt = copy(static_cast<expr_stmt_t*>(stmt));
+
+            expr_stmt->e = copy_expr(expr_stmt->e);
+            return expr_stmt;
+        }
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = copy(static_cast<var_decl_t*>(stmt));
+
+            // A declaration hides a parameter of the same name
+            renames.back()[decl->id] = decl->id;
+            if (decl->value != nullptr) decl->value = copy_expr(decl->value);
+            return decl;
+        }
+        case NODE_SIMPLE_ARRAY_DECL: {
+            simple_array_decl_t* decl = copy(static_cast<simple_array_decl_t*>(stmt));
+
+            decl->size = copy_expr(decl->size);
+            renames.back()[decl->identifier] = decl->identifier;
+            return decl;
+        }
+        case NODE_INIT_LIST_ARRAY_DECL: {
+            init_list_array_decl_t* decl = copy(static_cast<init_list_array_decl_t*>(stmt));
+
+            if (decl->init_list != nullptr) {
+                std::vector<expr_t*> values;
+                for (expr_t* e : *decl->init_list) values.push_back(copy_expr(e));
+                decl->init_list = create_list<init_list_t>(values, decl->init_list);
+            }
+            renames.back()[decl->identifier] = decl->identifier;
+            return decl;
+        }
+        case NODE_STR_ARRAY_DECL: {
+            str_array_decl_t* decl = copy(static_cast<str_array_decl_t*>(stmt));
+
+            renames.back()[decl->identifier] = decl->identifier;
+            return decl;
+        }
+        default:
+            // Functions with inline assembly are not inlined
+            return stmt;
+    }
+}
+
+expr_t* inliner_t::copy_expr(expr_t* e) {
+
+    if (e->is_binop()) {
+
+        binop_expr_t* binop;
+        switch (e->kind) {
+            case NODE_ADD_BINOP:            binop = copy(static_cast<add_binop_t*>(e)); break;
+            case NODE_SUB_BINOP:            binop = copy(static_cast<sub_binop_t*>(e)); break;
+            case NODE_MULT_BINOP:           binop = copy(static_cast<mult_binop_t*>(e)); break;
+            case NODE_SHIFT_LEFT_BINOP:     binop = copy(static_cast<shift_left_binop_t*>(e)); break;
+            case NODE_SHIFT_RIGHT_BINOP:    binop = copy(static_cast<shift_right_binop_t*>(e)); break;
+            case NODE_AND_BINOP:            binop = copy(static_cast<and_binop_t*>(e)); break;
+            case NODE_OR_BINOP:             binop = copy(static_cast<or_binop_t*>(e)); break;
+            case NODE_LOGICAL_AND_BINOP:    binop = copy(static_cast<logical_and_binop_t*>(e)); break;
+            case NODE_LOGICAL_OR_BINOP:     binop = copy(static_cast<logical_or_binop_t*>(e)); break;
+            case NODE_EQ_BINOP:             binop = copy(static_cast<eq_binop_t*>(e)); break;
+            case NODE_NEQ_BINOP:            binop = copy(static_cast<neq_binop_t*>(e)); break;
+            case NODE_LESS_BINOP:           binop = copy(static_cast<less_binop_t*>(e)); break;
+            case NODE_GREATER_BINOP:        binop = copy(static_cast<greater_binop_t*>(e)); break;
+            case NODE_LESS_EQ_BINOP:        binop = copy(static_cast<less_eq_binop_t*>(e)); break;
+            default:                        binop = copy(static_cast<greater_eq_binop_t*>(e)); break;
+        }
+
+        binop->left = copy_expr(binop->left);
+        binop->right = copy_expr(binop->right);
+        return binop;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR: {
+            neg_expr_t* neg = copy(static_cast<neg_expr_t*>(e));
+            neg->value = copy_term(neg->value);
+            return neg;
+        }
+        case NODE_NOT_EXPR: {
+            not_expr_t* not_expr = copy(static_cast<not_expr_t*>(e));
+            not_expr->value = copy_term(not_expr->value);
+            return not_expr;
+        }
+        case NODE_TERM_EXPR: {
+            term_expr_t* term_expr = copy(static_cast<term_expr_t*>(e));
+            term_expr->t = copy_term(term_expr->t);
+            return term_expr;
+        }
+        case NODE_EXPR_TERM: {
+            expr_term_t* expr_term = copy(static_cast<expr_term_t*>(e));
+            expr_term->expr = copy_expr(expr_term->expr);
+            return expr_term;
+        }
+        case NODE_ID_TERM: {
+            id_term_t* id = copy(static_cast<id_term_t*>(e));
+            id->identifier = rename(id->identifier);
+            id->is_constant = false;
+            return id;
+        }
+        case NODE_CALL_TERM: {
+            call_term_t* call = copy(static_cast<call_term_t*>(e));
+
+            if (call->params != nullptr) {
+                std::vector<expr_t*> params;
+                for (expr_t* param : *call->params) params.push_back(copy_expr(param));
+                call->params = create_list<params_t>(params, call->params);
+            }
+            return call;
+        }
+        case NODE_ADDR_OF_TERM: {
+            addr_of_term_t* addr_of = copy(static_cast<addr_of_term_t*>(e));
+            addr_of->identifier = rename(addr_of->identifier);
+            caller->address_taken.insert(addr_of->identifier);
+            return addr_of;
+        }
+        case NODE_DEREF_TERM: {
+            deref_term_t* deref = copy(static_cast<deref_term_t*>(e));
+            deref->identifier = rename(deref->identifier);
+            return deref;
+        }
+        case NODE_INDEXED_TERM: {
+            indexed_term_t* indexed = copy(static_cast<indexed_term_t*>(e));
+            indexed->identifier = rename(indexed->identifier);
+            indexed->index = copy_expr(indexed->index);
+            return indexed;
+        }
+        default:
+            return copy(static_cast<lit_term_t*>(e));
+    }
+}
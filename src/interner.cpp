@@ -0,0 +1,39 @@
+#include "../include/interner.h"
+
+interner_t::interner_t() {
+    symbols = std::unordered_map<std::string_view, symbol_t>();
+}
+
+symbol_t interner_t::intern(const char* text, int length) {
+
+    auto it = symbols.find(std::string_view(text, length));
+    if (it != symbols.end()) return it->second;
+
+    // Store a copy of the text and key the map on a view of the copy
+    symbol_t symbol = names.size();
+    names.emplace_back(text, length);
+    symbols.insert({ std::string_view(names.back()), symbol });
+
+    return symbol;
+}
+
+symbol_t interner_t::intern(const std::string& text) {
+    return intern(text.data(), text.size());
+}
+
+const std::string& interner_t::get_name(symbol_t symbol) const {
+    return names[symbol];
+}
+
+int interner_t::size() const {
+    return names.size();
+}
+
+interner_t& get_interner() {
+    static interner_t interner;
+    return interner;
+}
+
+const std::string& symbol_name(symbol_t symbol) {
+    return get_interner().get_name(symbol);
+}
@@ -0,0 +1,229 @@
+#include "../include/ir.h"
+#include "../include/instructions.h"
+
+const char* ir_opcode_name(ir_opcode_t op) {
+
+    switch (op) {
+        case IR_ADD:    return ADD_INSTR;
+        case IR_SUB:    return SUB_INSTR;
+        case IR_ADDI:   return ADD_IMM_INSTR;
+        case IR_SUBI:   return SUB_IMM_INSTR;
+        case IR_MUL:    return MULT_INSTR;
+        case IR_AND:    return AND_INSTR;
+        case IR_OR:     return OR_INSTR;
+        case IR_XOR:    return XOR_INSTR;
+        case IR_NOT:    return NOT_INSTR;
+        case IR_NEG:    return NEG_INSTR;
+        case IR_LSL:    return LSL_INSTR;
+        case IR_LSLI:   return LSL_IMM_INSTR;
+        case IR_ASR:    return ASR_INSTR;
+        case IR_ASRI:   return ASR_IMM_INSTR;
+        case IR_CMP:    return CMP_INSTR;
+        case IR_CMPI:   return CMP_IMM_INSTR;
+        case IR_BREQ:   return BREQ_INSTR;
+        case IR_BRNE:   return BRNE_INSTR;
+        case IR_BRLT:   return BRLT_INSTR;
+        case IR_BRGT:   return BRGT_INSTR;
+        case IR_BRLE:   return BRLE_INSTR;
+        case IR_BRGE:   return BRGE_INSTR;
+        case IR_JMP:    return JMP_INSTR;
+        case IR_MOVLO:  return MOVLO_INSTR;
+        case IR_MOVHI:  return MOVHI_INSTR;
+        case IR_MOVE:   return MOVE_INSTR;
+        case IR_LOAD:   return LOAD_INSTR;
+        case IR_STORE:  return STORE_INSTR;
+        case IR_CALL:   return CALL_INSTR;
+        case IR_RET:    return RETURN_INSTR;
+        case IR_PUSH:   return PUSH_INSTR;
+        case IR_POP:    return POP_INSTR;
+        case IR_ASM:    return "";
+    }
+    return "";
+}
+
+vreg_t ir_instr_t::get_def() const {
+
+    switch (op) {
+        case IR_CMP:
+        case IR_CMPI:
+        case IR_STORE:
+        case IR_PUSH:
+        case IR_CALL:
+        case IR_RET:
+        case IR_ASM:
+            return NO_REGISTER;
+        default:
+            return (is_branch()) ? NO_REGISTER : rd;
+    }
+}
+
+std::vector<vreg_t> ir_instr_t::get_uses() const {
+
+    std::vector<vreg_t> uses;
+
+    switch (op) {
+        case IR_MOVLO:
+        case IR_MOVHI:
+            uses.push_back(rd);
+            break;
+        case IR_POP:
+        case IR_CALL:
+        case IR_RET:
+        case IR_ASM:
+            break;
+        default:
+            if (ra != NO_REGISTER) uses.push_back(ra);
+            if (rb != NO_REGISTER) uses.push_back(rb);
+            break;
+    }
+    return uses;
+}
+
+void ir_function_t::emit(const ir_instr_t& instr) {
+
+    // A branch or return ends the block, the next instruction starts an unlabeled one
+    bool ended = blocks.empty() || (!blocks.back().instrs.empty() && blocks.back().instrs.back().ends_block());
+
+    if (ended) blocks.emplace_back();
+    blocks.back().instrs.push_back(instr);
+}
+
+void ir_function_t::label(const std::string& name) {
+    blocks.emplace_back();
+    blocks.back().label = name;
+}
+
+void ir_function_t::clear() {
+    blocks.clear();
+}
+
+int ir_function_t::size() const {
+
+    int result = 0;
+    for (const ir_block_t& block : blocks) result += block.instrs.size();
+    return result;
+}
+
+static void print_register(std::ostream& out, vreg_t reg, const std::unordered_map<int, std::string>& names) {
+
+    auto it = names.find(reg);
+    if (it != names.end()) out << it->second;
+    else out << "r" << reg;
+}
+
+static void print_immediate(std::ostream& out, const ir_instr_t& instr) {
+    if (instr.symbol.empty()) out << instr.imm;
+    else out << instr.symbol;
+}
+
+void ir_print_instr(std::ostream& out, const ir_instr_t& instr, const std::unordered_map<int, std::string>& names) {
+
+    out << "\t";
+
+    if (instr.op == IR_ASM) {
+        out << instr.symbol << "\n";
+        return;
+    }
+
+    out << ir_opcode_name(instr.op);
+
+    switch (instr.op) {
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_AND:
+        case IR_OR:
+        case IR_XOR:
+        case IR_LSL:
+        case IR_ASR:
+            out << " ";
+            print_register(out, instr.rd, names);
+            out << ", ";
+            print_register(out, instr.ra, names);
+            out << ", ";
+            print_register(out, instr.rb, names);
+            break;
+        case IR_ADDI:
+        case IR_SUBI:
+        case IR_LSLI:
+        case IR_ASRI:
+            out << " ";
+            print_register(out, instr.rd, names);
+            out << ", ";
+            print_register(out, instr.ra, names);
+            out << ", ";
+            print_immediate(out, instr);
+            break;
+        case IR_NOT:
+        case IR_NEG:
+        case IR_MOVE:
+            out << " ";
+            print_register(out, instr.rd, names);
+            out << ", ";
+            print_register(out, instr.ra, names);
+            break;
+        case IR_CMP:
+            out << " ";
+            print_register(out, instr.ra, names);
+            out << ", ";
+            print_register(out, instr.rb, names);
+            break;
+        case IR_CMPI:
+            out << " ";
+            print_register(out, instr.ra, names);
+            out << ", ";
+            print_immediate(out, instr);
+            break;
+        case IR_MOVLO:
+        case IR_MOVHI:
+            out << " ";
+            print_register(out, instr.rd, names);
+            out << ", ";
+            print_register(out, instr.rd, names);
+            out << ", ";
+            print_immediate(out, instr);
+            break;
+        case IR_LOAD:
+            out << "[" << instr.size << "] ";
+            print_register(out, instr.rd, names);
+            out << ", ";
+            print_register(out, instr.ra, names);
+            out << ", ";
+            print_immediate(out, instr);
+            break;
+        case IR_STORE:
+            out << "[" << instr.size << "] ";
+            print_register(out, instr.ra, names);
+            out << ", ";
+            print_register(out, instr.rb, names);
+            out << ", ";
+            print_immediate(out, instr);
+            break;
+        case IR_PUSH:
+            out << "[" << instr.size << "] ";
+            print_register(out, instr.ra, names);
+            break;
+        case IR_POP:
+            out << "[" << instr.size << "] ";
+            print_register(out, instr.rd, names);
+            break;
+        case IR_RET:
+            break;
+        default:
+            // Branches and calls
+            out << " " << instr.symbol;
+            break;
+    }
+
+    out << "\n";
+}
+
+void ir_function_t::print(std::ostream& out, const std::unordered_map<int, std::string>& names) const {
+
+    for (const ir_block_t& block : blocks) {
+
+        if (!block.label.empty()) out << block.label << ":\n";
+
+        for (const ir_instr_t& instr : block.instrs) ir_print_instr(out, instr, names);
+    }
+}
@@ -1,4 +1,3 @@
-
 #include "../include/lexer.h"
 #include "../include/helper_functions.h"
 
@@ -9,486 +8,481 @@
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+
+#ifndef WINDOWS
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#define READ_SIZE 65536
 
 using namespace lex;
 
-lexer::lexer(std::string filename) {
+// Character classes used as columns of the transition table
+enum char_class_t : unsigned char {
+    C_OTHER,
+    C_END,
+    C_SPACE,
+    C_NEWLINE,
+    C_LETTER,
+    C_HEX_LETTER,
+    C_X,
+    C_ZERO,
+    C_DIGIT,
+    C_SINGLE_QUOTE,
+    C_DOUBLE_QUOTE,
+    C_BACKSLASH,
+    C_SLASH,
+    C_STAR,
+    C_EQUALS,
+    C_RELATIONAL,
+    C_LESS,
+    C_GREATER,
+    C_SINGLE,
+    C_AMPERSAND,
+    C_BAR,
+    CLASS_COUNT
+};
+
+struct char_class_table_t {
+    char_class_t classes[256];
+};
+
+struct transition_table_t {
+    dfa_state_t next[STATE_COUNT][CLASS_COUNT];
+    bool accepting[STATE_COUNT];
+};
+
+static constexpr char_class_table_t make_char_class_table() {
+
+    char_class_table_t table {};
+
+    for (int c = 'a'; c <= 'z'; c++) table.classes[c] = C_LETTER;
+    for (int c = 'A'; c <= 'Z'; c++) table.classes[c] = C_LETTER;
+    for (int c = 'a'; c <= 'f'; c++) table.classes[c] = C_HEX_LETTER;
+    for (int c = 'A'; c <= 'F'; c++) table.classes[c] = C_HEX_LETTER;
+    for (int c = '1'; c <= '9'; c++) table.classes[c] = C_DIGIT;
+    table.classes['_'] = C_LETTER;
+    table.classes['x'] = C_X;
+    table.classes['0'] = C_ZERO;
+
+    table.classes['\0'] = C_END;
+    table.classes[' '] = C_SPACE;
+    table.classes['\t'] = C_SPACE;
+    table.classes['\n'] = C_NEWLINE;
+
+    table.classes['\''] = C_SINGLE_QUOTE;
+    table.classes['"'] = C_DOUBLE_QUOTE;
+    table.classes['\\'] = C_BACKSLASH;
+    table.classes['/'] = C_SLASH;
+    table.classes['*'] = C_STAR;
+    table.classes['='] = C_EQUALS;
+    table.classes['!'] = C_RELATIONAL;
+    table.classes['<'] = C_LESS;
+    table.classes['>'] = C_GREATER;
+
+    table.classes['&'] = C_AMPERSAND;
+    table.classes['|'] = C_BAR;
+
+    for (char c : { ';', '(', ')', '[', ']', '{', '}', '+', '-' }) table.classes[(unsigned char) c] = C_SINGLE;
+
+    return table;
+}
 
-    reserved_words = std::unordered_map<std::string, tag_t>();
-    line = 1;
-    column = 0;
+static constexpr transition_table_t make_transition_table() {
+
+    transition_table_t t {};
+
+    // Start of a lexeme, decides which kind of token is being read
+    t.next[S_START][C_SPACE]        = S_WHITESPACE;
+    t.next[S_START][C_NEWLINE]      = S_WHITESPACE;
+    t.next[S_START][C_LETTER]       = S_ID;
+    t.next[S_START][C_HEX_LETTER]   = S_ID;
+    t.next[S_START][C_X]            = S_ID;
+    t.next[S_START][C_ZERO]         = S_ZERO;
+    t.next[S_START][C_DIGIT]        = S_INT;
+    t.next[S_START][C_SINGLE_QUOTE] = S_CHAR_OPEN;
+    t.next[S_START][C_DOUBLE_QUOTE] = S_STR_BODY;
+    t.next[S_START][C_SLASH]        = S_SLASH;
+    t.next[S_START][C_STAR]         = S_SINGLE;
+    t.next[S_START][C_SINGLE]       = S_SINGLE;
+    t.next[S_START][C_EQUALS]       = S_RELATIONAL;
+    t.next[S_START][C_RELATIONAL]   = S_RELATIONAL;
+    t.next[S_START][C_LESS]         = S_LESS;
+    t.next[S_START][C_GREATER]      = S_GREATER;
+    t.next[S_START][C_AMPERSAND]    = S_AMPERSAND;
+    t.next[S_START][C_BAR]          = S_BAR;
+
+    // Whitespace
+    t.next[S_WHITESPACE][C_SPACE]   = S_WHITESPACE;
+    t.next[S_WHITESPACE][C_NEWLINE] = S_WHITESPACE;
+
+    // Identifiers and keywords
+    for (char_class_t c : { C_LETTER, C_HEX_LETTER, C_X, C_ZERO, C_DIGIT }) t.next[S_ID][c] = S_ID;
+
+    // Integer literals, a leading zero is either the literal 0 or the start of a hexadecimal literal
+    t.next[S_ZERO][C_X] = S_HEX_PREFIX;
+    t.next[S_INT][C_ZERO]  = S_INT;
+    t.next[S_INT][C_DIGIT] = S_INT;
+    for (char_class_t c : { C_ZERO, C_DIGIT, C_HEX_LETTER }) {
+        t.next[S_HEX_PREFIX][c] = S_HEX;
+        t.next[S_HEX][c] = S_HEX;
+    }
 
-    identifier_regex        = std::regex("([A-Z]|[a-z]|_)(([A-Z]|[a-z]|_)|[0-9])*");
-    int_literal_regex       = std::regex("([1-9][0-9]*)|0");
-    str_literal_regex       = std::regex("\"([^\"]*)\"");
-    whitespace_regex        = std::regex("[\t\n\ ]+");
-    half_str_literal_regex  = std::regex("\"([^\"]*)");
+    // Character literals, string literals and comments accept anything but a few characters
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        t.next[S_CHAR_OPEN][c]              = S_CHAR_BODY;
+        t.next[S_CHAR_ESCAPE][c]            = S_CHAR_BODY;
+        t.next[S_STR_BODY][c]               = S_STR_BODY;
+        t.next[S_LINE_COMMENT][c]           = S_LINE_COMMENT;
+        t.next[S_BLOCK_COMMENT][c]          = S_BLOCK_COMMENT;
+        t.next[S_BLOCK_COMMENT_STAR][c]     = S_BLOCK_COMMENT;
+    }
 
-    char_literal_regex      = std::regex("\'([^\'\\\\]|\\\\.)\'");
-    hex_literal_regex       = std::regex("0x[0-9a-fA-F]+");
+    t.next[S_CHAR_OPEN][C_END]              = S_ERROR;
+    t.next[S_CHAR_OPEN][C_SINGLE_QUOTE]     = S_ERROR;
+    t.next[S_CHAR_OPEN][C_BACKSLASH]        = S_CHAR_ESCAPE;
+    t.next[S_CHAR_ESCAPE][C_END]            = S_ERROR;
+    t.next[S_CHAR_ESCAPE][C_NEWLINE]        = S_ERROR;
+    t.next[S_CHAR_BODY][C_SINGLE_QUOTE]     = S_CHAR;
+
+    t.next[S_STR_BODY][C_END]               = S_ERROR;
+    t.next[S_STR_BODY][C_DOUBLE_QUOTE]      = S_STR;
+
+    t.next[S_SLASH][C_SLASH]                = S_LINE_COMMENT;
+    t.next[S_SLASH][C_STAR]                 = S_BLOCK_COMMENT;
+    t.next[S_LINE_COMMENT][C_END]           = S_ERROR;
+    t.next[S_LINE_COMMENT][C_NEWLINE]       = S_LINE_COMMENT_END;
+    t.next[S_BLOCK_COMMENT][C_END]          = S_ERROR;
+    t.next[S_BLOCK_COMMENT][C_STAR]         = S_BLOCK_COMMENT_STAR;
+    t.next[S_BLOCK_COMMENT_STAR][C_END]     = S_ERROR;
+    t.next[S_BLOCK_COMMENT_STAR][C_STAR]    = S_BLOCK_COMMENT_STAR;
+    t.next[S_BLOCK_COMMENT_STAR][C_SLASH]   = S_BLOCK_COMMENT_END;
+
+    // Operators that may be followed by =
+    t.next[S_RELATIONAL][C_EQUALS] = S_RELATIONAL_EQ;
+    t.next[S_LESS][C_EQUALS]       = S_RELATIONAL_EQ;
+    t.next[S_GREATER][C_EQUALS]    = S_RELATIONAL_EQ;
+
+    // < and > doubled are the shift operators
+    t.next[S_LESS][C_LESS]         = S_SHIFT;
+    t.next[S_GREATER][C_GREATER]   = S_SHIFT;
+
+    // & and | doubled are the short-circuit operators
+    t.next[S_AMPERSAND][C_AMPERSAND] = S_LOGICAL;
+    t.next[S_BAR][C_BAR]             = S_LOGICAL;
+
+    for (dfa_state_t s : { S_ID, S_ZERO, S_INT, S_HEX, S_CHAR, S_STR, S_WHITESPACE, S_LINE_COMMENT, S_LINE_COMMENT_END,
+                           S_BLOCK_COMMENT_END, S_SINGLE, S_AMPERSAND, S_BAR, S_LOGICAL, S_RELATIONAL, S_LESS, S_GREATER,
+                           S_SHIFT, S_RELATIONAL_EQ }) {
+        t.accepting[s] = true;
+    }
 
-    // Open file, allocate buffer memory and read BUFFER_SIZE characters
-    file = std::ifstream(filename);
-    buffer_1 = (char*) calloc(BUFFER_SIZE, sizeof(char));
-    buffer_1_end = buffer_1 + BUFFER_SIZE - 1;
+    return t;
+}
 
-    buffer_2 = (char*) calloc(BUFFER_SIZE, sizeof(char));
-    buffer_2_end = buffer_2 + BUFFER_SIZE - 1;
+static constexpr char_class_table_t char_classes = make_char_class_table();
+static constexpr transition_table_t transitions = make_transition_table();
+
+// Reserved words. To add a keyword, add its tag to tag_t and a row here, the static_assert
+// below fails if the new word collides with another one and the hash has to be adjusted
+struct keyword_t {
+    const char* text;
+    tag_t tag;
+};
+
+static constexpr keyword_t keywords[] = {
+    { "if",         tag_t::IF       },
+    { "return",     tag_t::RETURN   },
+    { "while",      tag_t::WHILE    },
+    { "else",       tag_t::ELSE     },
+    { "asm",        tag_t::ASM      },
+    { "continue",   tag_t::CONTINUE },
+    { "break",      tag_t::BREAK    },
+    { "inline",     tag_t::INLINE   },
+    { "unroll",     tag_t::UNROLL   }
+};
+
+#define KEYWORD_COUNT (sizeof(keywords) / sizeof(keyword_t))
+#define KEYWORD_TABLE_SIZE 64
+
+// Hashes a word on its first and last characters and its length
+static constexpr unsigned int keyword_hash(const char* text, int length) {
+    return ((unsigned char) text[0] + 14 * (unsigned char) text[length - 1] + length) & (KEYWORD_TABLE_SIZE - 1);
+}
 
-    //buffer_1[READ_SIZE] = '\0';
-    //buffer_2[READ_SIZE] = '\0';
+// Maps hashes to an index in keywords, or -1 for slots without a keyword
+struct keyword_table_t {
+    int slots[KEYWORD_TABLE_SIZE];
+    int lengths[KEYWORD_COUNT];
+    bool perfect;
+};
 
-    // Read to buffer_1 and set bufferswitch
-    file.read(buffer_1, READ_SIZE);
-    buffer_switch = true;
+static constexpr keyword_table_t make_keyword_table() {
 
-    // Set pointers
-    lexeme_start = buffer_1;
-
-    // Reserve keywords
-    reserved_words.insert({"if", tag_t::IF});
-    reserved_words.insert({"return", tag_t::RETURN});
-    reserved_words.insert({"while", tag_t::WHILE});
-    reserved_words.insert({"else", tag_t::ELSE});
-    reserved_words.insert({"asm", tag_t::ASM});
-    reserved_words.insert({"continue", tag_t::CONTINUE});
-    reserved_words.insert({"break", tag_t::BREAK});
-}
+    keyword_table_t table {};
+    table.perfect = true;
 
-lexer::~lexer() {
-    free(buffer_1);
-    free(buffer_2);
-}
+    for (int i = 0; i < KEYWORD_TABLE_SIZE; i++) table.slots[i] = -1;
 
-int lexer::char_to_digit(char c) {
-    return c - '0';
-}
+    for (int i = 0; i < (int) KEYWORD_COUNT; i++) {
 
-int lexer::get_trailing_whitespace_count(const std::string& str) {
+        int length = 0;
+        while (keywords[i].text[length] != '\0') length++;
+        table.lengths[i] = length;
 
-    int count = 0;
-    for (char c : str) {
-        if (c == '\n') {
-            count = 0;
-            continue;
-        } else if (c == '\t') {
-            count += 4;
-        } else count++;
+        unsigned int hash = keyword_hash(keywords[i].text, length);
+        if (table.slots[hash] != -1) table.perfect = false;
+        table.slots[hash] = i;
     }
-    return count;
-}
 
-char* lexer::get_current_buffer() {
-    return (buffer_switch) ? buffer_1 : buffer_2;
+    return table;
 }
 
-const char* lexer::get_current_buffer_end() {
-    return (buffer_switch) ? buffer_1_end : buffer_2_end;
+static constexpr keyword_table_t keyword_table = make_keyword_table();
+static_assert(keyword_table.perfect, "Keyword hash collision, adjust keyword_hash");
+
+// Returns the keyword tag of the word, or ID if the word is not reserved
+static inline tag_t lookup_keyword(const char* text, int length) {
+
+    int index = keyword_table.slots[keyword_hash(text, length)];
+    if (index == -1) return tag_t::ID;
+
+    if (keyword_table.lengths[index] != length || std::memcmp(keywords[index].text, text, length) != 0) return tag_t::ID;
+
+    return keywords[index].tag;
 }
 
-char* lexer::switch_buffer() {
-    // Overwrite the non-current buffer and switch to it
-    char* current_buffer = (buffer_switch) ? buffer_1 : buffer_2;
+lexer::lexer(std::string filename) {
 
-    std::cout << "Reached buffer end at \"" << std::string(lexeme_start-10) << "\"" << std::endl;
+    line = 1;
+    column = 0;
 
-    char* other_buffer = (buffer_switch) ? buffer_2 : buffer_1;
-    file.read(other_buffer, READ_SIZE);
-    buffer_switch = !buffer_switch;
+    // Make the whole file available in memory
+    read_source(filename);
 
     // Set pointers
-    lexeme_start = other_buffer;
-    return other_buffer;
+    lexeme_start = source;
 }
 
-void lexer::handle_split(std::regex r, std::string& result, unsigned int size) {
-    // Allocate a local buffer that will be returned
-    char *local_buffer = (char*) calloc(MAX_TOKEN_SIZE, sizeof(char));
-
-    // Copy the beginning of the lexeme from the old buffer into the local one
-    std::strcpy(local_buffer, lexeme_start);
-
-    // Read from file, switch buffer and read the beginning of the new buffer into the local one
-    char *new_buffer = switch_buffer();
-    std::memcpy(local_buffer+size, new_buffer, MAX_TOKEN_SIZE - size - 1);
-    
-    // Find the complete token
-    std::cmatch cm;
-    std::regex_search(local_buffer, cm, r);
-
-    // Move the lexeme pointer to the appropriate index
-    lexeme_start += cm[0].length() - size;
-    
-    // Update the result and free the buffer
-    result = cm[0].str();
-    free(local_buffer);
+lexer::~lexer() {
+    #ifndef WINDOWS
+        if (mapped_size) munmap((void*) source, mapped_size);
+    #endif
 }
 
-token* lexer::get_next_token() {
+void lexer::read_source(const std::string& filename) {
 
-    while (true) {
-        // If eof return eof token
-        if (*lexeme_start == '\0' && file.eof() || *lexeme_start == EOF) {
-            return new token(tag_t::eof);
-        // If lexeme_start reached end of buffer, switch buffer
-        } else if (*lexeme_start == '\0') {
-            // Time to switch buffer
-            switch_buffer();
-        }
+    mapped_size = 0;
 
-        std::cmatch cm;
-        // Look for whitespace
-        if(std::regex_search(lexeme_start, cm, whitespace_regex) && cm.prefix().length() == 0) {
-            lexeme_start += cm[0].length();
-            std::string spaces = cm[0].str();
-            
-            column += spaces.length();
-            
-            int tab_count = std::count(spaces.begin(), spaces.end(), '\t');
-            int newline_count = std::count(spaces.begin(), spaces.end(), '\n');
+    #ifndef WINDOWS
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            struct stat info;
+            long page_size = sysconf(_SC_PAGESIZE);
 
-            if (newline_count) {
-                column = 0;
-                line += newline_count;
-            }
-            column += get_trailing_whitespace_count(spaces);
-
-            continue; // Try again in case of buffer switch
-        }
-        
-        // Check for comments
-        if (lexeme_start[0] == '/' && lexeme_start[1] == '/') {
-            do {
-                if (lexeme_start == get_current_buffer_end()) {
-                    switch_buffer();
-                    continue;
-                }
-            } while (*lexeme_start++ != '\n');
-            line++;
+            // The zero filled remainder of the last page terminates the mapped text,
+            // files ending exactly on a page boundary have no such remainder and are read instead
+            if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 && info.st_size % page_size != 0) {
 
-            // Restart token matching loop
-            continue;
-        
-        // Check case where comment signifier // is split between buffers
-        } else if (lexeme_start[0] == '/' && lexeme_start[1] == '*') {
-
-            while (!(lexeme_start[0] == '*' && lexeme_start[1] == '/')) {
-                if (lexeme_start == get_current_buffer_end()) {
-                    switch_buffer();
-                    continue;
+                void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED) {
+                    madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+                    source = (const char*) mapping;
+                    mapped_size = info.st_size;
+                    close(fd);
+                    return;
                 }
+            }
+            close(fd);
+        }
+    #endif
 
-                if (*lexeme_start == '\n') line++;
+    // Fall back to reading the stream in chunks
+    std::ifstream file(filename, std::ios::binary);
+    char chunk[READ_SIZE];
 
-                lexeme_start++;
-            }
-            lexeme_start += 2;
+    while (file.read(chunk, READ_SIZE) || file.gcount()) {
+        buffer.insert(buffer.end(), chunk, chunk + file.gcount());
+    }
+    buffer.push_back('\0');
+    source = buffer.data();
+}
 
-            continue;
+int lexer::char_to_digit(char c) {
+    return c - '0';
+}
 
-        } else if (*lexeme_start == '/' && lexeme_start+1 == get_current_buffer_end()) {
-            switch_buffer();
-            if (*lexeme_start == '/') {
-                do {
-                    if (lexeme_start == get_current_buffer_end()) {
-                        switch_buffer();
-                        continue;
-                    }
-                } while (*lexeme_start++ != '\n');
-            } else {
-                return new token(tag_t::UNKNOWN);
-            }
-        }
+int lexer::get_trailing_whitespace_count(const char* str, int length) {
 
-        // Check for identifiers
-        if (std::regex_search(lexeme_start, cm, identifier_regex) && cm.prefix().length() == 0) {
-
-            std::string word = cm[0].str();
-            // If the token could potentially overflow to the next buffer
-            if (lexeme_start + word.length() == get_current_buffer_end()) {
-                
-                handle_split(identifier_regex, word, word.length());
-                
-            // Otherwise just offset the pointer with the word length
-            } else lexeme_start += word.length();
-                
-            
-
-            // If found word is keyword
-            token* result_token;
-
-            if (reserved_words.count(word)) result_token = new keyword_token(reserved_words[word]);
-            else result_token = new id_token(std::move(word));
-            
-            result_token->line_number = line;
-            result_token->column_number = column;
-
-            column += word.length();
-            // Otherwise create a new identifier token
-            return result_token;
-        }
+    int count = 0;
+    for (int i = 0; i < length; i++) {
+        if (str[i] == '\n') {
+            count = 0;
+            continue;
+        } else if (str[i] == '\t') {
+            count += 4;
+        } else count++;
+    }
+    return count;
+}
 
-        // Check for character literals
-        // TODO: Does not handle splits!
-        if (std::regex_search(lexeme_start, cm, char_literal_regex) && cm.prefix().length() == 0) {
-            
-            std::string literal = cm[0].str();
-            lexeme_start += literal.length();
+const char* lexer::run_dfa(const char* str, dfa_state_t& state, dfa_state_t& accepted, const char*& accept_end) {
 
-            char value = char_literal_to_ascii(literal);
-            token* result_token = new int_literal_token(value);
+    while (true) {
+        dfa_state_t next = transitions.next[state][char_classes.classes[(unsigned char) *str]];
+        if (next == S_ERROR) return str;
 
-            result_token->line_number = line;
-            result_token->column_number = column;
+        state = next;
+        str++;
 
-            column += literal.length();
-            return result_token;
+        if (transitions.accepting[state]) {
+            accepted = state;
+            accept_end = str;
         }
+    }
+}
 
-        // Check for hexadecimal integer literals
-        if (std::regex_search(lexeme_start, cm, hex_literal_regex) && cm.prefix().length() == 0) {
-            
-            std::string literal = cm[0].str();
-            lexeme_start += literal.length();
+token* lexer::make_token(dfa_state_t accepted, const char* text, int length) {
 
-            int value = std::stol(literal, 0, 16);
-            token* result_token = new int_literal_token(value);
+    token* result_token;
 
-            result_token->line_number = line;
-            result_token->column_number = column;
+    switch (accepted) {
+        case S_WHITESPACE: {
+            column += length;
 
-            column += literal.length();
-            return result_token;
+            int newline_count = std::count(text, text + length, '\n');
+            if (newline_count) {
+                column = 0;
+                line += newline_count;
+            }
+            column += get_trailing_whitespace_count(text, length);
+            return nullptr;
         }
-
-        // Check for integer literals
-        if (std::regex_search(lexeme_start, cm, int_literal_regex) && cm.prefix().length() == 0) {
-            std::string literal = cm[0].str();
-
-            // If the token could potentially overflow to the next buffer
-            if (lexeme_start + literal.length() == get_current_buffer_end()) {
-             
-                handle_split(int_literal_regex, literal, literal.length());
-            
-            // Otherwise just offset the pointer with the word length
-            } else lexeme_start += literal.length();
-
-            // Parse integer value and return new integer literal token
-            int value = std::stoi(literal);
-            token* result_token = new int_literal_token(value);
-            
-            result_token->line_number = line;
-            result_token->column_number = column;
-
-            column += literal.length();
-            return result_token;
+        case S_LINE_COMMENT_END:
+            line++;
+            return nullptr;
+        case S_LINE_COMMENT:
+            return nullptr;
+        case S_BLOCK_COMMENT_END:
+            line += std::count(text, text + length, '\n');
+            return nullptr;
+        case S_ID: {
+            tag_t tag = lookup_keyword(text, length);
+            result_token = token_arena.allocate(tag, line, column);
+
+            // Only identifiers are interned, keywords are fully described by their tag
+            if (tag == tag_t::ID) result_token->value = get_interner().intern(text, length);
+            break;
         }
-
-        // Check for string literals
-        if (std::regex_search(lexeme_start, cm, str_literal_regex) && cm.prefix().length() == 0) {
-            std::string literal = cm[0].str();
-            int literal_size = literal.length();
-            lexeme_start += literal_size;
-            
-            token* result_token = new str_literal_token(std::move(literal));
-            result_token->line_number = line;
-            result_token->column_number = column;
-            column += literal_size;
-            return result_token;
-
-        // In case literal is split between buffers, look for half string
-        } else if (std::regex_search(lexeme_start, cm, half_str_literal_regex) && cm.prefix().length() == 0) {
-            
-            std::string literal = cm[0].str();
-            if (lexeme_start + literal.length() == get_current_buffer_end()) {
-                handle_split(str_literal_regex, literal, literal.length());
-            } else return new token(tag_t::UNKNOWN);
-
-            int str_lit_length = literal.size();
-            str_literal_token* result = new str_literal_token(std::move(literal));
-            result->column_number = column;
-            result->line_number = line;
-            column += str_lit_length;
-            return result;
+        case S_ZERO:
+        case S_INT: {
+            unsigned int value = 0;
+            for (int i = 0; i < length; i++) value = value * 10 + char_to_digit(text[i]);
+            result_token = token_arena.allocate(tag_t::INT_LITERAL, line, column);
+            result_token->value = value;
+            break;
         }
-
-        // Check for parenthesis, single character operators and semi-colons
-        token* result_token = nullptr;
-        tag_t tag = tag_t::UNKNOWN;
-        bool found = false;
-
-        switch (*lexeme_start) {
-            case ';':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::SEMI_COLON;
-                break;
-            case '(':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::OPEN_PAREN;
-                break;
-            case '[':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::OPEN_BRACKET;
-                break;
-            case ']':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::CLOSED_BRACKET;
-                break;
-            case ')':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::CLOSED_PAREN;
-                break;
-            case '{':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::OPEN_BRACE;
-                break;
-            case '}':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::CLOSED_BRACE;
-                break;
-            case '+':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::PLUS;
-                break;
-            case '-':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::MINUS;
-                break;
-            case '&':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::AND;
-                break;
-            case '|':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::OR;
-                break;
-            case '*':
-                lexeme_start++;
-                found = true;
-                tag = tag_t::STAR;
-                break;
+        case S_HEX: {
+            unsigned long value = 0;
+            for (int i = 2; i < length; i++) {
+                char c = text[i];
+                int digit = (c <= '9') ? char_to_digit(c) : (std::tolower(c) - 'a' + 10);
+                value = value * 16 + digit;
+            }
+            result_token = token_arena.allocate(tag_t::INT_LITERAL, line, column);
+            result_token->value = value;
+            break;
         }
-
-        if (found) {
-            result_token = new token(tag);
-            result_token->line_number = line;
-            result_token->column_number = column;
-            column++;
-            return result_token;
+        case S_CHAR: {
+            char value = char_literal_to_ascii(std::string(text, length));
+            result_token = token_arena.allocate(tag_t::INT_LITERAL, line, column);
+            result_token->value = value;
+            break;
         }
-
-        // Check for relational operators
-        if (*lexeme_start == '=') {
-            // Handle split
-            if (lexeme_start[1] == '\0') {
-                switch_buffer();
-            } else lexeme_start++;
-
+        case S_STR:
+            result_token = token_arena.allocate(tag_t::STRING_LITERAL, line, column);
+            result_token->lexeme = { (unsigned int) (text - source), (unsigned int) length };
+            break;
+        case S_SINGLE:
+        case S_AMPERSAND:
+        case S_BAR: {
             tag_t tag = tag_t::UNKNOWN;
-            int size = 1;
-            switch(*lexeme_start) {
-                case '=':
-                    lexeme_start++;
-                    size++;
-                    tag = tag_t::EQUALS;
-                    break;
-                default:
-                    tag = tag_t::ASSIGNMENT;
+            switch (text[0]) {
+                case ';': tag = tag_t::SEMI_COLON;      break;
+                case '(': tag = tag_t::OPEN_PAREN;      break;
+                case ')': tag = tag_t::CLOSED_PAREN;    break;
+                case '[': tag = tag_t::OPEN_BRACKET;    break;
+                case ']': tag = tag_t::CLOSED_BRACKET;  break;
+                case '{': tag = tag_t::OPEN_BRACE;      break;
+                case '}': tag = tag_t::CLOSED_BRACE;    break;
+                case '+': tag = tag_t::PLUS;            break;
+                case '-': tag = tag_t::MINUS;           break;
+                case '&': tag = tag_t::AND;             break;
+                case '|': tag = tag_t::OR;              break;
+                case '*': tag = tag_t::STAR;            break;
             }
-
-            token* result_token = new token(tag);
-            result_token->line_number = line;
-            result_token->column_number = column;
-            column += size;
-            return result_token;
+            result_token = token_arena.allocate(tag, line, column);
+            break;
         }
-
-        if (*lexeme_start == '!') {
-            // Handle split
-            if (lexeme_start[1] == '\0') {
-                switch_buffer();
-            } else lexeme_start++;
-            
+        case S_LOGICAL:
+            result_token = token_arena.allocate((text[0] == '&') ? tag_t::LOGICAL_AND : tag_t::LOGICAL_OR, line, column);
+            break;
+        case S_SHIFT:
+            result_token = token_arena.allocate((text[0] == '<') ? tag_t::SHIFT_LEFT : tag_t::SHIFT_RIGHT, line, column);
+            break;
+        case S_RELATIONAL:
+        case S_LESS:
+        case S_GREATER:
+        case S_RELATIONAL_EQ: {
+            bool with_equals = accepted == S_RELATIONAL_EQ;
             tag_t tag = tag_t::UNKNOWN;
-            int size = 1;
-            switch(*lexeme_start) {
-                case '=':
-                    lexeme_start++;
-                    size++;
-                    tag = tag_t::NOT_EQUALS;
-                    break;
-                default:
-                    tag = tag_t::NOT;
+            switch (text[0]) {
+                case '=': tag = with_equals ? tag_t::EQUALS           : tag_t::ASSIGNMENT;  break;
+                case '!': tag = with_equals ? tag_t::NOT_EQUALS       : tag_t::NOT;         break;
+                case '<': tag = with_equals ? tag_t::LESS_OR_EQUAL    : tag_t::LESS;        break;
+                case '>': tag = with_equals ? tag_t::GREATER_OR_EQUAL : tag_t::GREATER;     break;
             }
-
-            token* result_token = new token(tag);
-            result_token->line_number = line;
-            result_token->column_number = column;
-            column += size;
-            return result_token;
+            result_token = token_arena.allocate(tag, line, column);
+            break;
         }
+        default:
+            result_token = token_arena.allocate(tag_t::UNKNOWN, line, column);
+            break;
+    }
 
-        if (*lexeme_start == '<') {
-            // Handle split
-            if (lexeme_start[1] == '\0') {
-                switch_buffer();
-            } else lexeme_start++;
-            
-            tag_t tag = tag_t::UNKNOWN;
-            int size = 1;
-            switch(*lexeme_start) {
-                case '=':
-                    lexeme_start++;
-                    size++;
-                    tag = tag_t::LESS_OR_EQUAL;
-                    break;
-                default:
-                    tag = tag_t::LESS;
-            }
+    column += length;
+    return result_token;
+}
+
+token* lexer::get_next_token() {
 
-            token* result_token = new token(tag);
-            result_token->line_number = line;
-            result_token->column_number = column;
-            column += size;
-            return result_token;
+    while (true) {
+        // If eof return eof token
+        if (*lexeme_start == '\0' || *lexeme_start == EOF) {
+            return token_arena.allocate(tag_t::eof, line, column);
         }
 
-        if (*lexeme_start == '>') {
-            // Handle split
-            if (lexeme_start[1] == '\0') {
-                switch_buffer();
-            } else lexeme_start++;
-            
-            tag_t tag = tag_t::UNKNOWN;
-            int size = 1;
-            switch(*lexeme_start) {
-                case '=':
-                    lexeme_start++;
-                    size++;
-                    tag = tag_t::GREATER_OR_EQUAL;
-                    break;
-                default:
-                    tag = tag_t::GREATER;
-            }
+        // Find the longest lexeme starting at lexeme_start
+        dfa_state_t state = S_START;
+        dfa_state_t accepted = S_ERROR;
+        const char* accept_end = lexeme_start;
+        run_dfa(lexeme_start, state, accepted, accept_end);
 
-            token* result_token = new token(tag);
-            result_token->line_number = line;
-            result_token->column_number = column;
-            column += size;
-            return result_token;
-        }
+        // Skip unknown characters so that the next call makes progress
+        if (accepted == S_ERROR) accept_end = lexeme_start + 1;
+
+        token* result_token = make_token(accepted, lexeme_start, accept_end - lexeme_start);
+        lexeme_start = accept_end;
 
-        return new token(tag_t::UNKNOWN);
+        // Whitespace and comments do not produce tokens
+        if (result_token != nullptr) return result_token;
     }
-}
\ No newline at end of file
+}
+
+std::string lexer::get_lexeme(const token* t) const {
+    return std::string(source + t->lexeme.offset, t->lexeme.length);
+}
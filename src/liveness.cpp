@@ -0,0 +1,286 @@
+#include "../include/liveness.h"
+#include "../include/register_allocation.h"
+
+#include <algorithm>
+
+liveness_t::liveness_t() {
+    position = 0;
+}
+
+void liveness_t::analyze(func_decl_t* func) {
+
+    ranges.clear();
+    scopes.clear();
+    loops.clear();
+    copies.clear();
+    calls.clear();
+    loop_variables.clear();
+    position = 0;
+
+    // Parameters are live from the start of the function
+    scopes.emplace_back();
+    if (func->param_list != nullptr) {
+        for (param_decl_t* param : *func->param_list) {
+            declare(param->id, param);
+
+            int index = ranges.size() - 1;
+            if (index < REGISTER_PARAM_COUNT) ranges[param].arrives_in = index;
+        }
+    }
+
+    if (func->stmt != nullptr) visit_stmt(func->stmt);
+
+    for (auto& kv : ranges) {
+        live_range_t& range = kv.second;
+        for (int call : calls) {
+            if (range.start < call && call < range.end) range.last_call = call;
+        }
+    }
+
+    scopes.clear();
+}
+
+const live_range_t* liveness_t::range_of(const node_t* decl) const {
+    auto it = ranges.find(decl);
+    return (it != ranges.end()) ? &it->second : nullptr;
+}
+
+bool liveness_t::has_addressed_locals() const {
+
+    for (const auto& kv : ranges) {
+
+        node_kind_t kind = kv.first->kind;
+        bool is_array = kind == NODE_SIMPLE_ARRAY_DECL || kind == NODE_INIT_LIST_ARRAY_DECL || kind == NODE_STR_ARRAY_DECL;
+
+        if (is_array || kv.second.address_taken) return true;
+    }
+    return false;
+}
+
+const std::vector<symbol_t>& liveness_t::variables_of(const stmt_t* loop) const {
+
+    static const std::vector<symbol_t> none;
+
+    auto it = loop_variables.find(loop);
+    return (it != loop_variables.end()) ? it->second : none;
+}
+
+void liveness_t::declare(symbol_t name, const node_t* decl) {
+
+    live_range_t& range = ranges[decl];
+    range.start = position;
+    range.end = -1;
+
+    scopes.back()[name] = decl;
+}
+
+const node_t* liveness_t::lookup(symbol_t name) {
+
+    for (int i = scopes.size() - 1; i >= 0; i--) {
+        auto it = scopes[i].find(name);
+        if (it != scopes[i].end()) return it->second;
+    }
+    return nullptr;
+}
+
+void liveness_t::reference(symbol_t name, bool address_taken) {
+
+    // Globals have no range
+    const node_t* decl = lookup(name);
+    if (decl == nullptr) return;
+
+    live_range_t* range = &ranges[decl];
+
+    range->repeated_at_end = range->end == position;
+    range->end = std::max(range->end, position);
+    range->address_taken |= address_taken;
+
+    int weight = 1;
+    for (int i = 0; i < (int) loops.size() && i < 4; i++) weight *= 10;
+    range->weight += weight;
+
+    // Remember the variable in every enclosing loop it was declared outside of
+    for (loop_t& loop : loops) {
+        if (range->start >= loop.start) continue;
+
+        loop.referenced.push_back(range);
+
+        auto use = std::find_if(loop.uses.begin(), loop.uses.end(), [name](const auto& u) { return u.first == name; });
+        if (use == loop.uses.end()) loop.uses.push_back({name, 1});
+        else use->second++;
+    }
+}
+
+void liveness_t::copy(symbol_t dest, expr_t* value) {
+
+    if (value->kind != NODE_ID_TERM || static_cast<id_term_t*>(value)->is_constant) return;
+
+    const node_t* dest_decl = lookup(dest);
+    const node_t* src_decl = lookup(static_cast<id_term_t*>(value)->identifier);
+
+    if (dest_decl == nullptr || src_decl == nullptr || dest_decl == src_decl) return;
+
+    copies.push_back((copy_t){dest_decl, src_decl, position});
+}
+
+void liveness_t::visit_stmt(stmt_t* stmt) {
+
+    stmt->position = ++position;
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+
+            scopes.emplace_back();
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) visit_stmt(s);
+            }
+            scopes.pop_back();
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+
+            visit_expr(if_stmt->cond);
+
+            // A constant condition translates only the branch it takes
+            int value = 0;
+            if (if_stmt->cond->evaluate(&value)) {
+                if (value) visit_stmt(if_stmt->actions);
+                else if (if_stmt->else_actions != nullptr) visit_stmt(if_stmt->else_actions);
+                break;
+            }
+
+            visit_stmt(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) visit_stmt(if_stmt->else_actions);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+
+            // A loop that is never entered is not translated
+            int value = 0;
+            if (while_stmt->cond->evaluate(&value) && !value) break;
+
+            loops.push_back((loop_t){stmt, position, {}, {}});
+            visit_expr(while_stmt->cond);
+            visit_stmt(while_stmt->actions);
+
+            // Variables from outside the loop that are used in it are live across the back edge, which
+            // is after the last statement of the loop
+            loop_t& loop = loops.back();
+            for (live_range_t* range : loop.referenced) {
+                range->end = std::max(range->end, position + 1);
+                range->repeated_at_end = false;
+            }
+
+            std::stable_sort(loop.uses.begin(), loop.uses.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+            std::vector<symbol_t>& variables = loop_variables[stmt];
+            for (auto& use : loop.uses) variables.push_back(use.first);
+
+            loops.pop_back();
+            break;
+        }
+        case NODE_ASM_STMT: {
+            asm_stmt_t* asm_stmt = static_cast<asm_stmt_t*>(stmt);
+
+            for (term_t* param : *asm_stmt->params) visit_expr(param);
+            break;
+        }
+        case NODE_ASSIGNMENT_STMT: {
+            assignment_stmt_t* assignment = static_cast<assignment_stmt_t*>(stmt);
+
+            visit_expr(assignment->rvalue);
+            reference(assignment->identifier);
+            copy(assignment->identifier, assignment->rvalue);
+            break;
+        }
+        case NODE_DEREF_ASSIGNMENT_STMT: {
+            deref_assignment_stmt_t* assignment = static_cast<deref_assignment_stmt_t*>(stmt);
+
+            visit_expr(assignment->rvalue);
+            reference(assignment->identifier);
+            break;
+        }
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+
+            visit_expr(assignment->index);
+            visit_expr(assignment->rvalue);
+            reference(assignment->identifier);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            visit_expr(static_cast<return_stmt_t*>(stmt)->return_value);
+            break;
+        case NODE_EXPR_STMT:
+            visit_expr(static_cast<expr_stmt_t*>(stmt)->e);
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+
+            // The variable is in scope of its own initializer, as when translating
+            declare(decl->id, decl);
+            if (decl->value != nullptr) {
+                visit_expr(decl->value);
+                reference(decl->id);
+                copy(decl->id, decl->value);
+            }
+            break;
+        }
+        case NODE_SIMPLE_ARRAY_DECL:
+        case NODE_INIT_LIST_ARRAY_DECL:
+        case NODE_STR_ARRAY_DECL: {
+            array_decl_t* decl = static_cast<array_decl_t*>(stmt);
+            declare(decl->identifier, decl);
+            break;
+        }
+        default:
+            break;
+    }
+
+    stmt->last_position = position;
+}
+
+void liveness_t::visit_expr(expr_t* e) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        visit_expr(binop->left);
+        visit_expr(binop->right);
+        return;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:     visit_expr(static_cast<neg_expr_t*>(e)->value); break;
+        case NODE_NOT_EXPR:     visit_expr(static_cast<not_expr_t*>(e)->value); break;
+        case NODE_TERM_EXPR:    visit_expr(static_cast<term_expr_t*>(e)->t); break;
+        case NODE_EXPR_TERM:    visit_expr(static_cast<expr_term_t*>(e)->expr); break;
+        case NODE_ID_TERM: {
+            // Identifiers with a known value are translated as constants
+            id_term_t* id = static_cast<id_term_t*>(e);
+            if (!id->is_constant) reference(id->identifier);
+            break;
+        }
+        case NODE_DEREF_TERM:   reference(static_cast<deref_term_t*>(e)->identifier); break;
+        case NODE_ADDR_OF_TERM: reference(static_cast<addr_of_term_t*>(e)->identifier, true); break;
+        case NODE_INDEXED_TERM: {
+            indexed_term_t* indexed = static_cast<indexed_term_t*>(e);
+            reference(indexed->identifier);
+            visit_expr(indexed->index);
+            break;
+        }
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+            if (!loops.empty() && (calls.empty() || calls.back() != position)) calls.push_back(position);
+
+            if (call->params != nullptr) {
+                for (expr_t* param : *call->params) visit_expr(param);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
@@ -0,0 +1,625 @@
+#include "../include/loop_invariant.h"
+#include "../include/helper_functions.h"
+
+// Type of the variables holding hoisted arithmetic, registers are 32 bits wide, see type_table_t
+#define HOISTED_TYPE 2
+
+// Skips the parentheses and term wrappers around an expression
+static expr_t* unwrap(expr_t* e) {
+
+    while (true) {
+        if (e->kind == NODE_TERM_EXPR) e = static_cast<term_expr_t*>(e)->t;
+        else if (e->kind == NODE_EXPR_TERM) e = static_cast<expr_term_t*>(e)->expr;
+        else return e;
+    }
+}
+
+// Number of arithmetic instructions of the expression, comparisons are not counted as they are usually branched on
+static int cost(expr_t* e) {
+
+    e = unwrap(e);
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+
+        bool arithmetic = e->kind >= NODE_ADD_BINOP && e->kind <= NODE_OR_BINOP;
+        return arithmetic + cost(binop->left) + cost(binop->right);
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:         return 1 + cost(static_cast<neg_expr_t*>(e)->value);
+        case NODE_NOT_EXPR:         return cost(static_cast<not_expr_t*>(e)->value);
+        case NODE_ADDR_OF_TERM:     return 1;
+        default:                    return 0;
+    }
+}
+
+// Returns true if both expressions compute the same value, only used on invariant expressions
+static bool same_value(expr_t* a, expr_t* b) {
+
+    a = unwrap(a);
+    b = unwrap(b);
+
+    if (a->kind != b->kind) return false;
+
+    if (a->is_binop()) {
+        binop_expr_t* left = static_cast<binop_expr_t*>(a);
+        binop_expr_t* right = static_cast<binop_expr_t*>(b);
+        return same_value(left->left, right->left) && same_value(left->right, right->right);
+    }
+
+    switch (a->kind) {
+        case NODE_LIT_TERM:
+            return static_cast<lit_term_t*>(a)->literal == static_cast<lit_term_t*>(b)->literal;
+        case NODE_ID_TERM: {
+            id_term_t* left = static_cast<id_term_t*>(a);
+            id_term_t* right = static_cast<id_term_t*>(b);
+            return left->identifier == right->identifier && left->is_constant == right->is_constant && left->constant == right->constant;
+        }
+        case NODE_ADDR_OF_TERM:
+            return static_cast<addr_of_term_t*>(a)->identifier == static_cast<addr_of_term_t*>(b)->identifier;
+        case NODE_NEG_EXPR:
+            return same_value(static_cast<neg_expr_t*>(a)->value, static_cast<neg_expr_t*>(b)->value);
+        case NODE_NOT_EXPR:
+            return same_value(static_cast<not_expr_t*>(a)->value, static_cast<not_expr_t*>(b)->value);
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+T* loop_invariant_motion_t::create(const node_t* origin) {
+
+    T* node = arena.create<T>();
+    node->tokens = origin->tokens;
+    return node;
+}
+
+loop_invariant_motion_t::loop_invariant_motion_t() {
+    symbol_table = nullptr;
+    types = nullptr;
+    next_id = 0;
+    count = 0;
+}
+
+void loop_invariant_motion_t::run(func_decl_t* func, symbol_table_t* symbols, type_table_t* type_table) {
+
+    symbol_table = symbols;
+    types = type_table;
+
+    scopes.clear();
+    address_taken.clear();
+
+    if (func->stmt == nullptr) return;
+
+    find_address_taken(func->stmt);
+
+    scopes.emplace_back();
+    if (func->param_list != nullptr) {
+        for (param_decl_t* param : *func->param_list) {
+            variable_t variable;
+            variable.type = param->type;
+            variable.is_pointer = param->is_pointer;
+            declare(param->id, variable);
+        }
+    }
+
+    rewrite_block(func->stmt);
+
+    scopes.clear();
+}
+
+bool loop_invariant_motion_t::lookup(symbol_t name, variable_t* result) {
+
+    for (int i = scopes.size() - 1; i >= 0; i--) {
+        auto it = scopes[i].find(name);
+        if (it != scopes[i].end()) {
+            *result = it->second;
+            return true;
+        }
+    }
+
+    var_info_t* var = symbol_table->get_var(name);
+    if (var == nullptr) return false;
+
+    result->type = var->type;
+    result->is_pointer = var->is_pointer;
+    result->is_array = var->is_array;
+    result->is_global = true;
+    return true;
+}
+
+void loop_invariant_motion_t::declare(symbol_t name, const variable_t& variable) {
+    scopes.back()[name] = variable;
+}
+
+void loop_invariant_motion_t::find_address_taken(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) find_address_taken(s);
+            }
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            find_address_taken(if_stmt->cond);
+            find_address_taken(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) find_address_taken(if_stmt->else_actions);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+            find_address_taken(while_stmt->cond);
+            find_address_taken(while_stmt->actions);
+            break;
+        }
+        case NODE_ASSIGNMENT_STMT:
+            find_address_taken(static_cast<assignment_stmt_t*>(stmt)->rvalue);
+            break;
+        case NODE_DEREF_ASSIGNMENT_STMT:
+            find_address_taken(static_cast<deref_assignment_stmt_t*>(stmt)->rvalue);
+            break;
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+            find_address_taken(assignment->index);
+            find_address_taken(assignment->rvalue);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            find_address_taken(static_cast<return_stmt_t*>(stmt)->return_value);
+            break;
+        case NODE_EXPR_STMT:
+            find_address_taken(static_cast<expr_stmt_t*>(stmt)->e);
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+            if (decl->value != nullptr) find_address_taken(decl->value);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void loop_invariant_motion_t::find_address_taken(expr_t* e) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        find_address_taken(binop->left);
+        find_address_taken(binop->right);
+        return;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:
+            find_address_taken(static_cast<neg_expr_t*>(e)->value);
+            break;
+        case NODE_NOT_EXPR:
+            find_address_taken(static_cast<not_expr_t*>(e)->value);
+            break;
+        case NODE_TERM_EXPR:
+            find_address_taken(static_cast<term_expr_t*>(e)->t);
+            break;
+        case NODE_EXPR_TERM:
+            find_address_taken(static_cast<expr_term_t*>(e)->expr);
+            break;
+        case NODE_INDEXED_TERM:
+            find_address_taken(static_cast<indexed_term_t*>(e)->index);
+            break;
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+            if (call->params != nullptr) {
+                for (expr_t* param : *call->params) find_address_taken(param);
+            }
+            break;
+        }
+        case NODE_ADDR_OF_TERM:
+            address_taken.insert(static_cast<addr_of_term_t*>(e)->identifier);
+            break;
+        default:
+            break;
+    }
+}
+
+bool loop_invariant_motion_t::collect_assigned(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            bool result = true;
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) result &= collect_assigned(s);
+            }
+            return result;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            bool result = collect_assigned(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) result &= collect_assigned(if_stmt->else_actions);
+            return result;
+        }
+        case NODE_WHILE_STMT:
+            return collect_assigned(static_cast<while_stmt_t*>(stmt)->actions);
+        case NODE_ASSIGNMENT_STMT:
+            assigned.insert(static_cast<assignment_stmt_t*>(stmt)->identifier);
+            return true;
+        case NODE_VAR_DECL:
+            assigned.insert(static_cast<var_decl_t*>(stmt)->id);
+            return true;
+        case NODE_SIMPLE_ARRAY_DECL:
+        case NODE_INIT_LIST_ARRAY_DECL:
+        case NODE_STR_ARRAY_DECL:
+            assigned.insert(static_cast<array_decl_t*>(stmt)->identifier);
+            return true;
+        case NODE_ASM_STMT:
+            return false;
+        default:
+            return true;
+    }
+}
+
+bool loop_invariant_motion_t::is_invariant(expr_t* e) {
+
+    e = unwrap(e);
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        return is_invariant(binop->left) && is_invariant(binop->right);
+    }
+
+    variable_t variable;
+
+    switch (e->kind) {
+        case NODE_LIT_TERM:
+            return true;
+        case NODE_NEG_EXPR:
+            return is_invariant(static_cast<neg_expr_t*>(e)->value);
+        case NODE_NOT_EXPR:
+            return is_invariant(static_cast<not_expr_t*>(e)->value);
+        case NODE_ID_TERM: {
+            id_term_t* id = static_cast<id_term_t*>(e);
+            if (id->is_constant) return true;
+
+            // Globals and variables whose address is taken can change through calls and pointers
+            if (assigned.count(id->identifier) || address_taken.count(id->identifier)) return false;
+            return lookup(id->identifier, &variable) && !variable.is_global && !variable.is_array;
+        }
+        case NODE_ADDR_OF_TERM: {
+            symbol_t name = static_cast<addr_of_term_t*>(e)->identifier;
+            return !assigned.count(name) && lookup(name, &variable);
+        }
+        default:
+            return false;
+    }
+}
+
+bool loop_invariant_motion_t::is_invariant_element(indexed_term_t* element) {
+
+    variable_t variable;
+    if (assigned.count(element->identifier) || !lookup(element->identifier, &variable)) return false;
+
+    // Arrays do not move, a local pointer only changes by assignment
+    bool fixed_base = variable.is_array || (variable.is_pointer && !variable.is_global && !address_taken.count(element->identifier));
+    if (!fixed_base || !is_invariant(element->index)) return false;
+
+    // An element of a pointer at a constant index is loaded with the offset in the instruction
+    int index = 0;
+    return variable.is_array || !element->index->evaluate(&index);
+}
+
+symbol_t loop_invariant_motion_t::hoist(expr_t* value, indexed_term_t* element) {
+
+    for (const hoisted_t& previous : hoisted) {
+
+        bool same = (element != nullptr)
+            ? previous.element != nullptr && previous.element->identifier == element->identifier && same_value(previous.element->index, element->index)
+            : previous.element == nullptr && same_value(previous.value, value);
+
+        if (same) return previous.decl->id;
+    }
+
+    if (hoisted.size() >= LOOP_INVARIANT_MAX) return -1;
+
+    const node_t* origin = (element != nullptr) ? static_cast<node_t*>(element) : static_cast<node_t*>(value);
+
+    var_decl_t* decl = create<var_decl_t>(origin);
+    decl->id = get_interner().intern("__invariant_" + std::to_string(next_id++));
+    decl->type = HOISTED_TYPE;
+    decl->is_pointer = false;
+    decl->value = value;
+
+    if (element != nullptr) {
+
+        variable_t variable;
+        lookup(element->identifier, &variable);
+
+        decl->type = variable.type;
+        decl->is_pointer = true;
+
+        // The address of an array is taken, a pointer is read
+        term_t* base;
+        if (variable.is_array) {
+            addr_of_term_t* address = create<addr_of_term_t>(element);
+            address->identifier = element->identifier;
+            base = address;
+        } else {
+            id_term_t* pointer = create<id_term_t>(element);
+            pointer->identifier = element->identifier;
+            base = pointer;
+        }
+
+        lit_term_t* size = create<lit_term_t>(element);
+        size->literal = types->at(variable.type)->size;
+
+        mult_binop_t* offset = create<mult_binop_t>(element);
+        offset->left = element->index;
+        offset->right = size;
+
+        add_binop_t* address = create<add_binop_t>(element);
+        address->left = base;
+        address->right = offset;
+
+        decl->value = address;
+    }
+
+    hoisted.push_back((hoisted_t){value, element, decl});
+    count++;
+
+    return decl->id;
+}
+
+template <typename T>
+void loop_invariant_motion_t::rewrite_expr(T*& slot, bool whole) {
+
+    expr_t* e = unwrap(slot);
+
+    int constant = 0;
+    int instructions = cost(e);
+
+    if (is_invariant(e) && !e->evaluate(&constant) && (instructions > 1 || (instructions == 1 && !whole))) {
+
+        symbol_t name = hoist(e, nullptr);
+        if (name != -1) {
+            id_term_t* id = create<id_term_t>(e);
+            id->identifier = name;
+            slot = id;
+            return;
+        }
+    }
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        rewrite_expr(binop->left, false);
+        rewrite_expr(binop->right, false);
+        return;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:
+            rewrite_expr(static_cast<neg_expr_t*>(e)->value, false);
+            break;
+        case NODE_NOT_EXPR:
+            rewrite_expr(static_cast<not_expr_t*>(e)->value, false);
+            break;
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+            if (call->params != nullptr) {
+                for (int i = 0; i < call->params->count; i++) rewrite_expr(call->params->items[i], false);
+            }
+            break;
+        }
+        case NODE_INDEXED_TERM: {
+            indexed_term_t* element = static_cast<indexed_term_t*>(e);
+
+            // The element is read through a pointer to it
+            if (is_invariant_element(element)) {
+
+                symbol_t name = hoist(nullptr, element);
+                if (name != -1) {
+                    deref_term_t* deref = create<deref_term_t>(element);
+                    deref->identifier = name;
+                    slot = deref;
+                    return;
+                }
+            }
+
+            rewrite_expr(element->index, false);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+stmt_t* loop_invariant_motion_t::rewrite_loop_stmt(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            if (block->statements != nullptr) {
+                for (int i = 0; i < block->statements->count; i++) {
+                    block->statements->items[i] = rewrite_loop_stmt(block->statements->items[i]);
+                }
+            }
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            rewrite_expr(if_stmt->cond, false);
+            if_stmt->actions = rewrite_loop_stmt(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) if_stmt->else_actions = rewrite_loop_stmt(if_stmt->else_actions);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+            rewrite_expr(while_stmt->cond, false);
+            while_stmt->actions = rewrite_loop_stmt(while_stmt->actions);
+            break;
+        }
+        case NODE_ASSIGNMENT_STMT:
+            rewrite_expr(static_cast<assignment_stmt_t*>(stmt)->rvalue, true);
+            break;
+        case NODE_DEREF_ASSIGNMENT_STMT:
+            rewrite_expr(static_cast<deref_assignment_stmt_t*>(stmt)->rvalue, true);
+            break;
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+            rewrite_expr(assignment->rvalue, true);
+
+            // The element is written through a pointer to it
+            indexed_term_t element;
+            element.tokens = assignment->tokens;
+            element.identifier = assignment->identifier;
+            element.index = assignment->index;
+
+            // A call in the value would have to keep the pointer to the element over it
+            if (!contains_call(assignment->rvalue) && is_invariant_element(&element)) {
+
+                indexed_term_t* copy = create<indexed_term_t>(assignment);
+                *copy = element;
+
+                symbol_t name = hoist(nullptr, copy);
+                if (name != -1) {
+                    deref_assignment_stmt_t* deref = create<deref_assignment_stmt_t>(assignment);
+                    deref->identifier = name;
+                    deref->rvalue = assignment->rvalue;
+                    return deref;
+                }
+            }
+
+            rewrite_expr(assignment->index, false);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            rewrite_expr(static_cast<return_stmt_t*>(stmt)->return_value, true);
+            break;
+        case NODE_EXPR_STMT:
+            rewrite_expr(static_cast<expr_stmt_t*>(stmt)->e, true);
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+            if (decl->value != nullptr) rewrite_expr(decl->value, true);
+            break;
+        }
+        default:
+            break;
+    }
+    return stmt;
+}
+
+void loop_invariant_motion_t::rewrite_loop(while_stmt_t* loop, std::vector<stmt_t*>& out) {
+
+    // A loop that never runs is not translated
+    int constant = 0;
+    if (loop->cond->evaluate(&constant) && !constant) return;
+
+    assigned.clear();
+    hoisted.clear();
+
+    if (!collect_assigned(loop->actions)) return;
+
+    rewrite_expr(loop->cond, false);
+    loop->actions = rewrite_loop_stmt(loop->actions);
+
+    for (const hoisted_t& value : hoisted) {
+
+        variable_t variable;
+        variable.type = value.decl->type;
+        variable.is_pointer = value.decl->is_pointer;
+        declare(value.decl->id, variable);
+
+        out.push_back(value.decl);
+    }
+
+    hoisted.clear();
+}
+
+void loop_invariant_motion_t::rewrite_block(block_stmt_t* block) {
+
+    if (block->statements == nullptr) return;
+
+    stmts_t* statements = block->statements;
+    std::vector<stmt_t*> out;
+
+    scopes.emplace_back();
+    for (stmt_t* stmt : *statements) rewrite_into(stmt, out);
+    scopes.pop_back();
+
+    if ((int) out.size() == statements->count) return;
+
+    stmts_t* list = create<stmts_t>(statements);
+    list->count = out.size();
+    list->items = static_cast<stmt_t**>(arena.allocate(out.size() * sizeof(stmt_t*), alignof(stmt_t*)));
+
+    for (int i = 0; i < list->count; i++) list->items[i] = out[i];
+    block->statements = list;
+}
+
+stmt_t* loop_invariant_motion_t::rewrite_stmt(stmt_t* stmt) {
+
+    std::vector<stmt_t*> out;
+
+    scopes.emplace_back();
+    rewrite_into(stmt, out);
+    scopes.pop_back();
+
+    if (out.size() == 1) return out[0];
+
+    block_stmt_t* block = create<block_stmt_t>(stmt);
+    block->statements = create<stmts_t>(stmt);
+    block->statements->count = out.size();
+    block->statements->items = static_cast<stmt_t**>(arena.allocate(out.size() * sizeof(stmt_t*), alignof(stmt_t*)));
+
+    for (int i = 0; i < (int) out.size(); i++) block->statements->items[i] = out[i];
+    return block;
+}
+
+void loop_invariant_motion_t::rewrite_into(stmt_t* stmt, std::vector<stmt_t*>& out) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT:
+            rewrite_block(static_cast<block_stmt_t*>(stmt));
+            break;
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            if_stmt->actions = rewrite_stmt(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) if_stmt->else_actions = rewrite_stmt(if_stmt->else_actions);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            // Outer loops are hoisted from first, inner loops then hoist what changes only in the outer one
+            while_stmt_t* loop = static_cast<while_stmt_t*>(stmt);
+            rewrite_loop(loop, out);
+            loop->actions = rewrite_stmt(loop->actions);
+            break;
+        }
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+
+            variable_t variable;
+            variable.type = decl->type;
+            variable.is_pointer = decl->is_pointer;
+            declare(decl->id, variable);
+            break;
+        }
+        case NODE_SIMPLE_ARRAY_DECL:
+        case NODE_INIT_LIST_ARRAY_DECL:
+        case NODE_STR_ARRAY_DECL: {
+            array_decl_t* decl = static_cast<array_decl_t*>(stmt);
+
+            variable_t variable;
+            variable.type = decl->type;
+            variable.is_pointer = true;
+            variable.is_array = true;
+            declare(decl->identifier, variable);
+            break;
+        }
+        default:
+            break;
+    }
+
+    out.push_back(stmt);
+}
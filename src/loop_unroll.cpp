@@ -0,0 +1,898 @@
+#include "../include/loop_unroll.h"
+#include "../include/error_handling.h"
+
+// Skips the parentheses and term wrappers around an expression
+static expr_t* unwrap(expr_t* e) {
+
+    while (true) {
+        if (e->kind == NODE_TERM_EXPR) e = static_cast<term_expr_t*>(e)->t;
+        else if (e->kind == NODE_EXPR_TERM) e = static_cast<expr_term_t*>(e)->expr;
+        else return e;
+    }
+}
+
+// Value of a comparison the loop condition is made of
+static bool compare(node_kind_t kind, int left, int right) {
+
+    switch (kind) {
+        case NODE_LESS_BINOP:       return left < right;
+        case NODE_GREATER_BINOP:    return left > right;
+        case NODE_LESS_EQ_BINOP:    return left <= right;
+        case NODE_GREATER_EQ_BINOP: return left >= right;
+        default:                    return left != right;
+    }
+}
+
+static bool is_array_decl(stmt_t* stmt) {
+    return stmt->kind == NODE_SIMPLE_ARRAY_DECL || stmt->kind == NODE_INIT_LIST_ARRAY_DECL || stmt->kind == NODE_STR_ARRAY_DECL;
+}
+
+template <typename T>
+T* loop_unroller_t::copy(const T* node) {
+
+    T* duplicate = arena.create<T>();
+    *duplicate = *node;
+    return duplicate;
+}
+
+template <typename T>
+T* loop_unroller_t::create(const node_t* origin) {
+
+    T* node = arena.create<T>();
+    node->tokens = origin->tokens;
+    return node;
+}
+
+template <typename L, typename E>
+L* loop_unroller_t::create_list(const std::vector<E*>& items, const node_t* origin) {
+
+    // Empty lists are represented by nullptr, like the parser does
+    if (items.empty()) return nullptr;
+
+    L* list = create<L>(origin);
+    list->count = items.size();
+    list->items = static_cast<E**>(arena.allocate(items.size() * sizeof(E*), alignof(E*)));
+
+    for (int i = 0; i < list->count; i++) list->items[i] = items[i];
+    return list;
+}
+
+loop_unroller_t::loop_unroller_t() {
+    types = nullptr;
+    factor = 1;
+    counter = -1;
+    value = 0;
+    unrolled = 0;
+}
+
+void loop_unroller_t::run(func_decl_t* func, type_table_t* type_table, int unroll_factor) {
+
+    types = type_table;
+    factor = unroll_factor;
+
+    scopes.clear();
+    address_taken.clear();
+
+    if (func->stmt == nullptr) return;
+
+    find_address_taken(func->stmt);
+
+    scopes.emplace_back();
+    if (func->param_list != nullptr) {
+        for (param_decl_t* param : *func->param_list) {
+            variable_t variable;
+            variable.type = param->type;
+            variable.is_pointer = param->is_pointer;
+            declare(param->id, variable);
+        }
+    }
+
+    rewrite_block(func->stmt);
+
+    scopes.clear();
+}
+
+bool loop_unroller_t::lookup(symbol_t name, variable_t* result) {
+
+    for (int i = scopes.size() - 1; i >= 0; i--) {
+        auto it = scopes[i].find(name);
+        if (it != scopes[i].end()) {
+            *result = it->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void loop_unroller_t::declare(symbol_t name, const variable_t& variable) {
+    scopes.back()[name] = variable;
+}
+
+void loop_unroller_t::find_address_taken(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) find_address_taken(s);
+            }
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            find_address_taken(if_stmt->cond);
+            find_address_taken(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) find_address_taken(if_stmt->else_actions);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+            find_address_taken(while_stmt->cond);
+            find_address_taken(while_stmt->actions);
+            break;
+        }
+        case NODE_ASSIGNMENT_STMT:
+            find_address_taken(static_cast<assignment_stmt_t*>(stmt)->rvalue);
+            break;
+        case NODE_DEREF_ASSIGNMENT_STMT:
+            find_address_taken(static_cast<deref_assignment_stmt_t*>(stmt)->rvalue);
+            break;
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+            find_address_taken(assignment->index);
+            find_address_taken(assignment->rvalue);
+            break;
+        }
+        case NODE_RETURN_STMT:
+            find_address_taken(static_cast<return_stmt_t*>(stmt)->return_value);
+            break;
+        case NODE_EXPR_STMT:
+            find_address_taken(static_cast<expr_stmt_t*>(stmt)->e);
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+            if (decl->value != nullptr) find_address_taken(decl->value);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void loop_unroller_t::find_address_taken(expr_t* e) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        find_address_taken(binop->left);
+        find_address_taken(binop->right);
+        return;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:
+            find_address_taken(static_cast<neg_expr_t*>(e)->value);
+            break;
+        case NODE_NOT_EXPR:
+            find_address_taken(static_cast<not_expr_t*>(e)->value);
+            break;
+        case NODE_TERM_EXPR:
+            find_address_taken(static_cast<term_expr_t*>(e)->t);
+            break;
+        case NODE_EXPR_TERM:
+            find_address_taken(static_cast<expr_term_t*>(e)->expr);
+            break;
+        case NODE_INDEXED_TERM:
+            find_address_taken(static_cast<indexed_term_t*>(e)->index);
+            break;
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+            if (call->params != nullptr) {
+                for (expr_t* param : *call->params) find_address_taken(param);
+            }
+            break;
+        }
+        case NODE_ADDR_OF_TERM:
+            address_taken.insert(static_cast<addr_of_term_t*>(e)->identifier);
+            break;
+        default:
+            break;
+    }
+}
+
+bool loop_unroller_t::can_copy(stmt_t* stmt, symbol_t name, int loops) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) {
+                    if (!can_copy(s, name, loops)) return false;
+                }
+            }
+            return true;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            if (!can_copy(if_stmt->actions, name, loops)) return false;
+            return if_stmt->else_actions == nullptr || can_copy(if_stmt->else_actions, name, loops);
+        }
+        case NODE_WHILE_STMT:
+            return can_copy(static_cast<while_stmt_t*>(stmt)->actions, name, loops + 1);
+        case NODE_BREAK_STMT:
+            return static_cast<break_stmt_t*>(stmt)->loop_id < loops;
+        case NODE_CONTINUE_STMT:
+            return static_cast<continue_stmt_t*>(stmt)->loop_id < loops;
+        case NODE_ASSIGNMENT_STMT:
+            return static_cast<assignment_stmt_t*>(stmt)->identifier != name;
+        case NODE_VAR_DECL:
+            return static_cast<var_decl_t*>(stmt)->id != name;
+        case NODE_SIMPLE_ARRAY_DECL:
+        case NODE_INIT_LIST_ARRAY_DECL:
+        case NODE_STR_ARRAY_DECL:
+            return static_cast<array_decl_t*>(stmt)->identifier != name;
+        case NODE_ASM_STMT:
+            return false;
+        default:
+            return true;
+    }
+}
+
+bool loop_unroller_t::refers_to(stmt_t* stmt, symbol_t name) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) {
+                    if (refers_to(s, name)) return true;
+                }
+            }
+            return false;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            if (refers_to(if_stmt->cond, name) || refers_to(if_stmt->actions, name)) return true;
+            return if_stmt->else_actions != nullptr && refers_to(if_stmt->else_actions, name);
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+            return refers_to(while_stmt->cond, name) || refers_to(while_stmt->actions, name);
+        }
+        case NODE_ASM_STMT: {
+            asm_stmt_t* asm_stmt = static_cast<asm_stmt_t*>(stmt);
+            for (term_t* param : *asm_stmt->params) {
+                if (refers_to(param, name)) return true;
+            }
+            return false;
+        }
+        case NODE_ASSIGNMENT_STMT: {
+            assignment_stmt_t* assignment = static_cast<assignment_stmt_t*>(stmt);
+            return assignment->identifier == name || refers_to(assignment->rvalue, name);
+        }
+        case NODE_DEREF_ASSIGNMENT_STMT: {
+            deref_assignment_stmt_t* assignment = static_cast<deref_assignment_stmt_t*>(stmt);
+            return assignment->identifier == name || refers_to(assignment->rvalue, name);
+        }
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+            return assignment->identifier == name || refers_to(assignment->index, name) || refers_to(assignment->rvalue, name);
+        }
+        case NODE_RETURN_STMT: {
+            expr_t* value = static_cast<return_stmt_t*>(stmt)->return_value;
+            return value != nullptr && refers_to(value, name);
+        }
+        case NODE_EXPR_STMT:
+            return refers_to(static_cast<expr_stmt_t*>(stmt)->e, name);
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+            return decl->id == name || (decl->value != nullptr && refers_to(decl->value, name));
+        }
+        case NODE_SIMPLE_ARRAY_DECL:
+        case NODE_INIT_LIST_ARRAY_DECL:
+        case NODE_STR_ARRAY_DECL:
+            return static_cast<array_decl_t*>(stmt)->identifier == name;
+        default:
+            return false;
+    }
+}
+
+bool loop_unroller_t::refers_to(expr_t* e, symbol_t name) {
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        return refers_to(binop->left, name) || refers_to(binop->right, name);
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:         return refers_to(static_cast<neg_expr_t*>(e)->value, name);
+        case NODE_NOT_EXPR:         return refers_to(static_cast<not_expr_t*>(e)->value, name);
+        case NODE_TERM_EXPR:        return refers_to(static_cast<term_expr_t*>(e)->t, name);
+        case NODE_EXPR_TERM:        return refers_to(static_cast<expr_term_t*>(e)->expr, name);
+        case NODE_ID_TERM:          return static_cast<id_term_t*>(e)->identifier == name;
+        case NODE_ADDR_OF_TERM:     return static_cast<addr_of_term_t*>(e)->identifier == name;
+        case NODE_DEREF_TERM:       return static_cast<deref_term_t*>(e)->identifier == name;
+        case NODE_INDEXED_TERM: {
+            indexed_term_t* indexed = static_cast<indexed_term_t*>(e);
+            return indexed->identifier == name || refers_to(indexed->index, name);
+        }
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+            if (call->params != nullptr) {
+                for (expr_t* param : *call->params) {
+                    if (refers_to(param, name)) return true;
+                }
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+int loop_unroller_t::size(stmt_t* stmt) {
+
+    int result = 1;
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) result += size(s);
+            }
+            break;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            result += size(if_stmt->cond) + size(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) result += size(if_stmt->else_actions);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = static_cast<while_stmt_t*>(stmt);
+            result += size(while_stmt->cond) + size(while_stmt->actions);
+            break;
+        }
+        case NODE_ASSIGNMENT_STMT:
+            result += size(static_cast<assignment_stmt_t*>(stmt)->rvalue);
+            break;
+        case NODE_DEREF_ASSIGNMENT_STMT:
+            result += size(static_cast<deref_assignment_stmt_t*>(stmt)->rvalue);
+            break;
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = static_cast<indexed_assignment_stmt_t*>(stmt);
+            result += size(assignment->index) + size(assignment->rvalue);
+            break;
+        }
+        case NODE_RETURN_STMT: {
+            expr_t* value = static_cast<return_stmt_t*>(stmt)->return_value;
+            if (value != nullptr) result += size(value);
+            break;
+        }
+        case NODE_EXPR_STMT:
+            result += size(static_cast<expr_stmt_t*>(stmt)->e);
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+            if (decl->value != nullptr) result += size(decl->value);
+            break;
+        }
+        case NODE_INIT_LIST_ARRAY_DECL: {
+            init_list_array_decl_t* decl = static_cast<init_list_array_decl_t*>(stmt);
+            if (decl->init_list != nullptr) result += decl->init_list->count;
+            break;
+        }
+        default:
+            break;
+    }
+    return result;
+}
+
+int loop_unroller_t::size(expr_t* e) {
+
+    e = unwrap(e);
+
+    if (e->is_binop()) {
+        binop_expr_t* binop = static_cast<binop_expr_t*>(e);
+        return 1 + size(binop->left) + size(binop->right);
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR:         return 1 + size(static_cast<neg_expr_t*>(e)->value);
+        case NODE_NOT_EXPR:         return 1 + size(static_cast<not_expr_t*>(e)->value);
+        case NODE_INDEXED_TERM:     return 1 + size(static_cast<indexed_term_t*>(e)->index);
+        case NODE_CALL_TERM: {
+            call_term_t* call = static_cast<call_term_t*>(e);
+            int result = 1;
+            if (call->params != nullptr) {
+                for (expr_t* param : *call->params) result += size(param);
+            }
+            return result;
+        }
+        default:
+            return 1;
+    }
+}
+
+bool loop_unroller_t::find_counter(while_stmt_t* loop, const std::vector<stmt_t*>& out, counter_t* result) {
+
+    // The condition compares the variable to a constant
+    expr_t* cond = unwrap(loop->cond);
+
+    node_kind_t kind = cond->kind;
+    bool comparison = kind == NODE_LESS_BINOP || kind == NODE_GREATER_BINOP || kind == NODE_LESS_EQ_BINOP ||
+        kind == NODE_GREATER_EQ_BINOP || kind == NODE_NEQ_BINOP;
+    if (!comparison) return false;
+
+    binop_expr_t* binop = static_cast<binop_expr_t*>(cond);
+    expr_t* left = unwrap(binop->left);
+    expr_t* right = unwrap(binop->right);
+
+    int bound = 0;
+    id_term_t* id;
+
+    if (left->kind == NODE_ID_TERM && !static_cast<id_term_t*>(left)->is_constant && right->evaluate(&bound)) {
+        id = static_cast<id_term_t*>(left);
+    } else if (right->kind == NODE_ID_TERM && !static_cast<id_term_t*>(right)->is_constant && left->evaluate(&bound)) {
+        id = static_cast<id_term_t*>(right);
+
+        // Compare with the variable on the left
+        if (kind == NODE_LESS_BINOP) kind = NODE_GREATER_BINOP;
+        else if (kind == NODE_GREATER_BINOP) kind = NODE_LESS_BINOP;
+        else if (kind == NODE_LESS_EQ_BINOP) kind = NODE_GREATER_EQ_BINOP;
+        else if (kind == NODE_GREATER_EQ_BINOP) kind = NODE_LESS_EQ_BINOP;
+    } else {
+        return false;
+    }
+
+    // Calls and pointers can not change a local variable whose address is never taken
+    symbol_t name = id->identifier;
+    variable_t variable;
+    if (!lookup(name, &variable) || variable.is_pointer || variable.is_array || address_taken.count(name)) return false;
+
+    // The body ends with the increment, which is the only assignment of the variable in it
+    stmt_t* increment = loop->actions;
+    std::vector<stmt_t*> body;
+
+    if (increment->kind == NODE_BLOCK_STMT) {
+        stmts_t* statements = static_cast<block_stmt_t*>(increment)->statements;
+        if (statements == nullptr) return false;
+
+        for (int i = 0; i < statements->count - 1; i++) body.push_back(statements->items[i]);
+        increment = statements->items[statements->count - 1];
+    }
+
+    if (increment->kind != NODE_ASSIGNMENT_STMT || static_cast<assignment_stmt_t*>(increment)->identifier != name) return false;
+
+    expr_t* step = unwrap(static_cast<assignment_stmt_t*>(increment)->rvalue);
+    if (step->kind != NODE_ADD_BINOP && step->kind != NODE_SUB_BINOP) return false;
+
+    binop_expr_t* update = static_cast<binop_expr_t*>(step);
+    expr_t* update_left = unwrap(update->left);
+    expr_t* update_right = unwrap(update->right);
+
+    auto is_counter = [name](expr_t* e) { return e->kind == NODE_ID_TERM && static_cast<id_term_t*>(e)->identifier == name; };
+
+    int amount = 0;
+    bool counts = is_counter(update_left) && update_right->evaluate(&amount);
+    if (!counts && step->kind == NODE_ADD_BINOP && is_counter(update_right)) counts = update_left->evaluate(&amount);
+
+    if (!counts || amount == 0) return false;
+    if (step->kind == NODE_SUB_BINOP) amount = -amount;
+
+    for (stmt_t* s : body) {
+        if (!can_copy(s, name, 0)) return false;
+    }
+
+    // The closest statement before the loop that sets the variable gives its first value
+    int init = out.size() - 1;
+    int first = 0;
+
+    for (; init >= 0; init--) {
+        stmt_t* s = out[init];
+
+        if (s->kind == NODE_VAR_DECL && static_cast<var_decl_t*>(s)->id == name) {
+            var_decl_t* decl = static_cast<var_decl_t*>(s);
+            if (decl->value == nullptr || !decl->value->evaluate(&first)) return false;
+            break;
+        }
+
+        if (s->kind == NODE_ASSIGNMENT_STMT && static_cast<assignment_stmt_t*>(s)->identifier == name) {
+            if (!static_cast<assignment_stmt_t*>(s)->rvalue->evaluate(&first)) return false;
+            break;
+        }
+
+        if (!can_copy(s, name, 0)) return false;
+    }
+
+    if (init < 0) return false;
+
+    // Integer types are signed, see the README. The loop is left if the variable would overflow
+    long long min = -2147483648LL;
+    long long max = 2147483647LL;
+
+    int type_size = types->at(variable.type)->size;
+    if (type_size < 4) {
+        min = -(1LL << (8 * type_size - 1));
+        max = (1LL << (8 * type_size - 1)) - 1;
+    }
+
+    if (first < min || first > max) return false;
+
+    int current = first;
+    int trips = 0;
+
+    while (compare(kind, current, bound)) {
+
+        long long next = (long long) current + amount;
+        if (trips == UNROLL_MAX_TRIPS || next < min || next > max) return false;
+
+        current = next;
+        trips++;
+    }
+
+    result->name = name;
+    result->first = first;
+    result->step = amount;
+    result->last = current;
+    result->trips = trips;
+    result->init = init;
+    result->body = body;
+    result->increment = increment;
+    return true;
+}
+
+void loop_unroller_t::copy_iteration(const std::vector<stmt_t*>& body, std::vector<stmt_t*>& out, const node_t* origin) {
+
+    bool declares = false;
+    for (stmt_t* s : body) declares |= s->kind == NODE_VAR_DECL || is_array_decl(s);
+
+    if (!declares) {
+        for (stmt_t* s : body) out.push_back(copy_stmt(s));
+        return;
+    }
+
+    // Every iteration declares its own variables
+    std::vector<stmt_t*> statements;
+    for (stmt_t* s : body) statements.push_back(copy_stmt(s));
+
+    block_stmt_t* block = create<block_stmt_t>(origin);
+    block->statements = create_list<stmts_t>(statements, origin);
+    out.push_back(block);
+}
+
+bool loop_unroller_t::unroll(while_stmt_t* loop, std::vector<stmt_t*>& out, stmts_t* statements, int next) {
+
+    counter_t loop_counter;
+
+    if (!find_counter(loop, out, &loop_counter)) {
+        if (loop->is_unroll) output_warning("Loop is not unrolled, its number of iterations is not known", loop);
+        return false;
+    }
+
+    const std::vector<stmt_t*>& body = loop_counter.body;
+
+    int body_size = 0;
+    for (stmt_t* s : body) body_size += size(s);
+
+    int trips = loop_counter.trips;
+
+    bool full = trips * body_size <= UNROLL_MAX_SIZE || (loop->is_unroll && trips <= UNROLL_HINT_MAX_TRIPS);
+    bool partial = !full && factor > 1 && trips >= factor && factor * (body_size + 1) <= UNROLL_MAX_SIZE;
+
+    if (!full && !partial) {
+        if (loop->is_unroll) output_warning("Loop is not unrolled, it runs " + std::to_string(trips) + " iterations", loop);
+        return false;
+    }
+
+    // Iterations copied in front of the loop, all of them if it is unrolled fully
+    int peeled = full ? trips : trips % factor;
+
+    counter = loop_counter.name;
+    for (int i = 0; i < peeled; i++) {
+        value = loop_counter.first + i * loop_counter.step;
+        copy_iteration(body, out, loop);
+    }
+    counter = -1;
+
+    unrolled++;
+
+    if (!full) {
+
+        if (peeled > 0) {
+            lit_term_t* start = create<lit_term_t>(loop_counter.increment);
+            start->literal = loop_counter.first + peeled * loop_counter.step;
+
+            assignment_stmt_t* assignment = create<assignment_stmt_t>(loop_counter.increment);
+            assignment->identifier = loop_counter.name;
+            assignment->rvalue = start;
+            out.push_back(assignment);
+        }
+
+        // The condition holds between the copies, the remaining iterations are a multiple of the factor
+        std::vector<stmt_t*> actions;
+        for (int i = 0; i < factor; i++) {
+            copy_iteration(body, actions, loop);
+            actions.push_back(copy_stmt(loop_counter.increment));
+        }
+
+        block_stmt_t* block = create<block_stmt_t>(loop->actions);
+        block->statements = create_list<stmts_t>(actions, loop->actions);
+        loop->actions = block;
+
+        out.push_back(loop);
+        return true;
+    }
+
+    // The variable keeps the value the loop leaves it with, unless nothing reads it
+    bool used = false;
+    for (int i = loop_counter.init + 1; i < (int) out.size() && !used; i++) used = refers_to(out[i], loop_counter.name);
+    for (int i = next; i < statements->count && !used; i++) used = refers_to(statements->items[i], loop_counter.name);
+
+    if (!used && out[loop_counter.init]->kind == NODE_VAR_DECL) {
+        out.erase(out.begin() + loop_counter.init);
+    } else if (trips > 0) {
+        lit_term_t* last = create<lit_term_t>(loop_counter.increment);
+        last->literal = loop_counter.last;
+
+        assignment_stmt_t* assignment = create<assignment_stmt_t>(loop_counter.increment);
+        assignment->identifier = loop_counter.name;
+        assignment->rvalue = last;
+        out.push_back(assignment);
+    }
+
+    return true;
+}
+
+void loop_unroller_t::rewrite_block(block_stmt_t* block) {
+
+    if (block->statements == nullptr) return;
+
+    stmts_t* statements = block->statements;
+    std::vector<stmt_t*> out;
+    bool changed = false;
+
+    scopes.emplace_back();
+    for (int i = 0; i < statements->count; i++) {
+
+        stmt_t* stmt = statements->items[i];
+        rewrite_stmt(stmt);
+
+        if (stmt->kind == NODE_WHILE_STMT && unroll(static_cast<while_stmt_t*>(stmt), out, statements, i + 1)) {
+            changed = true;
+        } else {
+            out.push_back(stmt);
+        }
+    }
+    scopes.pop_back();
+
+    if (changed) block->statements = create_list<stmts_t>(out, statements);
+}
+
+void loop_unroller_t::rewrite_stmt(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT:
+            rewrite_block(static_cast<block_stmt_t*>(stmt));
+            break;
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+
+            scopes.emplace_back();
+            rewrite_stmt(if_stmt->actions);
+            scopes.pop_back();
+
+            if (if_stmt->else_actions != nullptr) {
+                scopes.emplace_back();
+                rewrite_stmt(if_stmt->else_actions);
+                scopes.pop_back();
+            }
+            break;
+        }
+        case NODE_WHILE_STMT:
+            scopes.emplace_back();
+            rewrite_stmt(static_cast<while_stmt_t*>(stmt)->actions);
+            scopes.pop_back();
+            break;
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = static_cast<var_decl_t*>(stmt);
+
+            variable_t variable;
+            variable.type = decl->type;
+            variable.is_pointer = decl->is_pointer;
+            declare(decl->id, variable);
+            break;
+        }
+        case NODE_SIMPLE_ARRAY_DECL:
+        case NODE_INIT_LIST_ARRAY_DECL:
+        case NODE_STR_ARRAY_DECL: {
+            array_decl_t* decl = static_cast<array_decl_t*>(stmt);
+
+            variable_t variable;
+            variable.type = decl->type;
+            variable.is_array = true;
+            declare(decl->identifier, variable);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+stmt_t* loop_unroller_t::copy_stmt(stmt_t* stmt) {
+
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = copy(static_cast<block_stmt_t*>(stmt));
+
+            std::vector<stmt_t*> statements;
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) statements.push_back(copy_stmt(s));
+            }
+
+            block->statements = create_list<stmts_t>(statements, block);
+            return block;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = copy(static_cast<if_stmt_t*>(stmt));
+
+            if_stmt->cond = copy_expr(if_stmt->cond);
+            if_stmt->actions = copy_stmt(if_stmt->actions);
+            if (if_stmt->else_actions != nullptr) if_stmt->else_actions = copy_stmt(if_stmt->else_actions);
+            return if_stmt;
+        }
+        case NODE_WHILE_STMT: {
+            while_stmt_t* while_stmt = copy(static_cast<while_stmt_t*>(stmt));
+
+            while_stmt->cond = copy_expr(while_stmt->cond);
+            while_stmt->actions = copy_stmt(while_stmt->actions);
+            return while_stmt;
+        }
+        case NODE_BREAK_STMT:
+            return copy(static_cast<break_stmt_t*>(stmt));
+        case NODE_CONTINUE_STMT:
+            return copy(static_cast<continue_stmt_t*>(stmt));
+        case NODE_RETURN_STMT: {
+            return_stmt_t* return_stmt = copy(static_cast<return_stmt_t*>(stmt));
+
+            if (return_stmt->return_value != nullptr) return_stmt->return_value = copy_expr(return_stmt->return_value);
+            return return_stmt;
+        }
+        case NODE_ASSIGNMENT_STMT: {
+            assignment_stmt_t* assignment = copy(static_cast<assignment_stmt_t*>(stmt));
+
+            assignment->rvalue = copy_expr(assignment->rvalue);
+            return assignment;
+        }
+        case NODE_DEREF_ASSIGNMENT_STMT: {
+            deref_assignment_stmt_t* assignment = copy(static_cast<deref_assignment_stmt_t*>(stmt));
+
+            assignment->rvalue = copy_expr(assignment->rvalue);
+            return assignment;
+        }
+        case NODE_INDEXED_ASSIGNMENT_STMT: {
+            indexed_assignment_stmt_t* assignment = copy(static_cast<indexed_assignment_stmt_t*>(stmt));
+
+            assignment->index = copy_expr(assignment->index);
+            assignment->rvalue = copy_expr(assignment->rvalue);
+            return assignment;
+        }
+        case NODE_EXPR_STMT: {
+            expr_stmt_t* expr_stmt = copy(static_cast<expr_stmt_t*>(stmt));
+
+            expr_stmt->e = copy_expr(expr_stmt->e);
+            return expr_stmt;
+        }
+        case NODE_VAR_DECL: {
+            var_decl_t* decl = copy(static_cast<var_decl_t*>(stmt));
+
+            if (decl->value != nullptr) decl->value = copy_expr(decl->value);
+            return decl;
+        }
+        case NODE_SIMPLE_ARRAY_DECL: {
+            simple_array_decl_t* decl = copy(static_cast<simple_array_decl_t*>(stmt));
+
+            decl->size = copy_expr(decl->size);
+            return decl;
+        }
+        case NODE_INIT_LIST_ARRAY_DECL: {
+            init_list_array_decl_t* decl = copy(static_cast<init_list_array_decl_t*>(stmt));
+
+            if (decl->init_list != nullptr) {
+                std::vector<expr_t*> values;
+                for (expr_t* e : *decl->init_list) values.push_back(copy_expr(e));
+                decl->init_list = create_list<init_list_t>(values, decl->init_list);
+            }
+            return decl;
+        }
+        case NODE_STR_ARRAY_DECL:
+            return copy(static_cast<str_array_decl_t*>(stmt));
+        default:
+            // Loops with inline assembly are not unrolled
+            return stmt;
+    }
+}
+
+expr_t* loop_unroller_t::copy_expr(expr_t* e) {
+
+    if (e->is_binop()) {
+
+        binop_expr_t* binop;
+        switch (e->kind) {
+            case NODE_ADD_BINOP:            binop = copy(static_cast<add_binop_t*>(e)); break;
+            case NODE_SUB_BINOP:            binop = copy(static_cast<sub_binop_t*>(e)); break;
+            case NODE_MULT_BINOP:           binop = copy(static_cast<mult_binop_t*>(e)); break;
+            case NODE_SHIFT_LEFT_BINOP:     binop = copy(static_cast<shift_left_binop_t*>(e)); break;
+            case NODE_SHIFT_RIGHT_BINOP:    binop = copy(static_cast<shift_right_binop_t*>(e)); break;
+            case NODE_AND_BINOP:            binop = copy(static_cast<and_binop_t*>(e)); break;
+            case NODE_OR_BINOP:             binop = copy(static_cast<or_binop_t*>(e)); break;
+            case NODE_LOGICAL_AND_BINOP:    binop = copy(static_cast<logical_and_binop_t*>(e)); break;
+            case NODE_LOGICAL_OR_BINOP:     binop = copy(static_cast<logical_or_binop_t*>(e)); break;
+            case NODE_EQ_BINOP:             binop = copy(static_cast<eq_binop_t*>(e)); break;
+            case NODE_NEQ_BINOP:            binop = copy(static_cast<neq_binop_t*>(e)); break;
+            case NODE_LESS_BINOP:           binop = copy(static_cast<less_binop_t*>(e)); break;
+            case NODE_GREATER_BINOP:        binop = copy(static_cast<greater_binop_t*>(e)); break;
+            case NODE_LESS_EQ_BINOP:        binop = copy(static_cast<less_eq_binop_t*>(e)); break;
+            default:                        binop = copy(static_cast<greater_eq_binop_t*>(e)); break;
+        }
+
+        binop->left = copy_expr(binop->left);
+        binop->right = copy_expr(binop->right);
+        return binop;
+    }
+
+    switch (e->kind) {
+        case NODE_NEG_EXPR: {
+            neg_expr_t* neg = copy(static_cast<neg_expr_t*>(e));
+            neg->value = copy_term(neg->value);
+            return neg;
+        }
+        case NODE_NOT_EXPR: {
+            not_expr_t* not_expr = copy(static_cast<not_expr_t*>(e));
+            not_expr->value = copy_term(not_expr->value);
+            return not_expr;
+        }
+        case NODE_TERM_EXPR: {
+            term_expr_t* term_expr = copy(static_cast<term_expr_t*>(e));
+            term_expr->t = copy_term(term_expr->t);
+            return term_expr;
+        }
+        case NODE_EXPR_TERM: {
+            expr_term_t* expr_term = copy(static_cast<expr_term_t*>(e));
+            expr_term->expr = copy_expr(expr_term->expr);
+            return expr_term;
+        }
+        case NODE_ID_TERM: {
+            id_term_t* id = static_cast<id_term_t*>(e);
+
+            // The counter is replaced by its value in the iteration. Other marks of constant propagation hold
+            // in every iteration, so they are kept
+            if (id->identifier == counter) {
+                lit_term_t* literal = create<lit_term_t>(id);
+                literal->literal = value;
+                return literal;
+            }
+            return copy(id);
+        }
+        case NODE_CALL_TERM: {
+            call_term_t* call = copy(static_cast<call_term_t*>(e));
+
+            if (call->params != nullptr) {
+                std::vector<expr_t*> params;
+                for (expr_t* param : *call->params) params.push_back(copy_expr(param));
+                call->params = create_list<params_t>(params, call->params);
+            }
+            return call;
+        }
+        case NODE_ADDR_OF_TERM:
+            return copy(static_cast<addr_of_term_t*>(e));
+        case NODE_DEREF_TERM:
+            return copy(static_cast<deref_term_t*>(e));
+        case NODE_INDEXED_TERM: {
+            indexed_term_t* indexed = copy(static_cast<indexed_term_t*>(e));
+            indexed->index = copy_expr(indexed->index);
+            return indexed;
+        }
+        default:
+            return copy(static_cast<lit_term_t*>(e));
+    }
+}
@@ -36,8 +36,50 @@ int main(int argc, char const *argv[]) {
         string filename = path + "\\" + relative_path;
     #else
         string filename = path + '/' + relative_path;
+
+        // Read the source from a pipe
+        if (relative_path == "-") filename = "/dev/stdin";
     #endif
 
+    // Options following the file
+    translator_options_t options;
+
+    for (int i = 2; i < argc; i++) {
+        string option(argv[i]);
+
+        if (option == "--regalloc=graph") {
+            options.graph_coloring = true;
+        } else if (option == "--regalloc=linear") {
+            options.graph_coloring = false;
+        } else if (option == "--no-peephole") {
+            options.peephole = false;
+        } else if (option == "--no-constant-propagation") {
+            options.constant_propagation = false;
+        } else if (option == "--no-dead-code-elimination") {
+            options.dead_code_elimination = false;
+        } else if (option == "--no-inline") {
+            options.inlining = false;
+        } else if (option == "--no-loop-invariant-motion") {
+            options.loop_invariant_motion = false;
+        } else if (option == "--no-tail-calls") {
+            options.tail_calls = false;
+        } else if (option == "--no-unroll") {
+            options.unrolling = false;
+        } else if (option.rfind("--unroll=", 0) == 0) {
+            string factor = option.substr(9);
+
+            // Larger factors than the size of an unrolled loop would never apply
+            if (factor.empty() || factor.size() > 2 || factor.find_first_not_of("0123456789") != string::npos || stoi(factor) < 1) {
+                cout << "\033[0;31mInvalid unroll factor\033[0m " << factor << endl;
+                return 1;
+            }
+            options.unroll_factor = stoi(factor);
+        } else {
+            cout << "\033[0;31mUnknown option\033[0m " << option << endl;
+            return 1;
+        }
+    }
+
     lex::lexer lex(filename);
 
     parser_t parser(&lex);
@@ -59,7 +101,7 @@ int main(int argc, char const *argv[]) {
 
     cout << endl;
 
-    translator_t translator = translator_t();
+    translator_t translator(options);
 
     try {
         program->translate(&translator);
@@ -73,5 +115,33 @@ int main(int argc, char const *argv[]) {
     ofstream output_file("output.a");
     translator.print_to_file(output_file);
 
+    if (options.inlining) {
+        cout << "Inlining expanded " << translator.inliner.get_expanded() << " call(s)." << endl << endl;
+    }
+
+    if (options.dead_code_elimination) {
+        cout << "Dead code elimination removed " << translator.dead_code.get_removed_functions() << " function(s) and ";
+        cout << translator.dead_code.get_removed_globals() << " global(s)." << endl << endl;
+    }
+
+    if (options.loop_invariant_motion) {
+        cout << "Loop-invariant code motion hoisted " << translator.loop_invariants.get_hoisted() << " value(s)." << endl << endl;
+    }
+
+    if (options.unrolling) {
+        cout << "Loop unrolling unrolled " << translator.unroller.get_unrolled() << " loop(s)." << endl << endl;
+    }
+
+    cout << "Frames left out of " << translator.frame.get_frameless() << " function(s), ";
+    cout << translator.frame.get_saved() << " callee saved register(s) pushed." << endl << endl;
+
+    if (options.tail_calls) {
+        cout << "Tail calls replaced " << translator.frame.get_tail_calls() << " call(s) with jumps." << endl << endl;
+    }
+
+    if (options.peephole) {
+        cout << "Peephole optimizer removed " << translator.peephole.get_removed() << " instruction(s)." << endl << endl;
+    }
+
     return 0;
 }
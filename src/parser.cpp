@@ -4,6 +4,7 @@
 #include "../include/helper_functions.h"
 
 #include <iostream>
+#include <type_traits>
 
 void syntax_error::throw_error(const std::string& message, const lex::token* node) {
     auto line = std::to_string(node->line_number);
@@ -13,70 +14,121 @@ void syntax_error::throw_error(const std::string& message, const lex::token* nod
 
 parser_t::parser_t(lex::lexer *l) : lexical_analyzer(l) {
 
-    type_map = std::unordered_map<std::string, int>();
-    type_map.insert({"int", 0});
-    type_map.insert({"char", 1});
-    type_map.insert({"long", 2});
+    type_map = std::unordered_map<symbol_t, int>();
+    type_map.insert({get_interner().intern("int"), 0});
+    type_map.insert({get_interner().intern("char"), 1});
+    type_map.insert({get_interner().intern("long"), 2});
 
     type_name_map = std::unordered_map<int, std::string>();
     type_name_map.insert({0, "int"});
     type_name_map.insert({1, "char"});
     type_name_map.insert({2, "long"});
 
-    token_queue = std::deque<lex::token*>();
-    current_pos = 0;
+    lookahead_start = 0;
+    lookahead_count = 0;
+
+    construct_start = nullptr;
+    matching_stmt = false;
 }
 
 parser_t::~parser_t() {
-
-    while (!token_queue.empty()) {
-        delete token_queue.back();
-        token_queue.pop_back();
-    }
+    // Tokens are owned by the token arena of the lexer, syntax tree nodes are released with the AST arena
 }
 
 program_t* parser_t::parse_token_stream() {
     return match_program();
 }
 
+void parser_t::store_tokens(node_t* node, std::initializer_list<lex::token*> tokens) {
+
+    // Optional tokens that were not matched are passed as nullptr and left out
+    int count = 0;
+    for (lex::token* token : tokens) if (token) count++;
+
+    node->tokens.items = static_cast<lex::token**>(ast_arena.allocate(count * sizeof(lex::token*), alignof(lex::token*)));
+    node->tokens.count = 0;
+
+    for (lex::token* token : tokens) if (token) node->tokens.items[node->tokens.count++] = token;
+}
+
+template <typename T>
+T* parser_t::store_list(size_t start) {
+
+    // Empty lists are represented by nullptr
+    if (list_scratch.size() == start) return nullptr;
+
+    using element_t = typename std::remove_pointer<decltype(T::items)>::type;
+    using child_t = typename std::remove_pointer<element_t>::type;
+
+    T* result = ast_arena.create<T>();
+    result->count = list_scratch.size() - start;
+    result->items = static_cast<element_t*>(ast_arena.allocate(result->count * sizeof(element_t), alignof(element_t)));
+
+    for (int i = 0; i < result->count; i++) {
+        result->items[i] = static_cast<child_t*>(list_scratch[start + i]);
+    }
+
+    list_scratch.resize(start);
+    return result;
+}
+
 inline lex::token* parser_t::get_token() {
     
-    if (token_queue.size()) {
-        auto result = token_queue.front();
-        token_queue.pop_front();
+    if (lookahead_count) {
+        auto result = lookahead[lookahead_start];
+        lookahead_start = (lookahead_start + 1) % MAX_LOOKAHEAD;
+        lookahead_count--;
         return result;
     } else {
         return lexical_analyzer->get_next_token();
     }
 }
 
-void parser_t::put_back_token(lex::token* t) {
-    token_queue.push_front(t);
+const lex::token* parser_t::peek(int k) {
+    
+    // Read tokens from the lexer until the k:th token ahead is buffered
+    while (lookahead_count <= k) {
+        lookahead[(lookahead_start + lookahead_count) % MAX_LOOKAHEAD] = lexical_analyzer->get_next_token();
+        lookahead_count++;
+    }
+    
+    return lookahead[(lookahead_start + k) % MAX_LOOKAHEAD];
 }
 
-const lex::token* parser_t::peek() {
-    
-    if (!token_queue.size()) {
-        token_queue.push_front(get_token());
+inline lex::token* parser_t::match_token(lex::tag_t tag) {
+
+    if (peek()->tag != tag) {
+        throw_construct_error();
     }
+
+    return get_token();
+}
+
+void parser_t::throw_construct_error() {
     
-    return token_queue.front();
+    // Report the error at the start of the construct, where matching every alternative failed
+    std::string construct = matching_stmt ? "statement" : "declaration";
+    syntax_error::throw_error("Could not match " + construct + ". Unexpected " + lex::token_names[(int) construct_start->tag] + " token ", construct_start);
 }
 
-inline bool parser_t::is_type(const std::string& s) {
+inline bool parser_t::is_type(symbol_t s) {
     return type_map.count(s);
 }
 
 inline bool parser_t::is_type(const lex::token* t) {
-    return t->tag == lex::tag_t::ID && is_type(static_cast<const lex::id_token*>(t)->lexeme);
+    return t->tag == lex::tag_t::ID && is_type(t->value);
 }
 
-inline int parser_t::get_type(const std::string& s) {
+inline int parser_t::get_type(symbol_t s) {
     return type_map[s];
 }
 
-inline int parser_t::get_type(const lex::id_token* t) {
-    return type_map[t->lexeme];
+inline int parser_t::get_type(const lex::token* t) {
+    return type_map[t->value];
+}
+
+inline std::string parser_t::get_lexeme(const lex::token* t) {
+    return lexical_analyzer->get_lexeme(t);
 }
 
 std::string parser_t::get_type_name(int type) {
@@ -84,6 +136,10 @@ std::string parser_t::get_type_name(int type) {
 }
 
 // Construct specific matching functions
+//
+// Every production is chosen by looking at most MAX_LOOKAHEAD tokens ahead, so a function is only
+// called when its production is the only one that can match. Once chosen, a missing token fails the
+// declaration or statement being matched, reported at its first token.
 
 program_t* parser_t::match_program() {
 
@@ -94,101 +150,165 @@ program_t* parser_t::match_program() {
         return nullptr;
     }
     
-    program_t *program = new program_t();
+    program_t *program = ast_arena.create<program_t>();
     program->decls = d;
     return program;
 }
 
+// decls -> decl decls
+//       |  e
 decls_t* parser_t::match_decls() {
 
-    decls_t* ds = nullptr;
-
-    lex::token* test_token = get_token();
-    lex::tag_t tag = test_token->tag;
-    put_back_token(test_token);
-    
-    if (tag == lex::tag_t::eof) return nullptr;
-    
-    // Try matching decl, if it fails, check if next token is EOF, if it is, everything is in order
-    // If it is not rethrow the syntax error
-    try {
-        ds = match_decls_1();
-    } catch (syntax_error e) {
+    size_t start = list_scratch.size();
 
-        if (peek()->tag != lex::tag_t::eof) {
-            std::string id_str = (peek()->tag == lex::tag_t::ID) ? static_cast<const lex::id_token*>(peek())->lexeme : "";
-            throw e;
-        }
+    // Match declarations until the end of the file
+    while (peek()->tag != lex::tag_t::eof) {
+        list_scratch.push_back(match_decl());
     }
 
-    if (ds != nullptr) return ds;
-
-    return match_decls_2();
+    return store_list<decls_t>(start);
 }
 
 decl_t* parser_t::match_decl() {
-    decl_t* d;
 
-    d = match_decl_var();
-    if (d != nullptr) return d;
-    
-    d = match_decl_array();
-    if (d != nullptr) return d;
+    construct_start = peek();
+    matching_stmt = false;
 
-    d = match_decl_func();
-    if (d != nullptr) return d;
+    if (peek()->tag == lex::tag_t::INLINE) return match_decl_func();
 
-    syntax_error::throw_error("Could not match declaration. Unexpected " + lex::token_names[(int) peek()->tag] + " token ", peek());
+    // Every declaration starts with a type
+    if (!is_type(peek())) {
+        throw_construct_error();
+    }
+
+    // Functions and arrays are told apart from variables by the token following the identifier
+    if (peek(1)->tag == lex::tag_t::ID) {
+        
+        switch (peek(2)->tag) {
+            case lex::tag_t::OPEN_PAREN:
+                return match_decl_func();
+            case lex::tag_t::OPEN_BRACKET:
+                return match_decl_array();
+            default:
+                break;
+        }
+    }
+
+    return match_decl_var();
 }
 
-func_decl_t* parser_t::match_decl_func() {
+// var_decl -> type id ;
+//          |  type * id ;
+//          |  type id "=" expr ;
+//          |  type "*" id "=" expr ;
+var_decl_t* parser_t::match_decl_var() {
+    
+    lex::token* type_token = get_token();
+    lex::token* star_token = nullptr;
+    lex::token* equals_token = nullptr;
 
-    func_decl_t* d;
+    if (peek()->tag == lex::tag_t::STAR) {
+        star_token = get_token();
+    }
 
-    d = match_decl_func_1();
-    if (d != nullptr) return d;
+    lex::token* id_token = match_token(lex::tag_t::ID);
+
+    expr_t* value = nullptr;
+
+    // Try to find assignment
+    if (peek()->tag == lex::tag_t::ASSIGNMENT) {
+        
+        equals_token = get_token();
+        value = match_expr();
+    }
+
+    // Acquire semi colon
+    lex::token* semi_colon_token = match_token(lex::tag_t::SEMI_COLON);
+
+    // Build syntax object
+    var_decl_t* d = ast_arena.create<var_decl_t>();
+    
+    d->type = get_type(type_token);
+    d->id = id_token->value;
+    d->is_pointer = (star_token != nullptr);
+    d->value = value;
+
+    store_tokens(d, { type_token, id_token, equals_token, semi_colon_token });
 
-    d = match_decl_func_2();
     return d;
 }
 
-var_decl_t* parser_t::match_decl_var() {
-    
-    // This one is simple, since one of the productions of a variable declaration is the prefix of
-    // the other. So both have been implemented in the same function. There is a separate function
-    // that checks the common suffix, and the one called here checks for the rest of the other
-    // production
-    var_decl_t* result = match_decl_var_2();
-    
-    // If failed to match declaration, return
-    if (result == nullptr) return nullptr;
-    
-    // Acquire semi colon
-    lex::token* semi_colon_token = get_token();
+array_decl_t* parser_t::match_decl_array() {
 
-    if (semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
+    // Match the common prefix type id [
+    std::vector<lex::token*> prefix_tokens;
+    prefix_tokens.push_back(get_token());
+    prefix_tokens.push_back(match_token(lex::tag_t::ID));
+    prefix_tokens.push_back(match_token(lex::tag_t::OPEN_BRACKET));
 
-        put_back_token(semi_colon_token);
-        result->undo(this);
-        delete result;
-        return nullptr;
+    // Only the simple array declaration has a size
+    if (peek()->tag != lex::tag_t::CLOSED_BRACKET) {
+        return match_decl_array_simple(prefix_tokens);
     }
 
-    result->tokens.push_back(semi_colon_token);
-    return result;
+    prefix_tokens.push_back(get_token());
+    prefix_tokens.push_back(match_token(lex::tag_t::ASSIGNMENT));
+
+    switch (peek()->tag) {
+        case lex::tag_t::OPEN_BRACE:
+            return match_decl_array_init_list(prefix_tokens);
+        case lex::tag_t::STRING_LITERAL:
+            return match_decl_array_str(prefix_tokens);
+        default:
+            throw_construct_error();
+    }
 }
 
-array_decl_t* parser_t::match_decl_array() {
+// func_decl -> type id ( param_decls ) ;
+//           |  type id ( param_decls ) block_stmt
+//           |  inline type id ( param_decls ) block_stmt
+func_decl_t* parser_t::match_decl_func() {
 
-    array_decl_t* result = nullptr;
-    
-    result = match_decl_array_simple();
-    if (result != nullptr) return result;
+    lex::token* inline_token = nullptr;
+
+    // Only a function with a body can be inlined
+    if (peek()->tag == lex::tag_t::INLINE) {
+        inline_token = get_token();
 
-    result = match_decl_array_init_list();
-    if (result != nullptr) return result;
+        if (!is_type(peek())) throw_construct_error();
+    }
+
+    lex::token* type_token          = get_token();
+    lex::token* id_token            = match_token(lex::tag_t::ID);
+    lex::token* open_paren_token    = match_token(lex::tag_t::OPEN_PAREN);
+
+    // Matching no parameter declarations is okay
+    param_decls_t* param_list = match_param_decls();
+
+    lex::token* closed_paren_token = match_token(lex::tag_t::CLOSED_PAREN);
+    lex::token* semi_token = nullptr;
+    block_stmt_t* bs = nullptr;
+
+    // A declaration without a body ends with a semi colon
+    if (peek()->tag == lex::tag_t::SEMI_COLON && inline_token == nullptr) {
+        semi_token = get_token();
+    } else if (peek()->tag == lex::tag_t::OPEN_BRACE) {
+        bs = match_stmt_block();
+    } else {
+        throw_construct_error();
+    }
+
+    // Build syntax object
+    func_decl_t* result = ast_arena.create<func_decl_t>();
+    result->type = get_type(type_token);
+    result->id = id_token->value;
+    result->stmt = bs;
+    result->param_list = param_list;
+    result->is_inline = (inline_token != nullptr);
+
+    // Save tokens in syntax object
+    store_tokens(result, { inline_token, type_token, id_token, open_paren_token, closed_paren_token, semi_token });
 
-    result = match_decl_array_str();
     return result;
 }
 
@@ -196,60 +316,40 @@ array_decl_t* parser_t::match_decl_array() {
 //             |  e  
 param_decls_t* parser_t::match_param_decls() {
 
-    param_decl_t* first = match_param_decl();
-    // If failed matching first, return nullptr
-    if (first == nullptr) {
-        return nullptr;
-    }
-
-    param_decls_t* result = new param_decls_t();
-    result->first = first;
+    size_t start = list_scratch.size();
 
-    // TODO add syntax error handling here
-
-    // Try matching more decls
-    result->rest = match_param_decls();
+    while (peek()->tag != lex::tag_t::CLOSED_PAREN) {
+        list_scratch.push_back(match_param_decl());
+    }
     
-    return result;
+    return store_list<param_decls_t>(start);
 }
 
 // param_decl -> type id
 //            |  type * id
 param_decl_t* parser_t::match_param_decl() {
 
-    lex::token* type_token;
-    lex::token* star_token = nullptr;
-    lex::token* id_token;
-
-    type_token  = get_token();
-    
-    star_token = get_token();
-    if (star_token->tag != lex::tag_t::STAR) {
-        put_back_token(star_token);
-        star_token = nullptr;
+    if (!is_type(peek())) {
+        throw_construct_error();
     }
 
-    id_token    = get_token();
+    lex::token* type_token = get_token();
+    lex::token* star_token = nullptr;
 
-    if (!is_type(type_token) || id_token->tag != lex::tag_t::ID) {
-        put_back_token(id_token);
-        if (star_token) put_back_token(star_token);
-        put_back_token(type_token);
-        return nullptr;
+    if (peek()->tag == lex::tag_t::STAR) {
+        star_token = get_token();
     }
 
-    // If gotten this far, match was succesful
+    lex::token* id_token = match_token(lex::tag_t::ID);
 
     // Create syntax object
-    param_decl_t* result = new param_decl_t();
-    result->type        = get_type(static_cast<lex::id_token*>(type_token));
-    result->id          = static_cast<lex::id_token*>(id_token)->lexeme;
+    param_decl_t* result = ast_arena.create<param_decl_t>();
+    result->type        = get_type(type_token);
+    result->id          = id_token->value;
     result->is_pointer  = star_token != nullptr;
 
     // Store token
-    result->tokens.push_back(type_token);
-    if (star_token) result->tokens.push_back(star_token);
-    result->tokens.push_back(id_token);
+    store_tokens(result, { type_token, star_token, id_token });
 
     return result;
 }
@@ -258,790 +358,404 @@ param_decl_t* parser_t::match_param_decl() {
 //              |   e
 params_t* parser_t::match_params() {
 
-    expr_t* first;
+    size_t start = list_scratch.size();
 
-    try {
-        first = match_expr();
-    } catch (syntax_error e) {
-        return nullptr;
+    while (peek()->tag != lex::tag_t::CLOSED_PAREN) {
+        list_scratch.push_back(match_construct_expr());
     }
-    
-    // Change associativity of expression if needed
-    first = binop_expr_t::rewrite(first);
-    
-
-    params_t* result = new params_t();
-    result->first = first;
-
-    // Try matching more parameters
-    result->rest = match_params();
 
-    return result;
+    return store_list<params_t>(start);
 }
 
+//  asm_params  ->  asm_param asm_params
+//              |   e
 asm_params_t* parser_t::match_asm_params() {
 
-    asm_param_t* first;
-
-    first = match_asm_param();
+    size_t start = list_scratch.size();
 
-    if (first == nullptr) return nullptr;
-
-    asm_params_t* result = new asm_params_t();
-    result->first = first;
-
-    // Try matching more parameters
-    result->rest = match_asm_params();
+    while (peek()->tag == lex::tag_t::ID || peek()->tag == lex::tag_t::INT_LITERAL) {
+        list_scratch.push_back(match_asm_param());
+    }
 
-    return result;
+    return store_list<asm_params_t>(start);
 }
 
-asm_param_t* parser_t::match_asm_param() {
-
-    asm_param_t* result;
+term_t* parser_t::match_asm_param() {
 
-    result = match_term_literal();
-    if (result != nullptr) return result;
-
-    result = match_term_identifier();
-    return result;
+    if (peek()->tag == lex::tag_t::INT_LITERAL) {
+        return match_term_literal();
+    }
 
+    return match_term_identifier();
 }
 
+// stmts -> stmt stmts
+//       |  e
 stmts_t* parser_t::match_stmts() {
     
-    stmts_t* stmts = nullptr;
-
-    try {
-        stmts = match_stmts_1();
-    } catch (syntax_error e) {
+    size_t start = list_scratch.size();
 
-        if (peek()->tag != lex::tag_t::CLOSED_BRACE) {
-            throw e;
-        }
+    // Match statements until the end of the block
+    while (peek()->tag != lex::tag_t::CLOSED_BRACE) {
+        list_scratch.push_back(match_stmt());
     }
-    if (stmts != nullptr) return stmts;
 
-    return match_stmts_2();
+    return store_list<stmts_t>(start);
 }
 
 stmt_t* parser_t::match_stmt() {
     
-    stmt_t* stmt;
+    // Statements nest, remember the enclosing construct
+    const lex::token* previous_start = construct_start;
+    bool previous_matching_stmt = matching_stmt;
 
-    stmt = match_stmt_assign();
-    if (stmt != nullptr) return stmt;
+    construct_start = peek();
+    matching_stmt = true;
 
-    stmt = match_stmt_assign_deref();
-    if (stmt != nullptr) return stmt;
+    stmt_t* stmt;
+    const lex::token* first = peek();
 
-    stmt = match_stmt_assign_indexed();
-    if (stmt != nullptr) return stmt;
+    switch (first->tag) {
+        case lex::tag_t::OPEN_BRACE:
+            stmt = match_stmt_block();
+            break;
+        case lex::tag_t::IF:
+            stmt = match_stmt_if();
+            break;
+        case lex::tag_t::WHILE:
+        case lex::tag_t::UNROLL:
+            stmt = match_stmt_while();
+            break;
+        case lex::tag_t::ASM:
+            stmt = match_stmt_asm();
+            break;
+        case lex::tag_t::BREAK:
+            stmt = match_stmt_break();
+            break;
+        case lex::tag_t::CONTINUE:
+            stmt = match_stmt_continue();
+            break;
+        case lex::tag_t::RETURN:
+            stmt = match_stmt_return();
+            break;
+        case lex::tag_t::STAR:
+            
+            // Either an assignment through a pointer or an expression starting with a dereference
+            if (peek(1)->tag == lex::tag_t::ID && peek(2)->tag == lex::tag_t::ASSIGNMENT) {
+                stmt = match_stmt_assign_deref();
+            } else {
+                stmt = match_stmt_expr(nullptr);
+            }
+            break;
+        case lex::tag_t::ID:
+            
+            // Assignments take precedence over declarations, so type names can be assigned to
+            if (peek(1)->tag == lex::tag_t::ASSIGNMENT) {
+                stmt = match_stmt_assign();
+            } else if (peek(1)->tag == lex::tag_t::OPEN_BRACKET) {
+                stmt = match_stmt_indexed();
+            } else if (is_type(first) && peek(1)->tag == lex::tag_t::ID && peek(2)->tag == lex::tag_t::OPEN_BRACKET) {
+                stmt = match_decl_array();
+            } else if (is_type(first) && (peek(1)->tag == lex::tag_t::ID || (peek(1)->tag == lex::tag_t::STAR && peek(2)->tag == lex::tag_t::ID))) {
+                stmt = match_decl_var();
+            } else {
+                stmt = match_stmt_expr(nullptr);
+            }
+            break;
+        default:
+            stmt = match_stmt_expr(nullptr);
+            break;
+    }
 
-    stmt = match_stmt_decl();
-    if (stmt != nullptr) return stmt;
+    construct_start = previous_start;
+    matching_stmt = previous_matching_stmt;
 
-    stmt = match_decl_array();
-    if (stmt != nullptr) return stmt;
+    return stmt;
+}
 
-    stmt = match_stmt_block();
-    if (stmt != nullptr) return stmt;
+// Binding strength of binary operators, -1 if the token is not a binary operator
+static int get_precedence(lex::tag_t tag) {
 
-    stmt = match_stmt_return();
-    if (stmt != nullptr) return stmt;
+    switch (tag) {
+        case lex::tag_t::STAR:
+            return 8;
+        case lex::tag_t::PLUS:
+        case lex::tag_t::MINUS:
+            return 7;
+        case lex::tag_t::SHIFT_LEFT:
+        case lex::tag_t::SHIFT_RIGHT:
+            return 6;
+        case lex::tag_t::LESS:
+        case lex::tag_t::GREATER:
+        case lex::tag_t::LESS_OR_EQUAL:
+        case lex::tag_t::GREATER_OR_EQUAL:
+            return 5;
+        case lex::tag_t::EQUALS:
+        case lex::tag_t::NOT_EQUALS:
+            return 4;
+        case lex::tag_t::AND:
+            return 3;
+        case lex::tag_t::OR:
+            return 2;
+        case lex::tag_t::LOGICAL_AND:
+            return 1;
+        case lex::tag_t::LOGICAL_OR:
+            return 0;
+        default:
+            return -1;
+    }
+}
 
-    stmt = match_stmt_expr();
-    if (stmt != nullptr) return stmt;
+expr_t* parser_t::match_expr() {
+    return match_expr_binop(match_operand(), 0);
+}
 
-    stmt = match_stmt_if();
-    if (stmt != nullptr) return stmt;
+// operand -> "-" term
+//         |  "!" term
+//         |  term
+expr_t* parser_t::match_operand() {
+    
+    const lex::token* start = peek();
 
-    stmt = match_stmt_while();
-    if (stmt != nullptr) return stmt;
+    switch (start->tag) {
+        case lex::tag_t::MINUS:
+            return match_expr_negated();
+        case lex::tag_t::NOT:
+            return match_expr_not();
+        default:
+            break;
+    }
 
-    stmt = match_stmt_asm();
-    if (stmt != nullptr) return stmt;
-    
-    stmt = match_stmt_break();
-    if (stmt != nullptr) return stmt;
+    term_t* term = match_term();
 
-    stmt = match_stmt_continue();
-    if (stmt != nullptr) return stmt;
+    if (term == nullptr) {
+        syntax_error::throw_error("Could not match expression. Unexpected " + lex::token_names[(int) start->tag] + " token ", start);
+    }
 
-    syntax_error::throw_error("Could not match statement. Unexpected " + lex::token_names[(int) peek()->tag] + " token ", peek());
+    return term;
 }
 
-expr_t* parser_t::match_expr() {
-    
-    expr_t* expr;
+// expr -> operand binop expr
+//      |  operand
+// Precedence climbing: keeps folding operators into left as long as they bind at least as strongly as
+// min_precedence. The right operand only takes operators binding strictly stronger, which makes every
+// operator left associative
+expr_t* parser_t::match_expr_binop(expr_t* left, int min_precedence) {
+
+    while (get_precedence(peek()->tag) >= min_precedence) {
+
+        int precedence = get_precedence(peek()->tag);
+        binop_expr_t* result = match_binop();
 
-    expr = match_expr_binop();
-    if (expr != nullptr) return expr;
+        // Build syntax object
+        result->left = left;
+        result->right = match_expr_binop(match_operand(), precedence + 1);
 
-    expr = match_expr_term();
-    if (expr != nullptr) return expr;
+        left = result;
+    }
 
-    expr = match_expr_negated();
-    if (expr != nullptr) return expr;
+    return left;
+}
 
-    expr = match_expr_not();
-    if (expr != nullptr) return expr;
+expr_t* parser_t::match_construct_expr() {
 
-    syntax_error::throw_error("Could not match expression. Unexpected " + lex::token_names[(int) peek()->tag] + " token ", peek());
+    try {
+        return match_expr();
+    } catch (syntax_error e) {
+        throw_construct_error();
+    }
 }
 
 binop_expr_t* parser_t::match_binop() {
    
-    lex::token* op_token = get_token();
     binop_expr_t* result = nullptr; 
 
-    switch (op_token->tag) {
+    switch (peek()->tag) {
         case lex::tag_t::PLUS:
-            result = new add_binop_t();
+            result = ast_arena.create<add_binop_t>();
             break;
         case lex::tag_t::MINUS:
-            result = new sub_binop_t();
+            result = ast_arena.create<sub_binop_t>();
             break;
         case lex::tag_t::AND:
-            result = new and_binop_t();
+            result = ast_arena.create<and_binop_t>();
             break;
         case lex::tag_t::OR:
-            result = new or_binop_t();
+            result = ast_arena.create<or_binop_t>();
+            break;
+        case lex::tag_t::LOGICAL_AND:
+            result = ast_arena.create<logical_and_binop_t>();
+            break;
+        case lex::tag_t::LOGICAL_OR:
+            result = ast_arena.create<logical_or_binop_t>();
             break;
         case lex::tag_t::STAR:
-            result = new mult_binop_t();
+            result = ast_arena.create<mult_binop_t>();
+            break;
+        case lex::tag_t::SHIFT_LEFT:
+            result = ast_arena.create<shift_left_binop_t>();
+            break;
+        case lex::tag_t::SHIFT_RIGHT:
+            result = ast_arena.create<shift_right_binop_t>();
             break;
         case lex::tag_t::EQUALS:
-            result = new eq_binop_t();
+            result = ast_arena.create<eq_binop_t>();
             break;
         case lex::tag_t::NOT_EQUALS:
-            result = new neq_binop_t();
+            result = ast_arena.create<neq_binop_t>();
             break;
         case lex::tag_t::LESS:
-            result = new less_binop_t();
+            result = ast_arena.create<less_binop_t>();
             break;
         case lex::tag_t::GREATER:
-            result = new greater_binop_t();
+            result = ast_arena.create<greater_binop_t>();
             break;
         case lex::tag_t::LESS_OR_EQUAL:
-            result = new less_eq_binop_t();
+            result = ast_arena.create<less_eq_binop_t>();
             break;
         case lex::tag_t::GREATER_OR_EQUAL:
-            result = new greater_eq_binop_t();
+            result = ast_arena.create<greater_eq_binop_t>();
             break;
         default:
-            put_back_token(op_token);
             return nullptr;
     }
 
-    // If gotten this far, match was successful
-    
     // Store token
-    result->tokens.push_back(op_token);
+    store_tokens(result, { get_token() });
 
     return result;
 }
 
+// Returns nullptr if no term starts at the next token
 term_t* parser_t::match_term() {
     
-    term_t* term;
-
-    term = match_term_call();
-    if (term != nullptr) return term;
-    
-    
-    term = match_term_literal();
-    if (term != nullptr) return term;
-
-    term = match_term_addr_of();
-    if (term != nullptr) return term;
-
-    term = match_term_deref();
-    if (term != nullptr) return term;
-    
-    // Cannot be below match_term_identifier since that is a substring of this production
-    term = match_term_indexed();
-    if (term != nullptr) return term;
-
-    term = match_term_identifier();
-    if (term != nullptr) return term;
+    switch (peek()->tag) {
+        case lex::tag_t::ID:
+            
+            if (peek(1)->tag == lex::tag_t::OPEN_PAREN) return match_term_call();
+            if (peek(1)->tag == lex::tag_t::OPEN_BRACKET) return match_term_indexed();
+            return match_term_identifier();
 
-    term = match_term_expr();
-    return term;
-
-}
-
-// Production specific matching functions
-
-// decls -> decl decls
-decls_t* parser_t::match_decls_1() {
-
-    decl_t* first = match_decl();
-
-    // If could not find a declaration, free memory and return nullptr
-    if (first == nullptr) {
-        return nullptr;
-    }
-    decls_t* result = new decls_t;
-    result->first = first;
-
-    // Otherwise, look for more declarations
-    decls_t* rest = (decls_t*) match_decls();
-    result->rest = rest;
-
-    return result;
-}
-
-// decls -> e
-decls_t* parser_t::match_decls_2() {
-    // Empty production should just return nullptr, 
-    // since empty production in struct means nullptr
-    // and empty production always matches
-    return nullptr;
-}
-
-// var_decl -> type id
-//          |  type * id
-var_decl_t* parser_t::match_decl_var_1() {
-
-    lex::token *type_token;
-    lex::token *star_token = nullptr;
-    lex::token *id_token;
-    // Get type
-    type_token = get_token();
-
-    // If first token is not a word token or is not a type, put back token, delete d and return nullptr
-    if (!is_type(type_token)) {
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    star_token = get_token();
-    if (star_token->tag != lex::tag_t::STAR) {
-        put_back_token(star_token);
-        star_token = nullptr;
-    }
-
-    // Get identifier
-    id_token = get_token();
-    
-    // If token is not an identifier, put back tokens in reverse order, delete d and return nullptr
-    if (id_token->tag != lex::tag_t::ID) {
-        put_back_token(id_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // If successful, build syntax type
-    var_decl_t* d = new var_decl_t();
-    
-    d->type = get_type(static_cast<lex::id_token*>(type_token));
-    d->id = static_cast<lex::id_token*>(id_token)->lexeme;
-    d->is_pointer = (star_token != nullptr);
-
-    d->tokens.push_back(type_token);
-    d->tokens.push_back(id_token);
-
-    return d;
-}
-
-// var_decl -> type id "=" expr
-//          |  type "*" id "=" expr
-var_decl_t* parser_t::match_decl_var_2() {
-
-    // Use other function to try to find first part of the declaration
-    var_decl_t* d  = match_decl_var_1();
-    // If first part is not found, return nullptr
-    if (d == nullptr) return nullptr;
-
-    // Try to find assignment
-    lex::token* equals = get_token();
-
-    // If token is not an assignment operator put back token and return earlier declaration
-    if (equals->tag != lex::tag_t::ASSIGNMENT) {
-        put_back_token(equals);
-        d->value = nullptr;
-        return d;
-    }
-
-    // Else check for expression
-    expr_t* value = match_expr();
-    
-    // If no expression is found, return nullptr
-    // TODO: Throw exception instead and free memory
-    if (value == nullptr) {
+        case lex::tag_t::INT_LITERAL:
+            return match_term_literal();
         
-        value->undo(this);
-        put_back_token(equals);
-        d->undo(this);
-        delete value;
-        delete d;
-        return nullptr;
+        case lex::tag_t::AND:
+            
+            if (peek(1)->tag != lex::tag_t::ID) return nullptr;
+            return match_term_addr_of();
+        
+        case lex::tag_t::STAR:
+            
+            if (peek(1)->tag != lex::tag_t::ID) return nullptr;
+            return match_term_deref();
+        
+        case lex::tag_t::OPEN_PAREN:
+            return match_term_expr();
+        
+        default:
+            return nullptr;
     }
-
-    // If everything is in order, build syntax object
-
-    // Change associativity of expression if needed
-    value = binop_expr_t::rewrite(value);
-
-    // TODO: Add variable name to symbol table
-    d->tokens.push_back(equals);
-    
-    d->value = value;
-
-    return d;
 }
 
+// Production specific matching functions
+
+//  init_list   ->  expr init_list
+//              |   e
 init_list_t* parser_t::match_init_list() {
 
-    expr_t* first;
+    size_t start = list_scratch.size();
 
-    try {
-        first = match_expr();
-    } catch (syntax_error e) {
-        return nullptr;
+    while (peek()->tag != lex::tag_t::CLOSED_BRACE) {
+        list_scratch.push_back(match_construct_expr());
     }
-    
-    // Change associativity of expression if needed
-    first = binop_expr_t::rewrite(first);
-    
-
-    init_list_t* result = new init_list_t();
-    result->first = first;
-
-    // Try matching more parameters
-    result->rest = match_init_list();
-
-    return result;    
 
+    return store_list<init_list_t>(start);
 }
 
 // array_decl -> type id [ expr ] ;
-simple_array_decl_t* parser_t::match_decl_array_simple() {
-
-    lex::token* type_token;
-    lex::token* identifier_token;
-    lex::token* open_bracket_token;
-    lex::token* closed_bracket_token;
-    lex::token* semi_colon_token;
-
-    type_token          = get_token();
-    identifier_token    = get_token();
-    open_bracket_token  = get_token();
-
-    if (!is_type(type_token) || identifier_token->tag != lex::tag_t::ID || open_bracket_token->tag != lex::tag_t::OPEN_BRACKET) {
-        put_back_token(open_bracket_token);
-        put_back_token(identifier_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    expr_t* size = nullptr;
-    try {
-        size = match_expr();
-    } catch (syntax_error e) {
-        put_back_token(open_bracket_token);
-        put_back_token(identifier_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    closed_bracket_token = get_token();
-    semi_colon_token     = get_token();
+simple_array_decl_t* parser_t::match_decl_array_simple(std::vector<lex::token*>& prefix_tokens) {
 
-    if (closed_bracket_token->tag != lex::tag_t::CLOSED_BRACKET || semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        put_back_token(semi_colon_token);
-        put_back_token(closed_bracket_token);
+    expr_t* size = match_construct_expr();
 
-        size->undo(this);
-        delete size;
-
-        put_back_token(open_bracket_token);
-        put_back_token(identifier_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // If gotten this far, match was successful
-
-    // Change associativity of size expressinon
-    size = binop_expr_t::rewrite(size);
+    lex::token* closed_bracket_token = match_token(lex::tag_t::CLOSED_BRACKET);
+    lex::token* semi_colon_token     = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    simple_array_decl_t* result = new simple_array_decl_t();
+    simple_array_decl_t* result = ast_arena.create<simple_array_decl_t>();
     
-    result->type = get_type(static_cast<lex::id_token*>(type_token));
-    result->identifier = static_cast<lex::id_token*>(identifier_token)->lexeme;
+    result->type = get_type(prefix_tokens[0]);
+    result->identifier = prefix_tokens[1]->value;
     result->size = size;
 
     // Store tokens
-    result->tokens.push_back(type_token);
-    result->tokens.push_back(identifier_token);
-    result->tokens.push_back(open_bracket_token);
-    result->tokens.push_back(closed_bracket_token);
-    result->tokens.push_back(semi_colon_token);
+    store_tokens(result, { prefix_tokens[0], prefix_tokens[1], prefix_tokens[2], closed_bracket_token, semi_colon_token });
 
     return result;
 }
 
 // array_decl -> type id [ ] = { init_list } ;
-init_list_array_decl_t* parser_t::match_decl_array_init_list() {
-
-    lex::token* type_token;
-    lex::token* identifier_token;
-    lex::token* open_bracket_token;
-    lex::token* closed_bracket_token;
-    lex::token* assignment_token;
-    lex::token* open_brace_token;
-    lex::token* closed_brace_token;
-    lex::token* semi_colon_token;
-
-    type_token              = get_token();
-    identifier_token        = get_token();   
-    open_bracket_token      = get_token();
-    closed_bracket_token    = get_token();  
-    assignment_token        = get_token();
-    open_brace_token        = get_token();
-
-    if (!is_type(type_token) ||
-        identifier_token->tag != lex::tag_t::ID ||
-        open_bracket_token->tag != lex::tag_t::OPEN_BRACKET ||
-        closed_bracket_token->tag != lex::tag_t::CLOSED_BRACKET ||
-        assignment_token->tag != lex::tag_t::ASSIGNMENT ||
-        open_brace_token->tag != lex::tag_t::OPEN_BRACE) {
-
-            put_back_token(open_brace_token);
-            put_back_token(assignment_token);
-            put_back_token(closed_bracket_token);
-            put_back_token(open_bracket_token);
-            put_back_token(identifier_token);
-            put_back_token(type_token);
-            return nullptr;
-    }
+init_list_array_decl_t* parser_t::match_decl_array_init_list(std::vector<lex::token*>& prefix_tokens) {
 
-    init_list_t* init_list = match_init_list();
+    lex::token* open_brace_token = get_token();
 
-    if (init_list == nullptr) {
-        put_back_token(open_brace_token);
-        put_back_token(assignment_token);
-        put_back_token(closed_bracket_token);
-        put_back_token(open_bracket_token);
-        put_back_token(identifier_token);
-        put_back_token(type_token);
-        return nullptr;
+    // The initializer list may not be empty
+    if (peek()->tag == lex::tag_t::CLOSED_BRACE) {
+        throw_construct_error();
     }
 
-    closed_brace_token = get_token();
-    semi_colon_token   = get_token();
-
-    if (closed_brace_token->tag != lex::tag_t::CLOSED_BRACE || semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        put_back_token(semi_colon_token);
-        put_back_token(closed_brace_token);
-
-        init_list->undo(this);
-        delete init_list;
-
-        put_back_token(open_brace_token);
-        put_back_token(assignment_token);
-        put_back_token(closed_bracket_token);
-        put_back_token(open_bracket_token);
-        put_back_token(identifier_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
+    init_list_t* init_list = match_init_list();
 
-    // If gotten this far, match was successful
+    lex::token* closed_brace_token = get_token();
+    lex::token* semi_colon_token   = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    init_list_array_decl_t* result = new init_list_array_decl_t();
+    init_list_array_decl_t* result = ast_arena.create<init_list_array_decl_t>();
 
-    result->type = get_type(static_cast<lex::id_token*>(type_token));
-    result->identifier = static_cast<lex::id_token*>(identifier_token)->lexeme;
+    result->type = get_type(prefix_tokens[0]);
+    result->identifier = prefix_tokens[1]->value;
     result->init_list = init_list;
 
     // Store tokens
-    result->tokens.push_back(type_token);
-    result->tokens.push_back(identifier_token);
-    result->tokens.push_back(open_bracket_token);
-    result->tokens.push_back(closed_bracket_token);
-    result->tokens.push_back(assignment_token);
-    result->tokens.push_back(open_brace_token);
-    result->tokens.push_back(closed_brace_token);
-    result->tokens.push_back(semi_colon_token);
+    store_tokens(result, { prefix_tokens[0], prefix_tokens[1], prefix_tokens[2], prefix_tokens[3], prefix_tokens[4], open_brace_token, closed_brace_token, semi_colon_token });
 
     return result;
 }
 
 // array_decl -> type id [ ] = str_lit ; 
-str_array_decl_t* parser_t::match_decl_array_str() {
+str_array_decl_t* parser_t::match_decl_array_str(std::vector<lex::token*>& prefix_tokens) {
 
-    lex::token* type_token              = get_token();
-    lex::token* identifier_token        = get_token();
-    lex::token* open_bracket_token      = get_token();
-    lex::token* closed_bracket_token    = get_token();
-    lex::token* assignment_token        = get_token();
     lex::token* string_literal_token    = get_token();
-    lex::token* semi_colon_token        = get_token();
-
-
-    if (!is_type(type_token) ||
-        identifier_token->tag != lex::tag_t::ID ||
-        open_bracket_token->tag != lex::tag_t::OPEN_BRACKET ||
-        closed_bracket_token->tag != lex::tag_t::CLOSED_BRACKET ||
-        assignment_token->tag != lex::tag_t::ASSIGNMENT ||
-        string_literal_token->tag != lex::tag_t::STRING_LITERAL ||
-        semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-
-            put_back_token(semi_colon_token);
-            put_back_token(string_literal_token);
-            put_back_token(assignment_token);
-            put_back_token(closed_bracket_token);
-            put_back_token(open_bracket_token);
-            put_back_token(identifier_token);
-            put_back_token(type_token);
-            return nullptr;
-    }
-
-    // If gotten this far, match was successful
+    lex::token* semi_colon_token        = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    str_array_decl_t* result = new str_array_decl_t();
+    str_array_decl_t* result = ast_arena.create<str_array_decl_t>();
     
-    result->type = get_type(static_cast<lex::id_token*>(type_token));
-    result->identifier = static_cast<lex::id_token*>(identifier_token)->lexeme;
-    result->string_literal = static_cast<lex::str_literal_token*>(string_literal_token)->value;
+    result->type = get_type(prefix_tokens[0]);
+    result->identifier = prefix_tokens[1]->value;
+    result->string_literal = ast_arena.copy_string(get_lexeme(string_literal_token));
 
     // Store tokens
-    result->tokens.push_back(type_token);
-    result->tokens.push_back(identifier_token);
-    result->tokens.push_back(open_bracket_token);
-    result->tokens.push_back(closed_bracket_token);
-    result->tokens.push_back(assignment_token);
-    result->tokens.push_back(string_literal_token);
-    result->tokens.push_back(semi_colon_token);
-
-    return result;
-}
-
-// func_decl -> type id ( param_decls ) ;
-func_decl_t* parser_t::match_decl_func_1() {
-
-    lex::token* type_token;
-    lex::token* id_token;
-    lex::token* open_paren_token;
-    lex::token* closed_paren_token;
-    lex::token* semi_token;
-
-    // Acquire first token
-    type_token = get_token();
-
-    // If first token is not a type token, put back token, delete d and return nullptr
-    if (!is_type(type_token)) {
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // Acquire identifier token
-    id_token = get_token();
-    // If the acquired token is not an identifier, put back tokens, delete d and return nullptr
-    if (id_token->tag != lex::tag_t::ID) {
-        put_back_token(id_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // Acquire first parenthesis tokens
-    open_paren_token    = get_token();
-
-    if (open_paren_token->tag != lex::tag_t::OPEN_PAREN) {
-        put_back_token(open_paren_token);
-        put_back_token(id_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // Try matching parameter declarations, if none is found, it's not a problem
-    param_decls_t* param_list = match_param_decls();
-
-
-    closed_paren_token  = get_token();
-    semi_token          = get_token();
-    // If acquired tokens are not parenthesis
-    if (closed_paren_token->tag != lex::tag_t::CLOSED_PAREN || semi_token->tag != lex::tag_t::SEMI_COLON) {
-        
-        put_back_token(semi_token);
-        put_back_token(closed_paren_token);
-
-        if (param_list != nullptr) {
-            param_list->undo(this);
-            delete param_list;
-        }
-
-        put_back_token(open_paren_token);
-        put_back_token(id_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // If gotten so far, match is successful.
-    // Build syntax object
-    func_decl_t* result = new func_decl_t();
-    result->type = get_type(static_cast<lex::id_token*>(type_token));
-    result->id = static_cast<lex::id_token*>(id_token)->lexeme;
-    result->stmt = nullptr;
-    result->param_list = param_list;
-
-    // Save tokens in syntax object
-    result->tokens.push_back(type_token);
-    result->tokens.push_back(id_token);
-    result->tokens.push_back(open_paren_token);
-    result->tokens.push_back(closed_paren_token);
-    result->tokens.push_back(semi_token);
-
-    return result;
-}
-
-// func_decl -> type id ( ) block_stmt
-func_decl_t* parser_t::match_decl_func_2() {
-
-    lex::token* type_token;
-    lex::token* id_token;
-    lex::token* open_paren_token;
-    lex::token* closed_paren_token;
-
-    // Acquire first token
-    type_token = get_token();
-
-    // If first token is not a type token, put back token, delete d and return nullptr
-    if (!is_type(type_token)) {
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // Acquire identifier token
-    id_token = get_token();
-    // If the acquired token is not an identifier, put back tokens, delete d and return nullptr
-    if (id_token->tag != lex::tag_t::ID) {
-        put_back_token(id_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // Acquire first parenthesis tokens
-    open_paren_token = get_token();
-
-    if (open_paren_token->tag != lex::tag_t::OPEN_PAREN) {
-        put_back_token(open_paren_token);
-        put_back_token(id_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // Try matching parameter declarations, if none is found, it's not a problem
-    param_decls_t* param_list = match_param_decls();
-
-    closed_paren_token  = get_token();
-    // If acquired tokens are not parenthesis
-    if (closed_paren_token->tag != lex::tag_t::CLOSED_PAREN) {
-        put_back_token(closed_paren_token);
-
-        // If there is a parameter list, undo it
-        if (param_list != nullptr) {
-            param_list->undo(this);
-            delete param_list;
-        }
-
-        put_back_token(open_paren_token);
-        put_back_token(id_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // Acquire block statement
-    block_stmt_t* bs = match_stmt_block();
-    
-    // If unsuccessful in finding block statement, put back tokens and return nullptr
-    if (bs == nullptr) {
-        put_back_token(closed_paren_token);
-
-        // If there is a parameter list, undo it
-        if (param_list != nullptr) {
-            param_list->undo(this);
-            delete param_list;
-        }
-
-        put_back_token(open_paren_token);
-        put_back_token(id_token);
-        put_back_token(type_token);
-        return nullptr;
-    }
-
-    // If gotten so far, match is successful
-    // Build syntax object
-    func_decl_t* result = new func_decl_t();
-    result->type = get_type(static_cast<lex::id_token*>(type_token));
-    result->id = static_cast<lex::id_token*>(id_token)->lexeme;
-    result->stmt = bs;
-    result->param_list = param_list;
-
-    // Store tokens in syntax object
-    result->tokens.push_back(type_token);
-    result->tokens.push_back(id_token);
-    result->tokens.push_back(open_paren_token);
-    result->tokens.push_back(closed_paren_token);
-
-    return result;
-}
-
-// block_stmt  ->  { stmts }
-block_stmt_t* parser_t::match_stmt_block() {
-    
-    lex::token* open_brace;
-    lex::token* closed_brace;
-
-    // Acquire first token
-    open_brace = get_token();
-
-    // If first token is not an open brace, revert
-    if (open_brace->tag != lex::tag_t::OPEN_BRACE) {
-        put_back_token(open_brace);
-        return nullptr;
-    }
-    
-
-    stmts_t* inner = match_stmts();
-    // Not matching statements is okay
-    /*if (inner == nullptr) {
-        put_back_token(open_brace);
-        return nullptr;
-    }*/
-
-    
-
-    // Get token for closed brace
-    closed_brace = get_token();
-    if (closed_brace->tag != lex::tag_t::CLOSED_BRACE) {
-        
-        
-        put_back_token(closed_brace);
-        inner->undo(this);
-        put_back_token(open_brace);
+    store_tokens(result, { prefix_tokens[0], prefix_tokens[1], prefix_tokens[2], prefix_tokens[3], prefix_tokens[4], string_literal_token, semi_colon_token });
 
-        delete inner;
-        return nullptr;
-    }
+    return result;
+}
 
+// block_stmt  ->  { stmts }
+block_stmt_t* parser_t::match_stmt_block() {
     
+    lex::token* open_brace = match_token(lex::tag_t::OPEN_BRACE);
+
+    // Not matching statements is okay
+    stmts_t* inner = match_stmts();
 
-    // If we got this far, we have a successful match
+    lex::token* closed_brace = get_token();
 
     // Build syntax object
-    block_stmt_t* result = new block_stmt_t();
+    block_stmt_t* result = ast_arena.create<block_stmt_t>();
     result->statements = inner;
 
     // Store tokens
-    result->tokens.push_back(open_brace);
-    result->tokens.push_back(closed_brace);
+    store_tokens(result, { open_brace, closed_brace });
 
     return result;
 }
@@ -1050,22 +764,9 @@ block_stmt_t* parser_t::match_stmt_block() {
 //      |  if ( expr ) stmt else stmt 
 if_stmt_t* parser_t::match_stmt_if() {
 
-    
-
-    lex::token* if_token;
-    lex::token* open_paren_token;
-    lex::token* closed_paren_token;
-    lex::token* else_token;
-
-    if_token = get_token();
-    open_paren_token = get_token();
-    
-    // Mismatching tokens, revert
-    if (if_token->tag != lex::tag_t::IF || open_paren_token->tag != lex::tag_t::OPEN_PAREN) {
-        put_back_token(open_paren_token);
-        put_back_token(if_token);
-        return nullptr;
-    }
+    lex::token* if_token            = get_token();
+    lex::token* open_paren_token    = match_token(lex::tag_t::OPEN_PAREN);
+    lex::token* else_token          = nullptr;
 
     // Acquire conditional expression
     expr_t* cond;
@@ -1073,89 +774,41 @@ if_stmt_t* parser_t::match_stmt_if() {
     try {
         cond = match_expr();
     } catch (syntax_error e) {
-
-        // If could not acquire conditional, revert
-        put_back_token(open_paren_token);
-        put_back_token(if_token);
-        syntax_error::throw_error("Could not match condition expression for if statement. Unexpected " + lex::token_names[(int) peek()->tag] + " token ", peek());
+        syntax_error::throw_error("Could not match condition expression for if statement. Unexpected " + lex::token_names[(int) if_token->tag] + " token ", if_token);
     }
 
-    closed_paren_token = get_token();
-
-    if (closed_paren_token->tag != lex::tag_t::CLOSED_PAREN) {
-        put_back_token(closed_paren_token);
-        cond->undo(this);
-        put_back_token(open_paren_token);
-        put_back_token(if_token);
-
-        delete cond;
-        return nullptr;
-    }
+    lex::token* closed_paren_token = match_token(lex::tag_t::CLOSED_PAREN);
 
     stmt_t* stmt = match_stmt();
-
-    if (stmt == nullptr) {
-        put_back_token(closed_paren_token);
-        cond->undo(this);
-        put_back_token(open_paren_token);
-        put_back_token(if_token);
-        delete cond;
-        return nullptr;
-    }
-
-    else_token = get_token();
     stmt_t* else_stmt = nullptr;
 
     // Try matching else statement
-    if (else_token->tag == lex::tag_t::ELSE) {
-
+    if (peek()->tag == lex::tag_t::ELSE) {
+        else_token = get_token();
         else_stmt = match_stmt();
-
-    } else {
-        put_back_token(else_token);
-        else_token = nullptr;
     }
 
-    // If we got this far, we have a successful match, delete tokens and return result
-    
-    // Change associativity of expression if needed
-    cond = binop_expr_t::rewrite(cond);
-    
-
     // Build syntax object
-    if_stmt_t* result = new if_stmt_t();
+    if_stmt_t* result = ast_arena.create<if_stmt_t>();
     result->cond = cond;
     result->actions = stmt;
     result->else_actions = else_stmt;
 
     // Store tokens
-    result->tokens.push_back(if_token);
-    result->tokens.push_back(open_paren_token);
-    result->tokens.push_back(closed_paren_token);
-    if (else_token) result->tokens.push_back(else_token);
+    store_tokens(result, { if_token, open_paren_token, closed_paren_token, else_token });
 
-    
     return result;
 }
 
 // stmt -> while ( expr ) stmt
+//       |  unroll while ( expr ) stmt
 while_stmt_t* parser_t::match_stmt_while() {
 
-    
-
-    lex::token* while_token;
-    lex::token* open_paren_token;
-    lex::token* closed_paren_token;
+    lex::token* unroll_token = nullptr;
+    if (peek()->tag == lex::tag_t::UNROLL) unroll_token = get_token();
 
-    while_token = get_token();
-    open_paren_token = get_token();
-    
-    // Mismatching tokens, revert
-    if (while_token->tag != lex::tag_t::WHILE || open_paren_token->tag != lex::tag_t::OPEN_PAREN) {
-        put_back_token(open_paren_token);
-        put_back_token(while_token);
-        return nullptr;
-    }
+    lex::token* while_token         = match_token(lex::tag_t::WHILE);
+    lex::token* open_paren_token    = match_token(lex::tag_t::OPEN_PAREN);
 
     // Acquire conditional expression
     expr_t* cond;
@@ -1163,173 +816,85 @@ while_stmt_t* parser_t::match_stmt_while() {
     try {
         cond = match_expr();
     } catch (syntax_error e) {
-
-        // If could not acquire conditional, revert
-        put_back_token(open_paren_token);
-        put_back_token(while_token);
-        syntax_error::throw_error("Could not match condition expression for if statement. Unexpected " + lex::token_names[(int) peek()->tag] + " token ", peek());
+        syntax_error::throw_error("Could not match condition expression for if statement. Unexpected " + lex::token_names[(int) while_token->tag] + " token ", while_token);
     }
 
-    closed_paren_token = get_token();
-
-    if (closed_paren_token->tag != lex::tag_t::CLOSED_PAREN) {
-        put_back_token(closed_paren_token);
-        cond->undo(this);
-        put_back_token(open_paren_token);
-        put_back_token(while_token);
-
-        delete cond;
-        return nullptr;
-    }
+    lex::token* closed_paren_token = match_token(lex::tag_t::CLOSED_PAREN);
 
     stmt_t* stmt = match_stmt();
 
-    if (stmt == nullptr) {
-        put_back_token(closed_paren_token);
-        cond->undo(this);
-        put_back_token(open_paren_token);
-        put_back_token(while_token);
-        delete cond;
-        return nullptr;
-    }
-
-    // If we got this far, we have a successful match, delete tokens and return result
-    
-    // Change associativity of expression if needed
-    cond = binop_expr_t::rewrite(cond);
-    
-
     // Build syntax object
-    while_stmt_t* result = new while_stmt_t();
+    while_stmt_t* result = ast_arena.create<while_stmt_t>();
     result->cond = cond;
     result->actions = stmt;
+    result->is_unroll = (unroll_token != nullptr);
 
     // Store tokens
-    result->tokens.push_back(while_token);
-    result->tokens.push_back(open_paren_token);
-    result->tokens.push_back(closed_paren_token);
+    store_tokens(result, { unroll_token, while_token, open_paren_token, closed_paren_token });
 
-    
     return result;
 }
 
 // stmt -> asm ( str_lit asm_params ) ; 
 asm_stmt_t* parser_t::match_stmt_asm() {
 
-    lex::token* asm_token;
-    lex::token* open_paren_token;
-    lex::token* string_literal_token;
-    lex::token* closed_paren_token;
-    lex::token* semi_colon_token;
-
-    asm_token               = get_token();
-    open_paren_token        = get_token();
-    string_literal_token    = get_token();
-
-    if (asm_token->tag != lex::tag_t::ASM || open_paren_token->tag != lex::tag_t::OPEN_PAREN || string_literal_token->tag != lex::tag_t::STRING_LITERAL) {
-        put_back_token(string_literal_token);
-        put_back_token(open_paren_token);
-        put_back_token(asm_token);
-        return nullptr;
-    }
+    lex::token* asm_token               = get_token();
+    lex::token* open_paren_token        = match_token(lex::tag_t::OPEN_PAREN);
+    lex::token* string_literal_token    = match_token(lex::tag_t::STRING_LITERAL);
 
     asm_params_t* params = match_asm_params();
 
+    // At least one parameter is required
     if (params == nullptr) {
-        put_back_token(string_literal_token);
-        put_back_token(open_paren_token);
-        put_back_token(asm_token);
-        return nullptr;
-    }
-
-    closed_paren_token = get_token();
-    semi_colon_token = get_token();
-
-    if (closed_paren_token->tag != lex::tag_t::CLOSED_PAREN || semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        
-        put_back_token(semi_colon_token);
-        put_back_token(closed_paren_token);
-
-        params->undo(this);
-        delete params;
-
-        put_back_token(string_literal_token);
-        put_back_token(open_paren_token);
-        put_back_token(asm_token);
-        return nullptr;
+        throw_construct_error();
     }
 
-    // If gotten this far, match was successful
+    lex::token* closed_paren_token  = match_token(lex::tag_t::CLOSED_PAREN);
+    lex::token* semi_colon_token    = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    asm_stmt_t* result = new asm_stmt_t();
-    result->literal = strip_quotations(static_cast<lex::str_literal_token*>(string_literal_token)->value); 
+    asm_stmt_t* result = ast_arena.create<asm_stmt_t>();
+    result->literal = ast_arena.copy_string(strip_quotations(get_lexeme(string_literal_token)));
     result->params = params;
 
     // Store tokens
-    result->tokens.push_back(asm_token);
-    result->tokens.push_back(open_paren_token);
-    result->tokens.push_back(string_literal_token);
-    result->tokens.push_back(closed_paren_token);
-    result->tokens.push_back(semi_colon_token);
+    store_tokens(result, { asm_token, open_paren_token, string_literal_token, closed_paren_token, semi_colon_token });
 
     return result;
 }
 
+// stmt -> break literal ;
 break_stmt_t* parser_t::match_stmt_break() {
 
     lex::token* break_token         = get_token();
-    lex::token* int_literal_token   = get_token();
-    lex::token* semi_colon_token    = get_token();
-
-
-    if (break_token->tag != lex::tag_t::BREAK || int_literal_token->tag != lex::tag_t::INT_LITERAL || semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        put_back_token(semi_colon_token);
-        put_back_token(int_literal_token);
-        put_back_token(break_token);
-        return nullptr;
-    }
-
-    // If gotten this far, match was successful
+    lex::token* int_literal_token   = match_token(lex::tag_t::INT_LITERAL);
+    lex::token* semi_colon_token    = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    break_stmt_t* result = new break_stmt_t();
+    break_stmt_t* result = ast_arena.create<break_stmt_t>();
 
-    result->loop_id = static_cast<lex::int_literal_token*>(int_literal_token)->value;
+    result->loop_id = int_literal_token->value;
 
     // Store tokens
-    result->tokens.push_back(break_token);
-    result->tokens.push_back(int_literal_token);
-    result->tokens.push_back(semi_colon_token);
+    store_tokens(result, { break_token, int_literal_token, semi_colon_token });
 
     return result;
 }
 
+// stmt -> continue literal ;
 continue_stmt_t* parser_t::match_stmt_continue() {
 
     lex::token* continue_token      = get_token();
-    lex::token* int_literal_token   = get_token();
-    lex::token* semi_colon_token    = get_token();
-
-
-    if (continue_token->tag != lex::tag_t::CONTINUE || int_literal_token->tag != lex::tag_t::INT_LITERAL || semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        put_back_token(semi_colon_token);
-        put_back_token(int_literal_token);
-        put_back_token(continue_token);
-        return nullptr;
-    }
-
-    // If gotten this far, match was successful
+    lex::token* int_literal_token   = match_token(lex::tag_t::INT_LITERAL);
+    lex::token* semi_colon_token    = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    continue_stmt_t* result = new continue_stmt_t();
+    continue_stmt_t* result = ast_arena.create<continue_stmt_t>();
 
-    result->loop_id = static_cast<lex::int_literal_token*>(int_literal_token)->value;
+    result->loop_id = int_literal_token->value;
 
     // Store tokens
-    result->tokens.push_back(continue_token);
-    result->tokens.push_back(int_literal_token);
-    result->tokens.push_back(semi_colon_token);
+    store_tokens(result, { continue_token, int_literal_token, semi_colon_token });
 
     return result;
 }
@@ -1337,15 +902,7 @@ continue_stmt_t* parser_t::match_stmt_continue() {
 // stmt -> return expr ;
 return_stmt_t* parser_t::match_stmt_return() {
 
-    lex::token* return_token;
-    lex::token* semi_colon_token;
-
-    return_token = get_token();
-
-    if (return_token->tag != lex::tag_t::RETURN) {
-        put_back_token(return_token);
-        return nullptr;
-    }
+    lex::token* return_token = get_token();
     
     expr_t* return_value;
 
@@ -1353,148 +910,62 @@ return_stmt_t* parser_t::match_stmt_return() {
     try {
         return_value = match_expr();
     } catch (syntax_error e) {
-        put_back_token(return_token);
-        syntax_error::throw_error("Could not match expression for return statement. Unexpected " + lex::token_names[(int) peek()->tag] + " token ", peek());
-    }
-
-    semi_colon_token = get_token();
-
-    if (semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        
-        put_back_token(semi_colon_token);
-        return_value->undo(this);
-        put_back_token(return_token);
-
-        delete return_value;
-        return nullptr;
+        syntax_error::throw_error("Could not match expression for return statement. Unexpected " + lex::token_names[(int) return_token->tag] + " token ", return_token);
     }
 
-    // If gotten so far, match is successful
-
-
-    // Change associativity of expression if needed
-    return_value = binop_expr_t::rewrite(return_value);
-    
+    lex::token* semi_colon_token = match_token(lex::tag_t::SEMI_COLON);
     
     // Build syntax object
-    return_stmt_t* result = new return_stmt_t();
+    return_stmt_t* result = ast_arena.create<return_stmt_t>();
     result->return_value = return_value;
 
     // Store tokens
-    result->tokens.push_back(return_token);
-    result->tokens.push_back(semi_colon_token);
+    store_tokens(result, { return_token, semi_colon_token });
 
     return result;
 }
 
 // stmt -> expr ;
-expr_stmt_t* parser_t::match_stmt_expr() {
+// If the statement was started by an indexed term, it is given as first
+expr_stmt_t* parser_t::match_stmt_expr(term_t* first) {
 
-    lex::token* semi_colon_token;
+    expr_t* e;
 
-    expr_t* e = nullptr;
     try {
-        e = match_expr();
+        e = first ? match_expr_binop(first, 0) : match_expr();
     } catch (syntax_error e) {
-
-        // If could not match expression, return nullptr
-        return nullptr;
-    }
-
-    semi_colon_token = get_token();
-
-    if (semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        put_back_token(semi_colon_token);
-        e->undo(this);
-        delete e;
-        return nullptr;
+        throw_construct_error();
     }
 
-    // If gotten this far, match was successful
-    
-    // Change associativity of expression if needed
-    e = binop_expr_t::rewrite(e);
-    
+    lex::token* semi_colon_token = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    expr_stmt_t* result = new expr_stmt_t();
+    expr_stmt_t* result = ast_arena.create<expr_stmt_t>();
     result->e = e;
 
     // Save token
-    result->tokens.push_back(semi_colon_token);
-
-    return result;
-}
-
-// stmt -> var_decl ; 
-var_decl_t* parser_t::match_stmt_decl() {
-    
-    var_decl_t* result = match_decl_var();
+    store_tokens(result, { semi_colon_token });
 
-    // If could not match a variable declaration, return nullptr
-    if (result == nullptr) {
-        return nullptr;
-    }
     return result;
 }
 
 // stmt -> id "=" expr ;
 assignment_stmt_t* parser_t::match_stmt_assign() {
 
-    lex::token* id_token;
-    lex::token* assign_token;
-    lex::token* semi_colon_token;
-
-    id_token     = get_token();
-    assign_token = get_token();
-
-    // If first two tokens don't match, revert
-    if (id_token->tag != lex::tag_t::ID || assign_token->tag != lex::tag_t::ASSIGNMENT) {
-        put_back_token(assign_token);
-        put_back_token(id_token);
-        return nullptr;
-    }
-
-    // Acquire identifier from token
-    expr_t* rvalue;
-
-    try {
-        rvalue = match_expr();
-    } catch (syntax_error e) {
-        // If could not match expression, revert
-        
-        put_back_token(assign_token);
-        put_back_token(id_token);
-        return nullptr;
-    }
-
-    semi_colon_token = get_token();
-
-    if (semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        put_back_token(semi_colon_token);
-        rvalue->undo(this);
-        put_back_token(assign_token);
-        put_back_token(id_token);
-        delete rvalue;
-        return nullptr;
-    }
-    
-    // If gotten this far, match was successful
+    lex::token* id_token     = get_token();
+    lex::token* assign_token = get_token();
 
+    expr_t* rvalue = match_construct_expr();
 
-    // Change associativity of expression if needed
-    rvalue = binop_expr_t::rewrite(rvalue);
-    
+    lex::token* semi_colon_token = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    assignment_stmt_t* result = new assignment_stmt_t();
-    result->identifier = static_cast<lex::id_token*>(id_token)->lexeme;
+    assignment_stmt_t* result = ast_arena.create<assignment_stmt_t>();
+    result->identifier = id_token->value;
     result->rvalue = rvalue;
 
     // Store tokens
-    result->tokens.push_back(id_token);
-    result->tokens.push_back(assign_token);
-    result->tokens.push_back(semi_colon_token);
+    store_tokens(result, { id_token, assign_token, semi_colon_token });
     
     return result;
 }
@@ -1502,224 +973,83 @@ assignment_stmt_t* parser_t::match_stmt_assign() {
 // stmt -> "*" id "=" expr ;
 deref_assignment_stmt_t* parser_t::match_stmt_assign_deref() {
 
-    lex::token* star_token;
-    lex::token* id_token;
-    lex::token* assign_token;
-    lex::token* semi_colon_token;
-
-    star_token = get_token();
-    id_token   = get_token();
-    assign_token = get_token();
-
-
-    if (star_token->tag != lex::tag_t::STAR || id_token->tag != lex::tag_t::ID || assign_token->tag != lex::tag_t::ASSIGNMENT) {
-        put_back_token(assign_token);
-        put_back_token(id_token);
-        put_back_token(star_token);
-        return nullptr;
-    }
-
-    // Acquire identifier from token
-    expr_t* rvalue;
-
-    try {
-        rvalue = match_expr();
-    } catch (syntax_error e) {
-        // If could not match expression, revert
-        put_back_token(assign_token);
-        put_back_token(id_token);
-        put_back_token(star_token);
-        return nullptr;
-    }
-
-    semi_colon_token = get_token();
-
-    if (semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        put_back_token(semi_colon_token);
-        rvalue->undo(this);
-        put_back_token(assign_token);
-        put_back_token(id_token);
-        put_back_token(star_token);
-        delete rvalue;
-        return nullptr;
-    }
-    
-    // If gotten this far, match was successful
+    lex::token* star_token   = get_token();
+    lex::token* id_token     = get_token();
+    lex::token* assign_token = get_token();
 
+    expr_t* rvalue = match_construct_expr();
 
-    // Change associativity of expression if needed
-    rvalue = binop_expr_t::rewrite(rvalue);
-    
+    lex::token* semi_colon_token = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    deref_assignment_stmt_t* result = new deref_assignment_stmt_t();
-    result->identifier = static_cast<lex::id_token*>(id_token)->lexeme;
+    deref_assignment_stmt_t* result = ast_arena.create<deref_assignment_stmt_t>();
+    result->identifier = id_token->value;
     result->rvalue = rvalue;
 
     // Store tokens
-    result->tokens.push_back(star_token);
-    result->tokens.push_back(id_token);
-    result->tokens.push_back(assign_token);
-    result->tokens.push_back(semi_colon_token);
+    store_tokens(result, { star_token, id_token, assign_token, semi_colon_token });
     
     return result;
 }
 
 // stmt -> id [ expr ] "=" expr ;
-indexed_assignment_stmt_t* parser_t::match_stmt_assign_indexed() {
+//      |  expr ;
+// Both productions start with id [ expr ], the token after the closed bracket decides which one follows
+stmt_t* parser_t::match_stmt_indexed() {
 
-    lex::token* id_token;
-    lex::token* open_bracket_token;
-    lex::token* closed_bracket_token;
-    lex::token* assign_token;
-    lex::token* semi_colon_token;
-
-    id_token = get_token();
-    open_bracket_token = get_token();
-
-
-    if (id_token->tag != lex::tag_t::ID || open_bracket_token->tag != lex::tag_t::OPEN_BRACKET) {
-        put_back_token(open_bracket_token);
-        put_back_token(id_token);
-        return nullptr;
-    }
+    lex::token* id_token            = get_token();
+    lex::token* open_bracket_token  = get_token();
 
-    // Acquire index expr from token
-    expr_t* index;
+    expr_t* index = match_construct_expr();
 
-    try {
-        index = match_expr();
-    } catch (syntax_error e) {
-        // If could not match expression, revert
-        put_back_token(open_bracket_token);
-        put_back_token(id_token);
-        return nullptr;
-    }
+    lex::token* closed_bracket_token = match_token(lex::tag_t::CLOSED_BRACKET);
 
-    closed_bracket_token = get_token();
-    assign_token = get_token();
+    // If there is no assignment, the indexed term starts an expression statement
+    if (peek()->tag != lex::tag_t::ASSIGNMENT) {
 
-    if (closed_bracket_token->tag != lex::tag_t::CLOSED_BRACKET || assign_token->tag != lex::tag_t::ASSIGNMENT) {
-        
-        put_back_token(assign_token);
-        put_back_token(closed_bracket_token);
-        
-        index->undo(this);
-        delete index;
-        
-        put_back_token(open_bracket_token);
-        put_back_token(id_token);
-        return nullptr;
-    }
+        indexed_term_t* term = ast_arena.create<indexed_term_t>();
+        term->identifier = id_token->value;
+        term->index = index;
 
-    expr_t* rvalue;
+        store_tokens(term, { id_token, open_bracket_token, closed_bracket_token });
 
-    try {
-        rvalue = match_expr();
-    } catch (syntax_error e) {
-        // If could not match expression, revert
-        put_back_token(assign_token);
-        put_back_token(closed_bracket_token);
-        
-        index->undo(this);
-        delete index;
-        
-        put_back_token(open_bracket_token);
-        put_back_token(id_token);
-        return nullptr;
+        return match_stmt_expr(term);
     }
 
-    semi_colon_token = get_token();
-
-    if (semi_colon_token->tag != lex::tag_t::SEMI_COLON) {
-        
-        put_back_token(semi_colon_token);
-        rvalue->undo(this);
-        put_back_token(assign_token);
-        put_back_token(closed_bracket_token);
-        index->undo(this);
-        put_back_token(open_bracket_token);
-        put_back_token(id_token);
-        
-        delete index;
-        delete rvalue;
-        return nullptr;
-    }
-    
-    // If gotten this far, match was successful
+    lex::token* assign_token = get_token();
 
+    expr_t* rvalue = match_construct_expr();
 
-    // Change associativity of expression if needed
-    rvalue = binop_expr_t::rewrite(rvalue);
-    index = binop_expr_t::rewrite(index);
+    lex::token* semi_colon_token = match_token(lex::tag_t::SEMI_COLON);
 
     // Build syntax object
-    indexed_assignment_stmt_t* result = new indexed_assignment_stmt_t();
-    result->identifier = static_cast<lex::id_token*>(id_token)->lexeme;
+    indexed_assignment_stmt_t* result = ast_arena.create<indexed_assignment_stmt_t>();
+    result->identifier = id_token->value;
     result->rvalue = rvalue;
     result->index = index;
 
     // Store tokens
-    result->tokens.push_back(id_token);
-    result->tokens.push_back(open_bracket_token);
-    result->tokens.push_back(closed_bracket_token);
-    result->tokens.push_back(assign_token);
-    result->tokens.push_back(semi_colon_token);
-    return result;
-}
-
-// stmts -> stmt stmts
-stmts_t* parser_t::match_stmts_1() {
-
-    stmt_t* stmt = match_stmt();
-
-    // If matching a single statement fails, return nullptr
-    // A list of statements following this production must include at least one
-    if (stmt == nullptr) {
-        return nullptr;
-    }
-
-    stmts_t* result = new stmts_t();
-    result->first = stmt;
-
-    // Try matching more statements
-    result->rest = match_stmts();
-    
+    store_tokens(result, { id_token, open_bracket_token, closed_bracket_token, assign_token, semi_colon_token });
     return result;
 }
 
-// Maybe delete this function?
-// stmts -> e
-stmts_t* parser_t::match_stmts_2() {
-    return nullptr;
-}
-
 // expr -> "-" term
 neg_expr_t* parser_t::match_expr_negated() {
     
-    lex::token* neg_token  = get_token();
-
-    // If first token is not a minus operator, or the second token is not a literal nor an identifier, revert
-    if (neg_token->tag != lex::tag_t::MINUS ) {
-        put_back_token(neg_token);
-        return nullptr;
-    }
+    lex::token* neg_token = get_token();
 
     term_t* value = match_term();
     
     if (value == nullptr) {
-        put_back_token(neg_token);
-        return nullptr;
+        syntax_error::throw_error("Could not match expression. Unexpected " + lex::token_names[(int) neg_token->tag] + " token ", neg_token);
     }
 
-    // If gotten this far, match is successful
-
     // Create syntax object
-    neg_expr_t* result = new neg_expr_t();
+    neg_expr_t* result = ast_arena.create<neg_expr_t>();
     result->value = value;
 
     // Store token
-    result->tokens.push_back(neg_token);
+    store_tokens(result, { neg_token });
     
     return result;
 }
@@ -1727,95 +1057,35 @@ neg_expr_t* parser_t::match_expr_negated() {
 // expr -> "!" term
 not_expr_t* parser_t::match_expr_not() {
     
-    lex::token* not_token  = get_token();
-
-    // If first token is not a minus operator, or the second token is not a literal nor an identifier, revert
-    if (not_token->tag != lex::tag_t::NOT) {
-        put_back_token(not_token);
-        return nullptr;
-    }
+    lex::token* not_token = get_token();
 
     term_t* value = match_term();
     
     if (value == nullptr) {
-        put_back_token(not_token);
-        return nullptr;
+        syntax_error::throw_error("Could not match expression. Unexpected " + lex::token_names[(int) not_token->tag] + " token ", not_token);
     }
 
-    // If gotten this far, match is successful
-
     // Create syntax object
-    not_expr_t* result = new not_expr_t();
+    not_expr_t* result = ast_arena.create<not_expr_t>();
     result->value = value;
 
     // Store token
-    result->tokens.push_back(not_token);
+    store_tokens(result, { not_token });
     
     return result;
 }
 
-binop_expr_t* parser_t::match_expr_binop() {
-
-    term_t* left = match_term();
-
-    if (left == nullptr) {
-        return nullptr;
-    }
-
-    binop_expr_t* result = match_binop();
-
-    if (result == nullptr) {
-        left->undo(this);
-        delete left;
-        return nullptr;
-    }
-
-    expr_t* right = match_expr();
-    if (right == nullptr) {
-        
-        // Put back operator token
-        put_back_token(result->tokens.back());
-        result->tokens.pop_back();
-        
-        left->undo(this);
-        delete left;
-        delete result;
-        return nullptr;
-    }
-
-    // If gotten this far, match was successful
-
-    // Build syntax object 
-    result->term = left;
-    result->rest = right;
-
-    return result;
-}
-
-// expr -> term
-term_t* parser_t::match_expr_term() {
-    
-    return match_term();
-}
-
 // term -> id
 id_term_t* parser_t::match_term_identifier() {
     
     lex::token* id_token = get_token();
-
-    if (id_token->tag != lex::tag_t::ID) {
-        put_back_token(id_token);
-        return nullptr;
-    }
-    
-    // If gotten this far, match was successful
     
     // Build syntax object
-    id_term_t* result = new id_term_t();
-    result->identifier = static_cast<lex::id_token*>(id_token)->lexeme;
+    id_term_t* result = ast_arena.create<id_term_t>();
+    result->identifier = id_token->value;
     
     // Store token
-    result->tokens.push_back(id_token);
+    store_tokens(result, { id_token });
 
     return result;
 }
@@ -1825,19 +1095,12 @@ lit_term_t* parser_t::match_term_literal() {
     
     lex::token* literal_token = get_token();
 
-    if (literal_token->tag != lex::tag_t::INT_LITERAL) {
-        put_back_token(literal_token);
-        return nullptr;
-    }
-
-    // If gotten this far, match was successful
-    
     // Build syntax object
-    lit_term_t* result = new lit_term_t();
-    result->literal = static_cast<lex::int_literal_token*>(literal_token)->value;
+    lit_term_t* result = ast_arena.create<lit_term_t>();
+    result->literal = literal_token->value;
     
     // Store token
-    result->tokens.push_back(literal_token);
+    store_tokens(result, { literal_token });
 
     return result;
 }
@@ -1845,48 +1108,20 @@ lit_term_t* parser_t::match_term_literal() {
 // term -> id ( params )
 call_term_t* parser_t::match_term_call() {
 
-    lex::token* id_token;
-    lex::token* open_paren_token;
-    lex::token* closed_paren_token;
-
-    id_token = get_token();
-    open_paren_token = get_token();
-
-
-    if (id_token->tag != lex::tag_t::ID || open_paren_token->tag != lex::tag_t::OPEN_PAREN) {
-        put_back_token(open_paren_token);
-        put_back_token(id_token);
-        return nullptr;
-    }
+    lex::token* id_token            = get_token();
+    lex::token* open_paren_token    = get_token();
 
     params_t* params = match_params();
 
-    closed_paren_token = get_token();
-
-    if (closed_paren_token->tag != lex::tag_t::CLOSED_PAREN) {
-        put_back_token(closed_paren_token);
-
-        if (params != nullptr) {
-            params->undo(this);
-            delete params;
-        }
-
-        put_back_token(open_paren_token);
-        put_back_token(id_token);
-        return nullptr;
-    }
-
-    // If gotten this far, match was successful
+    lex::token* closed_paren_token = get_token();
 
     // Build syntax object
-    call_term_t* result = new call_term_t();
-    result->function_identifier = static_cast<lex::id_token*>(id_token)->lexeme;
+    call_term_t* result = ast_arena.create<call_term_t>();
+    result->function_identifier = id_token->value;
     result->params = params;
 
     // Store tokens
-    result->tokens.push_back(id_token);
-    result->tokens.push_back(open_paren_token);
-    result->tokens.push_back(closed_paren_token);
+    store_tokens(result, { id_token, open_paren_token, closed_paren_token });
 
     return result;
 }
@@ -1894,24 +1129,15 @@ call_term_t* parser_t::match_term_call() {
 // term -> & id
 addr_of_term_t* parser_t::match_term_addr_of() {
     
-    lex::token* ampersand_token = get_token();
-    lex::token* identifier_token = get_token();
-
-    if (ampersand_token->tag != lex::tag_t::AND || identifier_token->tag != lex::tag_t::ID) {
-        put_back_token(identifier_token);
-        put_back_token(ampersand_token);
-        return nullptr;
-    }
+    lex::token* ampersand_token     = get_token();
+    lex::token* identifier_token    = get_token();
 
-    // If gotten this far, match was successful
-    
     // Build syntax object
-    addr_of_term_t* result = new addr_of_term_t();
-    result->identifier = static_cast<lex::id_token*>(identifier_token)->lexeme;
+    addr_of_term_t* result = ast_arena.create<addr_of_term_t>();
+    result->identifier = identifier_token->value;
     
     // Store token
-    result->tokens.push_back(ampersand_token);
-    result->tokens.push_back(identifier_token);
+    store_tokens(result, { ampersand_token, identifier_token });
 
     return result;
 }
@@ -1919,24 +1145,15 @@ addr_of_term_t* parser_t::match_term_addr_of() {
 // term -> * id
 deref_term_t* parser_t::match_term_deref() {
     
-    lex::token* star_token = get_token();
-    lex::token* identifier_token = get_token();
-
-    if (star_token->tag != lex::tag_t::STAR || identifier_token->tag != lex::tag_t::ID) {
-        put_back_token(identifier_token);
-        put_back_token(star_token);
-        return nullptr;
-    }
+    lex::token* star_token          = get_token();
+    lex::token* identifier_token    = get_token();
 
-    // If gotten this far, match was successful
-    
     // Build syntax object
-    deref_term_t* result = new deref_term_t();
-    result->identifier = static_cast<lex::id_token*>(identifier_token)->lexeme;
+    deref_term_t* result = ast_arena.create<deref_term_t>();
+    result->identifier = identifier_token->value;
     
     // Store token
-    result->tokens.push_back(star_token);
-    result->tokens.push_back(identifier_token);
+    store_tokens(result, { star_token, identifier_token });
 
     return result;
 }
@@ -1944,101 +1161,44 @@ deref_term_t* parser_t::match_term_deref() {
 // term -> id [ expr ]
 indexed_term_t* parser_t::match_term_indexed() {
 
-    lex::token* identifier_token;
-    lex::token* open_bracket_token;
-    lex::token* closed_bracket_token;
-
-    identifier_token = get_token();
-    open_bracket_token = get_token();
-
-    if (identifier_token->tag != lex::tag_t::ID || open_bracket_token->tag != lex::tag_t::OPEN_BRACKET) {
-        put_back_token(open_bracket_token);
-        put_back_token(identifier_token);
-        return nullptr;
-    }
+    lex::token* identifier_token    = get_token();
+    lex::token* open_bracket_token  = get_token();
 
     expr_t* index = match_expr();
 
-    if (index == nullptr) {
-        put_back_token(open_bracket_token);
-        put_back_token(identifier_token);
-        return nullptr;
-    }
-
-    closed_bracket_token = get_token();
-    
-    if (closed_bracket_token->tag != lex::tag_t::CLOSED_BRACKET) {
-        put_back_token(closed_bracket_token);
-
-        index->undo(this);
-        delete index;
-
-        put_back_token(open_bracket_token);
-        put_back_token(identifier_token);
-        return nullptr;
-    }
-
-    // If gotten this far, match was successful
-
-    // Try rewriting associativity of expr
-    index = binop_expr_t::rewrite(index);
+    lex::token* closed_bracket_token = match_token(lex::tag_t::CLOSED_BRACKET);
 
     // Build syntax object
-    indexed_term_t* result = new indexed_term_t();
+    indexed_term_t* result = ast_arena.create<indexed_term_t>();
 
-    result->identifier = static_cast<lex::id_token*>(identifier_token)->lexeme;
+    result->identifier = identifier_token->value;
     result->index = index;
 
     // Store token
-    result->tokens.push_back(identifier_token);
-    result->tokens.push_back(open_bracket_token);
-    result->tokens.push_back(closed_bracket_token);
+    store_tokens(result, { identifier_token, open_bracket_token, closed_bracket_token });
 
     return result;
 }
 
-
 // term -> ( expr )
+// Returns nullptr if the parenthesis is not closed, which fails the enclosing expression
 expr_term_t* parser_t::match_term_expr() {
 
-    lex::token* open_paren_token;
-    lex::token* closed_paren_token;
-
-    open_paren_token = get_token();
-
-    if (open_paren_token->tag != lex::tag_t::OPEN_PAREN) {
-        put_back_token(open_paren_token);
-        return nullptr;
-    }
+    lex::token* open_paren_token = get_token();
 
     expr_t* expr = match_expr();
 
-    if (expr == nullptr) {
-        put_back_token(open_paren_token);
-        return nullptr;
-    }
-
-    closed_paren_token = get_token();
-
-    if (closed_paren_token->tag != lex::tag_t::CLOSED_PAREN) {
-        put_back_token(closed_paren_token);
-        expr->undo(this);
-        put_back_token(open_paren_token);
-        delete expr;
+    if (peek()->tag != lex::tag_t::CLOSED_PAREN) {
         return nullptr;
     }
 
-    // If gotten this far, match was successful
-    
-    // Try rewriting associativity of expr
-    expr = binop_expr_t::rewrite(expr);
+    lex::token* closed_paren_token = get_token();
 
     // Build syntax object
-    expr_term_t* result = new expr_term_t();
+    expr_term_t* result = ast_arena.create<expr_term_t>();
     result->expr = expr;
 
     // Store token
-    result->tokens.push_back(open_paren_token);
-    result->tokens.push_back(closed_paren_token);
+    store_tokens(result, { open_paren_token, closed_paren_token });
     return result;
-}
\ No newline at end of file
+}
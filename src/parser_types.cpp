@@ -8,865 +8,385 @@
 #include "../include/helper_functions.h"
 #include "../include/error_handling.h"
 
-#include <stack>
 #include <iostream>
 #include <vector>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+#include <unordered_set>
 
-void program_t::undo(parser_t* p) {
-    decls->undo(p);
-    delete decls;
+// -----------------------------------------------------
+// Statements and expressions are dispatched on their kind to the function of the node type, which hides the one in the base
+
+std::string stmt_t::get_string(parser_t* p) {
+
+    switch (kind) {
+        case NODE_FUNC_DECL: return static_cast<func_decl_t*>(this)->get_string(p);
+        case NODE_VAR_DECL: return static_cast<var_decl_t*>(this)->get_string(p);
+        case NODE_SIMPLE_ARRAY_DECL: return static_cast<simple_array_decl_t*>(this)->get_string(p);
+        case NODE_INIT_LIST_ARRAY_DECL: return static_cast<init_list_array_decl_t*>(this)->get_string(p);
+        case NODE_STR_ARRAY_DECL: return static_cast<str_array_decl_t*>(this)->get_string(p);
+        case NODE_BLOCK_STMT: return static_cast<block_stmt_t*>(this)->get_string(p);
+        case NODE_IF_STMT: return static_cast<if_stmt_t*>(this)->get_string(p);
+        case NODE_WHILE_STMT: return static_cast<while_stmt_t*>(this)->get_string(p);
+        case NODE_ASM_STMT: return static_cast<asm_stmt_t*>(this)->get_string(p);
+        case NODE_BREAK_STMT: return static_cast<break_stmt_t*>(this)->get_string(p);
+        case NODE_CONTINUE_STMT: return static_cast<continue_stmt_t*>(this)->get_string(p);
+        case NODE_ASSIGNMENT_STMT: return static_cast<assignment_stmt_t*>(this)->get_string(p);
+        case NODE_DEREF_ASSIGNMENT_STMT: return static_cast<deref_assignment_stmt_t*>(this)->get_string(p);
+        case NODE_INDEXED_ASSIGNMENT_STMT: return static_cast<indexed_assignment_stmt_t*>(this)->get_string(p);
+        case NODE_RETURN_STMT: return static_cast<return_stmt_t*>(this)->get_string(p);
+        case NODE_EXPR_STMT: return static_cast<expr_stmt_t*>(this)->get_string(p);
+        default: throw std::logic_error("Unknown stmt kind " + std::to_string(kind));
+    }
+}
+
+int stmt_t::translate(translator_t* t) {
+
+    t->reg_alloc.set_position(position);
+
+    // Variables whose address is taken may be read or written through a pointer by this statement
+    t->reg_alloc.release_address_taken();
+
+    switch (kind) {
+        case NODE_FUNC_DECL: return static_cast<func_decl_t*>(this)->translate(t);
+        case NODE_VAR_DECL: return static_cast<var_decl_t*>(this)->translate(t);
+        case NODE_SIMPLE_ARRAY_DECL: return static_cast<simple_array_decl_t*>(this)->translate(t);
+        case NODE_INIT_LIST_ARRAY_DECL: return static_cast<init_list_array_decl_t*>(this)->translate(t);
+        case NODE_STR_ARRAY_DECL: return static_cast<str_array_decl_t*>(this)->translate(t);
+        case NODE_BLOCK_STMT: return static_cast<block_stmt_t*>(this)->translate(t);
+        case NODE_IF_STMT: return static_cast<if_stmt_t*>(this)->translate(t);
+        case NODE_WHILE_STMT: return static_cast<while_stmt_t*>(this)->translate(t);
+        case NODE_ASM_STMT: return static_cast<asm_stmt_t*>(this)->translate(t);
+        case NODE_BREAK_STMT: return static_cast<break_stmt_t*>(this)->translate(t);
+        case NODE_CONTINUE_STMT: return static_cast<continue_stmt_t*>(this)->translate(t);
+        case NODE_ASSIGNMENT_STMT: return static_cast<assignment_stmt_t*>(this)->translate(t);
+        case NODE_DEREF_ASSIGNMENT_STMT: return static_cast<deref_assignment_stmt_t*>(this)->translate(t);
+        case NODE_INDEXED_ASSIGNMENT_STMT: return static_cast<indexed_assignment_stmt_t*>(this)->translate(t);
+        case NODE_RETURN_STMT: return static_cast<return_stmt_t*>(this)->translate(t);
+        case NODE_EXPR_STMT: return static_cast<expr_stmt_t*>(this)->translate(t);
+        default: throw std::logic_error("Unknown stmt kind " + std::to_string(kind));
+    }
+}
+
+std::string expr_t::get_string(parser_t* p) {
+
+    switch (kind) {
+        case NODE_NEG_EXPR: return static_cast<neg_expr_t*>(this)->get_string(p);
+        case NODE_NOT_EXPR: return static_cast<not_expr_t*>(this)->get_string(p);
+        case NODE_TERM_EXPR: return static_cast<term_expr_t*>(this)->get_string(p);
+        case NODE_ID_TERM: return static_cast<id_term_t*>(this)->get_string(p);
+        case NODE_CALL_TERM: return static_cast<call_term_t*>(this)->get_string(p);
+        case NODE_EXPR_TERM: return static_cast<expr_term_t*>(this)->get_string(p);
+        case NODE_ADDR_OF_TERM: return static_cast<addr_of_term_t*>(this)->get_string(p);
+        case NODE_DEREF_TERM: return static_cast<deref_term_t*>(this)->get_string(p);
+        case NODE_INDEXED_TERM: return static_cast<indexed_term_t*>(this)->get_string(p);
+        case NODE_LIT_TERM: return static_cast<lit_term_t*>(this)->get_string(p);
+        case NODE_ADD_BINOP: return static_cast<add_binop_t*>(this)->get_string(p);
+        case NODE_SUB_BINOP: return static_cast<sub_binop_t*>(this)->get_string(p);
+        case NODE_MULT_BINOP: return static_cast<mult_binop_t*>(this)->get_string(p);
+        case NODE_SHIFT_LEFT_BINOP: return static_cast<shift_left_binop_t*>(this)->get_string(p);
+        case NODE_SHIFT_RIGHT_BINOP: return static_cast<shift_right_binop_t*>(this)->get_string(p);
+        case NODE_AND_BINOP: return static_cast<and_binop_t*>(this)->get_string(p);
+        case NODE_OR_BINOP: return static_cast<or_binop_t*>(this)->get_string(p);
+        case NODE_LOGICAL_AND_BINOP: return static_cast<logical_and_binop_t*>(this)->get_string(p);
+        case NODE_LOGICAL_OR_BINOP: return static_cast<logical_or_binop_t*>(this)->get_string(p);
+        case NODE_EQ_BINOP: return static_cast<eq_binop_t*>(this)->get_string(p);
+        case NODE_NEQ_BINOP: return static_cast<neq_binop_t*>(this)->get_string(p);
+        case NODE_LESS_BINOP: return static_cast<less_binop_t*>(this)->get_string(p);
+        case NODE_GREATER_BINOP: return static_cast<greater_binop_t*>(this)->get_string(p);
+        case NODE_LESS_EQ_BINOP: return static_cast<less_eq_binop_t*>(this)->get_string(p);
+        case NODE_GREATER_EQ_BINOP: return static_cast<greater_eq_binop_t*>(this)->get_string(p);
+        default: throw std::logic_error("Unknown expr kind " + std::to_string(kind));
+    }
+}
+
+int expr_t::translate(translator_t* t) {
+
+    switch (kind) {
+        case NODE_NEG_EXPR: return static_cast<neg_expr_t*>(this)->translate(t);
+        case NODE_NOT_EXPR: return static_cast<not_expr_t*>(this)->translate(t);
+        case NODE_TERM_EXPR: return static_cast<term_expr_t*>(this)->translate(t);
+        case NODE_ID_TERM: return static_cast<id_term_t*>(this)->translate(t);
+        case NODE_CALL_TERM: return static_cast<call_term_t*>(this)->translate(t);
+        case NODE_EXPR_TERM: return static_cast<expr_term_t*>(this)->translate(t);
+        case NODE_ADDR_OF_TERM: return static_cast<addr_of_term_t*>(this)->translate(t);
+        case NODE_DEREF_TERM: return static_cast<deref_term_t*>(this)->translate(t);
+        case NODE_INDEXED_TERM: return static_cast<indexed_term_t*>(this)->translate(t);
+        case NODE_LIT_TERM: return static_cast<lit_term_t*>(this)->translate(t);
+        case NODE_ADD_BINOP: return static_cast<add_binop_t*>(this)->translate(t);
+        case NODE_SUB_BINOP: return static_cast<sub_binop_t*>(this)->translate(t);
+        case NODE_MULT_BINOP: return static_cast<mult_binop_t*>(this)->translate(t);
+        case NODE_SHIFT_LEFT_BINOP: return static_cast<shift_left_binop_t*>(this)->translate(t);
+        case NODE_SHIFT_RIGHT_BINOP: return static_cast<shift_right_binop_t*>(this)->translate(t);
+        case NODE_AND_BINOP: return static_cast<and_binop_t*>(this)->translate(t);
+        case NODE_OR_BINOP: return static_cast<or_binop_t*>(this)->translate(t);
+        case NODE_LOGICAL_AND_BINOP: return static_cast<logical_and_binop_t*>(this)->translate(t);
+        case NODE_LOGICAL_OR_BINOP: return static_cast<logical_or_binop_t*>(this)->translate(t);
+        case NODE_EQ_BINOP: return static_cast<eq_binop_t*>(this)->translate(t);
+        case NODE_NEQ_BINOP: return static_cast<neq_binop_t*>(this)->translate(t);
+        case NODE_LESS_BINOP: return static_cast<less_binop_t*>(this)->translate(t);
+        case NODE_GREATER_BINOP: return static_cast<greater_binop_t*>(this)->translate(t);
+        case NODE_LESS_EQ_BINOP: return static_cast<less_eq_binop_t*>(this)->translate(t);
+        case NODE_GREATER_EQ_BINOP: return static_cast<greater_eq_binop_t*>(this)->translate(t);
+        default: throw std::logic_error("Unknown expr kind " + std::to_string(kind));
+    }
+}
+
+bool expr_t::evaluate(int* result) {
+
+    switch (kind) {
+        case NODE_NEG_EXPR: return static_cast<neg_expr_t*>(this)->evaluate(result);
+        case NODE_NOT_EXPR: return static_cast<not_expr_t*>(this)->evaluate(result);
+        case NODE_TERM_EXPR: return static_cast<term_expr_t*>(this)->evaluate(result);
+        case NODE_ID_TERM: return static_cast<id_term_t*>(this)->evaluate(result);
+        case NODE_CALL_TERM: return static_cast<call_term_t*>(this)->evaluate(result);
+        case NODE_EXPR_TERM: return static_cast<expr_term_t*>(this)->evaluate(result);
+        case NODE_ADDR_OF_TERM: return static_cast<addr_of_term_t*>(this)->evaluate(result);
+        case NODE_DEREF_TERM: return static_cast<deref_term_t*>(this)->evaluate(result);
+        case NODE_INDEXED_TERM: return static_cast<indexed_term_t*>(this)->evaluate(result);
+        case NODE_LIT_TERM: return static_cast<lit_term_t*>(this)->evaluate(result);
+        case NODE_ADD_BINOP: return static_cast<add_binop_t*>(this)->evaluate(result);
+        case NODE_SUB_BINOP: return static_cast<sub_binop_t*>(this)->evaluate(result);
+        case NODE_MULT_BINOP: return static_cast<mult_binop_t*>(this)->evaluate(result);
+        case NODE_SHIFT_LEFT_BINOP: return static_cast<shift_left_binop_t*>(this)->evaluate(result);
+        case NODE_SHIFT_RIGHT_BINOP: return static_cast<shift_right_binop_t*>(this)->evaluate(result);
+        case NODE_AND_BINOP: return static_cast<and_binop_t*>(this)->evaluate(result);
+        case NODE_OR_BINOP: return static_cast<or_binop_t*>(this)->evaluate(result);
+        case NODE_LOGICAL_AND_BINOP: return static_cast<logical_and_binop_t*>(this)->evaluate(result);
+        case NODE_LOGICAL_OR_BINOP: return static_cast<logical_or_binop_t*>(this)->evaluate(result);
+        case NODE_EQ_BINOP: return static_cast<eq_binop_t*>(this)->evaluate(result);
+        case NODE_NEQ_BINOP: return static_cast<neq_binop_t*>(this)->evaluate(result);
+        case NODE_LESS_BINOP: return static_cast<less_binop_t*>(this)->evaluate(result);
+        case NODE_GREATER_BINOP: return static_cast<greater_binop_t*>(this)->evaluate(result);
+        case NODE_LESS_EQ_BINOP: return static_cast<less_eq_binop_t*>(this)->evaluate(result);
+        case NODE_GREATER_EQ_BINOP: return static_cast<greater_eq_binop_t*>(this)->evaluate(result);
+        default: throw std::logic_error("Unknown expr kind " + std::to_string(kind));
+    }
 }
 
+// -----------------------------------------------------
+
 std::string program_t::get_string(parser_t* p) {
     return "(program){ " + decls->get_string(p) + " }";
 }
 
-void decls_t::undo(parser_t* p) {
-    
-    if (rest != nullptr) {
-        rest->undo(p);
-        delete rest;
-    }
-
-    first->undo(p);
-    delete first;
-}
-
 std::string decls_t::get_string(parser_t* p) {
     
-    std::string result = first->get_string(p);
-    if (rest != nullptr) result += " " + rest->get_string(p);
+    std::string result = items[0]->get_string(p);
+    for (int i = 1; i < count; i++) result += " " + items[i]->get_string(p);
     return result;
 }
 
-void var_decl_t::undo(parser_t* p) {
-
-    // If last token is a semi colon, put it back
-    if (tokens.back()->tag == lex::tag_t::SEMI_COLON) {
-        p->put_back_token(tokens.back());
-        tokens.pop_back();
-    }
-
-    if (value != nullptr) {
-
-        value->undo(p);
-        delete value;
-
-        // Put back assignment token
-        p->put_back_token(tokens.back());
-        tokens.pop_back();
-    }
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    if (is_pointer) {
-        // Put back * token
-        p->put_back_token(tokens.back());
-        tokens.pop_back();
-    }
-
-    // Put back type token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-}
-
-void simple_array_decl_t::undo(parser_t* p) {
-
-    // Put back ; token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back ] token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    size->undo(p);
-    delete size;
-
-    // Put back [ token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back type token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string simple_array_decl_t::get_string(parser_t* p) {
-    return "(array_decl)[ type: " + p->get_type_name(type) + " id: " + identifier + " ]";
+    return "(array_decl)[ type: " + p->get_type_name(type) + " id: " + symbol_name(identifier) + " ]";
 }
 
 
-void init_list_array_decl_t::undo(parser_t* p) {
-
-    // Put back ; token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back } token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    init_list->undo(p);
-    delete init_list;
-
-    // Put back { token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back = token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back ] token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back [ token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back type token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string init_list_array_decl_t::get_string(parser_t* p) {
-    return "(array_decl)[ type: " + p->get_type_name(type) + " id: " + identifier + " ]{ " + init_list->get_string(p) + " }";
+    return "(array_decl)[ type: " + p->get_type_name(type) + " id: " + symbol_name(identifier) + " ]{ " + init_list->get_string(p) + " }";
 }
 
 
-void str_array_decl_t::undo(parser_t* p) {
-
-    // Put back ; token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back str_lit token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back = token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back ] token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back [ token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back type "char" token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string str_array_decl_t::get_string(parser_t* p) {
-    return "(array_decl)[ type: " + p->get_type_name(type) + " id: " + identifier + "]{ " + string_literal + " }";
+    return "(array_decl)[ type: " + p->get_type_name(type) + " id: " + symbol_name(identifier) + "]{ " + std::string(string_literal) + " }";
 }
 
 std::string var_decl_t::get_string(parser_t* p) {
     std::string ptr_str = (is_pointer) ? "* " : "";
 
-    return "(var_decl)[ " + p->get_type_name(type) + " " + ptr_str + id + " ]" +
+    return "(var_decl)[ " + p->get_type_name(type) + " " + ptr_str + symbol_name(id) + " ]" +
         ((value != nullptr) ? "{ " + value->get_string(p) + " }" : "");
 }
 
-void func_decl_t::undo(parser_t* p) {
-    
-    if (stmt != nullptr) {
-        stmt->undo(p);
-        delete stmt;
-    } else {
-        // Put back ; token
-        p->put_back_token(tokens.back());
-        tokens.pop_back();
-    }
-
-    // Put back ) token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // If the declaration has parameters, undo them
-    if (param_list != nullptr) {
-        param_list->undo(p);
-        delete param_list;
-    }
-
-    // Put back ( token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back type token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-}
-
 std::string func_decl_t::get_string(parser_t* p) {
 
     std::string stmt_string   = (stmt != nullptr) ? stmt->get_string(p) : "";
     std::string params_string = (param_list != nullptr) ? (" params: " + param_list->get_string(p)) : "";
 
-    return "(function)[type: " + p->get_type_name(type) + " id: " + id + params_string + "]{" + stmt_string + "}";
-}
-
-void param_decls_t::undo(parser_t* p) {
-
-    if (rest != nullptr) {
-        rest->undo(p);
-        delete rest;
-    }
-
-    first->undo(p);
-    delete first;
+    return "(function)[type: " + p->get_type_name(type) + " id: " + symbol_name(id) + params_string + "]{" + stmt_string + "}";
 }
 
 std::string param_decls_t::get_string(parser_t* p) {
-    std::string result = first->get_string(p);
-    if (rest != nullptr) result += " " + rest->get_string(p);
+    std::string result = items[0]->get_string(p);
+    for (int i = 1; i < count; i++) result += " " + items[i]->get_string(p);
     return result;
 }
 
-void asm_params_t::undo(parser_t* p) {
-
-    if (rest != nullptr) {
-        rest->undo(p);
-        delete rest;
-    }
-
-    first->undo(p);
-    delete first;
-}
-
-void init_list_t::undo(parser_t* p) {
-
-    if (rest != nullptr) {
-        rest->undo(p);
-        delete rest;
-    }
-
-    first->undo(p);
-    delete first;
-}
-
 std::string init_list_t::get_string(parser_t* p) {
-    std::string result = first->get_string(p);
-    if (rest != nullptr) result += " " + rest->get_string(p);
+    std::string result = items[0]->get_string(p);
+    for (int i = 1; i < count; i++) result += " " + items[i]->get_string(p);
     return result;
 }
 
 std::string asm_params_t::get_string(parser_t* p) {
-    std::string result = first->get_string(p);
-    if (rest != nullptr) result += " " + rest->get_string(p);
+    std::string result = items[0]->get_string(p);
+    for (int i = 1; i < count; i++) result += " " + items[i]->get_string(p);
     return result;
 }
 
-void param_decl_t::undo(parser_t* p) {
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    if (is_pointer) {
-        // Put back * token
-        p->put_back_token(tokens.back());
-        tokens.pop_back();
-    }
-
-    // Put back type token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string param_decl_t::get_string(parser_t* p) {
     std::string ptr_str = (is_pointer) ? "* " : "";
-    return p->get_type_name(type) + " " + ptr_str + id;
-}
-
-void params_t::undo(parser_t* p) {
-
-    if (rest != nullptr) {
-        rest->undo(p);
-        delete rest;
-    }
-
-    first->undo(p);
-    delete first;
+    return p->get_type_name(type) + " " + ptr_str + symbol_name(id);
 }
 
 std::string params_t::get_string(parser_t* p) {
-    std::string result = first->get_string(p);
-    if (rest != nullptr) result += " " + rest->get_string(p);
+    std::string result = items[0]->get_string(p);
+    for (int i = 1; i < count; i++) result += " " + items[i]->get_string(p);
     return result;
 }
 
-void stmts_t::undo(parser_t* p) {
-
-    if (rest != nullptr) {
-        rest->undo(p);
-        delete rest;
-    }
-
-    first->undo(p);
-    delete first;
-}
-
 std::string stmts_t::get_string(parser_t* p) {
-    std::string result = first->get_string(p);
-    if (rest != nullptr) result += " " + rest->get_string(p);
+    std::string result = items[0]->get_string(p);
+    for (int i = 1; i < count; i++) result += " " + items[i]->get_string(p);
     return result;
 }
 
-void block_stmt_t::undo(parser_t* p) {
-    
-    // Put back } token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    if (statements != nullptr) {
-        statements->undo(p);
-        delete statements;
-    }
-
-    // Put back { token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string block_stmt_t::get_string(parser_t* p) {
     return "{ " + ((statements != nullptr) ? statements->get_string(p) : " ") + " }";
 }
 
-void if_stmt_t::undo(parser_t* p) {
-
-    // If there was an else statement
-    if (else_actions != nullptr) {
-        else_actions->undo(p);
-        delete else_actions;
-
-        // Put back else token
-        p->put_back_token(tokens.back());
-        tokens.pop_back();
-    }
-    
-    if (actions != nullptr) {
-        actions->undo(p);
-        delete actions;
-    }
-
-    // Put back ) token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    cond->undo(p);
-    delete cond;
-
-    // Put back ( token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back if token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string if_stmt_t::get_string(parser_t* p) {
     std::string else_str = (else_actions) ? " (else){ " + else_actions->get_string(p) + " }" : "";
     return "(if)[ cond{ " + cond->get_string(p) + " } ]{ " + actions->get_string(p) + " }" + else_str;
 }
 
-void while_stmt_t::undo(parser_t* p) {
-    
-    if (actions != nullptr) {
-        actions->undo(p);
-        delete actions;
-    }
-
-    // Put back ) token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    cond->undo(p);
-    delete cond;
-
-    // Put back ( token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back if token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string while_stmt_t::get_string(parser_t* p) {
     return "(while)[ cond{ " + cond->get_string(p) + " } ]{ " + actions->get_string(p) + " }";
 }
 
-void asm_stmt_t::undo(parser_t* p) {
-    
-    // Put back ) token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    params->undo(p);
-    delete params;
-
-    // Put back string literal token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();    
-
-    // Put back ( token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back asm token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string asm_stmt_t::get_string(parser_t* p) {
-    return "(asm){ " + literal + " " + params->get_string(p) + " }";
-}
-
-void break_stmt_t::undo(parser_t* p) {
-    
-    // Put back ; token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back int literal token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();    
-
-    // Put back break token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
+    return "(asm){ " + std::string(literal) + " " + params->get_string(p) + " }";
 }
 
 std::string break_stmt_t::get_string(parser_t* p) {
     return "break(" + std::to_string(loop_id) + ")";
 }
 
-void continue_stmt_t::undo(parser_t* p) {
-    
-    // Put back ; token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back int literal token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();    
-
-    // Put back continue token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string continue_stmt_t::get_string(parser_t* p) {
     return "continue(" + std::to_string(loop_id) + ")";
 }
 
-void assignment_stmt_t::undo(parser_t* p) {
-    
-    // Put back ; token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    rvalue->undo(p);
-    delete rvalue;
-
-    // Put back = token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string assignment_stmt_t::get_string(parser_t* p) {
-    return "(assign)[ " + identifier + " value( " + rvalue->get_string(p) + " )]";
-}
-
-void deref_assignment_stmt_t::undo(parser_t* p) {
-    
-    // Put back ; token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    rvalue->undo(p);
-    delete rvalue;
-
-    // Put back = token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back(); 
-
-    // Put back * token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
+    return "(assign)[ " + symbol_name(identifier) + " value( " + rvalue->get_string(p) + " )]";
 }
 
 std::string deref_assignment_stmt_t::get_string(parser_t* p) {
-    return "(assign)[ *" + identifier + " value( " + rvalue->get_string(p) + " )]";
-}
-
-void indexed_assignment_stmt_t::undo(parser_t* p) {
-    
-    // Put back ; token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    rvalue->undo(p);
-    delete rvalue;
-
-    // Put back = token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back ] token
-    p->put_back_token(tokens.back());
-    tokens.pop_back(); 
-
-    index->undo(p);
-    delete index;
-
-    // Put back [ token
-    p->put_back_token(tokens.back());
-    tokens.pop_back(); 
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back(); 
-
+    return "(assign)[ *" + symbol_name(identifier) + " value( " + rvalue->get_string(p) + " )]";
 }
 
 std::string indexed_assignment_stmt_t::get_string(parser_t* p) {
-    return "(assign)[ " + identifier + " [ " + index->get_string(p) + " ] value( " + rvalue->get_string(p) + " )]";
-}
-
-void return_stmt_t::undo(parser_t* p) {
-
-    // Put back ; token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    return_value->undo(p);
-    delete return_value;
-
-    // Put back return token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
+    return "(assign)[ " + symbol_name(identifier) + " [ " + index->get_string(p) + " ] value( " + rvalue->get_string(p) + " )]";
 }
 
 std::string return_stmt_t::get_string(parser_t* p) {
     return "(return)[ " + return_value->get_string(p) + " ]";
 }
 
-void expr_stmt_t::undo(parser_t* p) {
-    
-    // Put ; return token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    e->undo(p);
-    delete e;
-}
-
 std::string expr_stmt_t::get_string(parser_t* p) {
     return "(expr)[ " + e->get_string(p) + " ]";
 }
 
-void neg_expr_t::undo(parser_t* p) {
-    
-    value->undo(p);
-    delete value;
-    
-    // Put back - token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string neg_expr_t::get_string(parser_t* p) {
     return "- " + value->get_string(p);
 }
 
-void not_expr_t::undo(parser_t* p) {
-    
-    value->undo(p);
-    delete value;
-    
-    // Put back ! token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string not_expr_t::get_string(parser_t* p) {
     return "!" + value->get_string(p);
 }
 
-void deref_term_t::undo(parser_t* p) {
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();    
-    
-    // Put back * token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-}
-
 std::string deref_term_t::get_string(parser_t* p) {
-    return "*" + identifier;
-}
-
-void indexed_term_t::undo(parser_t* p) {
-
-    // Put back ] token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();    
-    
-    index->undo(p);
-    delete index;
-
-    // Put back [ token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();   
-
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
+    return "*" + symbol_name(identifier);
 }
 
 std::string indexed_term_t::get_string(parser_t* p) {
-    return identifier + "[ " + index->get_string(p) + " ]";
-}
-
-void term_expr_t::undo(parser_t* p) {
-    
-    t->undo(p);
-    delete t;
-
+    return symbol_name(identifier) + "[ " + index->get_string(p) + " ]";
 }
 
 std::string term_expr_t::get_string(parser_t* p) {
     return t->get_string(p);
 }
 
-void term_t::undo(parser_t* p) {
-    
-    // Put back id or literal token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-}
-
 std::string id_term_t::get_string(parser_t* p) {
-    return identifier;
+    return symbol_name(identifier);
 }
 
 std::string lit_term_t::get_string(parser_t* p) {
     return std::to_string(literal);
 }
 
-void call_term_t::undo(parser_t* p) {
-    
-    // Put back ) token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // If parameters are given, return them
-    if (params != nullptr) {
-        params->undo(p);
-        delete params;
-    }
-
-    // Put back ( token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-    
-    // Put back id token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-    
-}
-
 std::string call_term_t::get_string(parser_t* p) {
     std::string params_string = (params != nullptr) ? params->get_string(p) : "";
-    return function_identifier + "(" + params_string + ")";
-}
-
-void expr_term_t::undo(parser_t* p) {
-    
-    // Put back ) token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // put back expression
-    expr->undo(p);
-    delete expr;
-
-    // Put back ( token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-    
+    return symbol_name(function_identifier) + "(" + params_string + ")";
 }
 
 std::string expr_term_t::get_string(parser_t* p) {
     return "(" + expr->get_string(p) + ")";
 }
 
-void addr_of_term_t::undo(parser_t* p) {
-    
-    // Put back identifier token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back & token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-    
-}
-
 std::string addr_of_term_t::get_string(parser_t* p) {
-    return "( *" + identifier + ")";
+    return "( *" + symbol_name(identifier) + ")";
 }
 
 
-void binop_expr_t::undo(parser_t* p) {
-
-    // Put back the rest of the expression
-
-    if (left_assoc) {
-        term->undo(p);
-    } else {
-        rest->undo(p);
-    }
-
-    // Put back operator token
-    p->put_back_token(tokens.back());
-    tokens.pop_back();
-
-    // Put back term
-    if (left_assoc) {
-        rest->undo(p);
-    } else {
-        term->undo(p);
-    }
-
-}
-
 std::string add_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") + " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " + (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") + (" + right->get_string(p) + ")";
 }
 
 std::string sub_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") - " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " - (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") - (" + right->get_string(p) + ")";
 }
 
 std::string and_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") & " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " & (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") & (" + right->get_string(p) + ")";
 }
 
 std::string or_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") | " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " | (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") | (" + right->get_string(p) + ")";
+}
+
+std::string logical_and_binop_t::get_string(parser_t* p) {
+    return "(" + left->get_string(p) + ") && (" + right->get_string(p) + ")";
+}
+
+std::string logical_or_binop_t::get_string(parser_t* p) {
+    return "(" + left->get_string(p) + ") || (" + right->get_string(p) + ")";
 }
 
 std::string mult_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") * " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " * (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") * (" + right->get_string(p) + ")";
+}
+
+std::string shift_left_binop_t::get_string(parser_t* p) {
+    return "(" + left->get_string(p) + ") << (" + right->get_string(p) + ")";
+}
+
+std::string shift_right_binop_t::get_string(parser_t* p) {
+    return "(" + left->get_string(p) + ") >> (" + right->get_string(p) + ")";
 }
 
 std::string eq_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") == " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " == (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") == (" + right->get_string(p) + ")";
 }
 
 std::string neq_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") != " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " != (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") != (" + right->get_string(p) + ")";
 }
 
 std::string less_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") < " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " < (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") < (" + right->get_string(p) + ")";
 }
 
 std::string greater_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") > " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " > (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") > (" + right->get_string(p) + ")";
 }
 
 std::string less_eq_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") <= " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " <= (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") <= (" + right->get_string(p) + ")";
 }
 
 std::string greater_eq_binop_t::get_string(parser_t* p) {
-    if (left_assoc) {
-        return "(" + rest->get_string(p) + ") >= " + term->get_string(p);
-    } else {
-        return term->get_string(p) + " >= (" + rest->get_string(p) + ")";
-    }
+    return "(" + left->get_string(p) + ") >= (" + right->get_string(p) + ")";
 }
 
 // -------------------- EVALUATION ---------------------
@@ -913,7 +433,11 @@ bool call_term_t::evaluate(int* result) {
 }
 
 bool id_term_t::evaluate(int* result) {
-    return false;
+
+    if (!is_constant) return false;
+
+    *result = constant;
+    return true;
 }
 
 bool addr_of_term_t::evaluate(int* result) {
@@ -930,392 +454,229 @@ bool expr_term_t::evaluate(int* result) {
 }
 
 bool add_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+    int left_val;
+    int right_val;
 
     bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
     if (!success) return false;
 
-    *result = rest_val + term_val;
+    *result = left_val + right_val;
     return true;
 }
 
 bool sub_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+    int left_val;
+    int right_val;
 
     bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
     if (!success) return false;
 
-    *result = rest_val - term_val;
+    *result = left_val - right_val;
     return true;
 }
 
 bool and_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+    int left_val;
+    int right_val;
 
     bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
     if (!success) return false;
 
-    *result = rest_val & term_val;
+    *result = left_val & right_val;
     return true;
 }
 
 bool or_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+    int left_val;
+    int right_val;
 
     bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
     if (!success) return false;
 
-    *result = rest_val | term_val;
+    *result = left_val | right_val;
     return true;
 }
 
-bool mult_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+bool logical_and_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
-    bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    if (!left->evaluate(&left_val)) return false;
 
-    if (!success) return false;
+    // A false left operand decides the result without the right one
+    if (!left_val) {
+        *result = 0;
+        return true;
+    }
+
+    if (!right->evaluate(&right_val)) return false;
 
-    *result = rest_val * term_val;
+    *result = right_val != 0;
     return true;
 }
 
-bool eq_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+bool logical_or_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
-    bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    if (!left->evaluate(&left_val)) return false;
 
-    if (!success) return false;
+    // A true left operand decides the result without the right one
+    if (left_val) {
+        *result = 1;
+        return true;
+    }
 
-    *result = rest_val == term_val;
+    if (!right->evaluate(&right_val)) return false;
+
+    *result = right_val != 0;
     return true;
 }
 
-bool neq_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+bool mult_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
     bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
     if (!success) return false;
 
-    *result = rest_val != term_val;
+    *result = left_val * right_val;
     return true;
 }
 
-bool less_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+bool shift_left_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
     bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
-    if (!success) return false;
+    // Shifts by a negative number or by the width of the register are left to the hardware
+    if (!success || right_val < 0 || right_val >= 32) return false;
 
-    *result = rest_val < term_val;
+    *result = (int)((unsigned int)left_val << right_val);
     return true;
 }
 
-bool greater_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+bool shift_right_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
     bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
-    if (!success) return false;
+    if (!success || right_val < 0 || right_val >= 32) return false;
 
-    *result = rest_val > term_val;
+    *result = left_val >> right_val;
     return true;
 }
 
-bool less_eq_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+bool eq_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
     bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
     if (!success) return false;
 
-    *result = rest_val <= term_val;
+    *result = left_val == right_val;
     return true;
 }
 
-bool greater_eq_binop_t::evaluate(int* result) {
-    // Assumes left associativity
-    int rest_val;
-    int term_val;
+bool neq_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
     bool success;
-    success = rest->evaluate(&rest_val) && term->evaluate(&term_val);
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
     if (!success) return false;
 
-    *result = rest_val >= term_val;
+    *result = left_val != right_val;
     return true;
 }
 
-// ------------------ BINOP REWRITING ------------------
-//
-// -----------------------------------------------------
-
+bool less_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
-add_binop_t* add_binop_t::duplicate() {
-    
-    add_binop_t* result = new add_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
-}
+    bool success;
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
-sub_binop_t* sub_binop_t::duplicate() {
-    
-    sub_binop_t* result = new sub_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
-}
+    if (!success) return false;
 
-mult_binop_t* mult_binop_t::duplicate() {
-    
-    mult_binop_t* result = new mult_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
+    *result = left_val < right_val;
+    return true;
 }
 
-and_binop_t* and_binop_t::duplicate() {
-    
-    and_binop_t* result = new and_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
-}
+bool greater_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
-or_binop_t* or_binop_t::duplicate() {
-    
-    or_binop_t* result = new or_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
-}
+    bool success;
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
-eq_binop_t* eq_binop_t::duplicate() {
-        
-    eq_binop_t* result = new eq_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
-}
+    if (!success) return false;
 
-neq_binop_t* neq_binop_t::duplicate() {
-        
-    neq_binop_t* result = new neq_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
+    *result = left_val > right_val;
+    return true;
 }
 
-less_binop_t* less_binop_t::duplicate() {
-        
-    less_binop_t* result = new less_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
-}
+bool less_eq_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
-greater_binop_t* greater_binop_t::duplicate() {
-        
-    greater_binop_t* result = new greater_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
-}
+    bool success;
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
-less_eq_binop_t* less_eq_binop_t::duplicate() {
-        
-    less_eq_binop_t* result = new less_eq_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
-}
+    if (!success) return false;
 
-greater_eq_binop_t* greater_eq_binop_t::duplicate() {
-        
-    greater_eq_binop_t* result = new greater_eq_binop_t();
-    
-    // Give ownership of the operator token
-    result->tokens.push_back(tokens.back());
-    tokens.pop_back();
-    
-    return result;
+    *result = left_val <= right_val;
+    return true;
 }
 
-expr_t* binop_expr_t::rewrite(expr_t* e) {
-    
-    binop_expr_t* starting_root = dynamic_cast<binop_expr_t*>(e);
-
-    // If given expression is not a binary operation, return
-    if (starting_root == nullptr) return e;
-
-    // If the given binop tree is already left associative, return
-    if (starting_root->left_assoc) return e;
-
-    std::stack<binop_expr_t*> op_stack{};
-    op_stack.push(starting_root);
-
-
-    // Build up the stack
-    int i = 0;
-    while (true) {
-        i++;
-        binop_expr_t* current = op_stack.top();
-        binop_expr_t* rest = dynamic_cast<binop_expr_t*>(current->rest);
-
-        // If cannot cast to binary operation, we have reached the bottom
-        if (rest == nullptr) break;
-
-        op_stack.push(rest);
-    }
-
-    // Set up variables that will be used
-
-    // The root of the resulting tree
-    binop_expr_t* new_tree = nullptr;
-
-    // The current binop in the new tree
-    binop_expr_t* current = nullptr;
-
-    // The previous binop in the new tree, the parent of current
-    binop_expr_t* previous_new = nullptr;
-
-    // The previous binop in the old tree
-    binop_expr_t* previous_old = nullptr;
-
-    while (!op_stack.empty()) {
-        
-        // If this is the first node in the new tree
-        if (new_tree == nullptr) {
-
-            // Duplicate the node, set the term to the term of the old node
-            // and set associativity to left
-            new_tree = op_stack.top()->duplicate();
-
-            new_tree->term = op_stack.top()->rest;
-            new_tree->left_assoc = true;
-            current = new_tree;
-            previous_old = op_stack.top();
-            op_stack.pop();
-            continue;
-        }
-
-        // Get a new operation from the stack and duplicate it
-        previous_new = current;
-        current = op_stack.top()->duplicate();
-        
-        // Set the associativity of new node to left, and it's term to the term of the previous operation from the old tree
-        current->left_assoc = true;
-
-        // If the rest was a tree within parenthesis, rewrite it
-        expr_term_t* term_tree = dynamic_cast<expr_term_t*>(previous_old->term);
-        if (term_tree != nullptr) {
-            term_tree->expr = rewrite(term_tree->expr);
-        }
-        
-        current->term = previous_old->term;
-
+bool greater_eq_binop_t::evaluate(int* result) {
+    int left_val;
+    int right_val;
 
-        // Set the rest of the previous node from the new tree to this node
-        previous_new->rest = current;
+    bool success;
+    success = left->evaluate(&left_val) && right->evaluate(&right_val);
 
-        // Delete the previous node from the old tree and update it's value
-        delete previous_old;
-        previous_old = op_stack.top();
-        op_stack.pop();
-    }
+    if (!success) return false;
 
-    // When the stack has been emptied set the rest of the current node in the new tree
-    // to the term of the term of the last old node
-    current->left_assoc = true;
-    current->rest = previous_old->term;
-    delete previous_old;
-    return new_tree;
+    *result = left_val >= right_val;
+    return true;
 }
 
-
 // -------------------- TRANSLATION --------------------
 //
 // -----------------------------------------------------
 
 int program_t::translate(translator_t* t) {
 
+    // Functions whose calls are all inlined are left out by the dead code elimination
+    if (t->options.inlining) t->inliner.run(this);
+    if (t->options.dead_code_elimination) t->dead_code.run(this);
+
     decls->translate(t);
 
+    return 0;
 }
 
 int decls_t::translate(translator_t* t) {
     
-    first->translate(t);
-
-    if (rest != nullptr) rest->translate(t);
+    for (decl_t* decl : *this) decl->translate(t);
 
     return 0;
 }
@@ -1331,13 +692,13 @@ int func_decl_t::translate(translator_t* t) {
         // If the existing function with the same name as this have the same signature
         if ((*potential_old_function) != (*current_function)) {
             delete current_function;
-            translation_error::throw_error("Mismatching declarations of function \"" + id + "\"", this);
+            translation_error::throw_error("Mismatching declarations of function \"" + symbol_name(id) + "\"", this);
         }
         
         // If it is defined and this is also a definition we have multiple definitions
         if (potential_old_function->defined && stmt != nullptr) {
             delete current_function;
-            translation_error::throw_error("Multiple definiton of function \"" + id + "\"", this);
+            translation_error::throw_error("Multiple definiton of function \"" + symbol_name(id) + "\"", this);
         }
         
         // If it is only declared
@@ -1358,7 +719,14 @@ int func_decl_t::translate(translator_t* t) {
 
     current_function->defined = true;
 
-    print_label(t, current_function->identifier);
+    if (t->options.constant_propagation) t->constant_propagation.run(this, &t->type_table);
+    if (t->options.unrolling) t->unroller.run(this, &t->type_table, t->options.unroll_factor);
+    if (t->options.loop_invariant_motion) t->loop_invariants.run(this, &t->symbol_table, &t->type_table);
+
+    t->liveness.analyze(this);
+    if (t->options.graph_coloring) t->coloring.color(t->liveness);
+
+    print_label(t, symbol_name(current_function->identifier));
 
     move_instr(t, BASE_POINTER, STACK_POINTER);
 
@@ -1367,7 +735,7 @@ int func_decl_t::translate(translator_t* t) {
     if (param_list != nullptr) {
         // Starts at 2 to accomodate for return address pointer
         current_function->params_size = 2;
-        param_list->translate(t, current_function, 0);
+        param_list->translate(t, current_function);
     }
     
     stmt->translate(t);
@@ -1377,43 +745,87 @@ int func_decl_t::translate(translator_t* t) {
     
     // Set return register to 0 and print ret instruction
     if (!t->last_was_ret) {
+
+        // Pop the parameters passed in registers
+        int scope_size = t->symbol_table.get_current_scope()->get_end_offset();
+        if (scope_size != 0) addi_instr(t, STACK_POINTER, STACK_POINTER, scope_size);
+
         move_instr(t, RETURN_REGISTER, NULL_REGISTER);
         ret_instr(t);
     }
 
     t->symbol_table.pop_scope();
+    t->reg_alloc.set_position(0);
+    t->coloring.clear();
 
-    t->print_instruction_row("", false, false);
+    // The registers of main belong to the startup code, which does not need them
+    bool is_main = id == get_interner().intern("main");
+    current_function->frameless = t->build_frame(!is_main);
+
+    // Functions never called are still translated so their errors are reported
+    if (used) t->end_function();
+    else t->discard_function();
+
+    return 0;
 }
 
-int param_decls_t::translate(translator_t* t, func_info_t* f, int param_index) {
+int param_decls_t::translate(translator_t* t, func_info_t* f) {
     
-    first->translate(t, f, param_index);
-    if (rest != nullptr) {
-        
-        rest->translate(t, f, param_index + 1);
+    int register_params_size = 0;
+    for (int param_index = 0; param_index < count; param_index++) {
+        register_params_size += items[param_index]->translate(t, f, param_index);
+    }
 
-    } else {
-        // remove return pointer offset from params_size
-        f->params_size -= 2;
+    // Allocate memory for the parameters passed in registers
+    if (register_params_size != 0) subi_instr(t, STACK_POINTER, STACK_POINTER, register_params_size);
 
-        /*
-        // If this is the last param, align the stack to 4
-        if (f->params_size % 4 != 0) {
-                f->params_size += 4 - f->params_size % 4;
-        }*/
+    // remove return pointer offset from params_size
+    f->params_size -= 2;
 
-    }
+    /*
+    // If this is the last param, align the stack to 4
+    if (f->params_size % 4 != 0) {
+            f->params_size += 4 - f->params_size % 4;
+    }*/
     
+    return 0;
 }
 
 int param_decl_t::translate(translator_t* t, func_info_t* f, int param_index) {
 
     // If a parameter with that name already exists
     if (t->symbol_table.get_current_scope()->at(id)) {
-        translation_error::throw_error("Multiple declaration of parameter \"" + id + "\"", this);
+        translation_error::throw_error("Multiple declaration of parameter \"" + symbol_name(id) + "\"", this);
     }
     
+    // A parameter passed in a register is stored below the base pointer, like a local variable, if it
+    // does not stay in the register
+    if (param_index < REGISTER_PARAM_COUNT) {
+
+        scope_t* current_scope = t->symbol_table.get_current_scope();
+        int size = (is_pointer) ? POINTER_SIZE : t->type_table.at(type)->size;
+
+        int alignment = 0;
+        int size_to_allocate = 2;
+
+        if (size > 2) {
+            alignment = current_scope->align(4);
+            size_to_allocate = (size % 4 == 0) ? size : size + (4 - size % 4);
+        }
+
+        local_addr_info_t* addr = new local_addr_info_t(-(current_scope->get_end_offset() + size_to_allocate));
+
+        var_info_t* var = t->symbol_table.add_var(id, type, size_to_allocate, addr);
+        var->is_pointer = is_pointer;
+        var->range = t->liveness.range_of(this);
+
+        // The value arrives in the register and has not been stored yet
+        t->reg_alloc.give_ownership(param_index, var);
+        t->reg_alloc.touch(param_index, true);
+
+        return alignment + size_to_allocate;
+    }
+
     var_info_t* param_info = &f->param_vector[param_index];
     
     // Create address structure for parameter
@@ -1425,34 +837,87 @@ int param_decl_t::translate(translator_t* t, func_info_t* f, int param_index) {
     // want to add the variables to the namespace
     var_info_t* var = t->symbol_table.add_var(id, type, 0, addr);
     var->is_pointer = is_pointer;
-    
-    // Allocate a register for the variable and load it
-    t->reg_alloc.allocate(var, true, false);
+    var->range = t->liveness.range_of(this);
+
+    // The parameter is loaded into a register when it is first used
+    return 0;
 }
 
-int params_t::translate(translator_t* t, func_info_t* func, int param_index) {
+int params_t::translate(translator_t* t, func_info_t* func) {
 
-    if (func->param_vector.size() <= param_index) {
-        translation_error::throw_error("Too many arguments in function call", first);
+    if ((int) func->param_vector.size() < count) {
+        translation_error::throw_error("Too many arguments in function call", items[func->param_vector.size()]);
     }
 
-    if (rest == nullptr && param_index < func->param_vector.size() - 1) {
-        translation_error::throw_error("Too few arguments in function call", first);
+    if (count < (int) func->param_vector.size()) {
+        translation_error::throw_error("Too few arguments in function call", back());
     }
     
-    
-    // Push params backwards
-    if (rest != nullptr) rest->translate(t, func, param_index + 1);
+    // Push params backwards, those passed in registers are evaluated last
+    for (int param_index = count - 1; param_index >= REGISTER_PARAM_COUNT; param_index--) {
+        translate_param(t, func, items[param_index], param_index);
+    }
 
-    std::stringstream output;
-    int first_value = 0;
-    bool first_evaluated = first->evaluate(&first_value);
+    return -1;
+}
+
+void params_t::translate_registers(translator_t* t, std::vector<int>& registers) {
+
+    int register_count = std::min(count, REGISTER_PARAM_COUNT);
+    registers.assign(register_count, -1);
+
+    // Local variables no call can change are read after the other arguments, constants are left to the caller
+    std::vector<int> deferred;
+
+    for (int param_index = register_count - 1; param_index >= 0; param_index--) {
+
+        expr_t* param = items[param_index];
+
+        int param_value = 0;
+        if (param->evaluate(&param_value)) continue;
+
+        if (param->kind == NODE_ID_TERM) {
+            var_info_t* var = t->symbol_table.get_var(static_cast<id_term_t*>(param)->identifier);
+
+            if (!var->is_array && var->range != nullptr && !var->range->address_taken) {
+                deferred.push_back(param_index);
+                continue;
+            }
+        }
+
+        // A call changes the registers, the arguments evaluated before it wait on the stack
+        std::vector<std::pair<int, var_info_t*>> pushed;
+        for (int i = param_index + 1; i < register_count && contains_call(param); i++) {
+            if (registers[i] != -1) pushed.push_back({i, push_temp(t, registers[i])});
+        }
+
+        registers[param_index] = take_ownership_or_allocate(t, "__param__", param->translate(t));
+
+        for (int i = pushed.size() - 1; i >= 0; i--) registers[pushed[i].first] = pop_temp(t, pushed[i].second);
+    }
+
+    for (int param_index : deferred) registers[param_index] = items[param_index]->translate(t);
+
+    // A variable at its last use does not have to be stored, its register becomes a temporary
+    for (int param_index : deferred) {
+
+        var_info_t* var = t->reg_alloc.get_content(registers[param_index]);
+        if (var != nullptr && !var->is_temp && t->reg_alloc.is_last_use(var)) {
+            registers[param_index] = take_ownership_or_allocate(t, "__param__", registers[param_index]);
+        }
+    }
+}
+
+int params_t::translate_param(translator_t* t, func_info_t* func, expr_t* param, int param_index) {
 
-    if (first_evaluated) {
+    int param_value = 0;
+    bool param_evaluated = param->evaluate(&param_value);
+
+    if (param_evaluated) {
         
         // Add temporary variable to scope to allow register allocation
         var_info_t* var;
-        int reg = allocate_temp_imm(t, "__param__", first_value, &var);
+        int reg = allocate_temp_imm(t, "__param__", param_value, &var);
 
         int alignment = func->get_alignment(param_index);
 
@@ -1470,7 +935,7 @@ int params_t::translate(translator_t* t, func_info_t* func, int param_index) {
 
     } else {
 
-        int reg = first->translate(t);
+        int reg = param->translate(t);
 
         int alignment = func->get_alignment(param_index);
 
@@ -1489,20 +954,20 @@ int params_t::translate(translator_t* t, func_info_t* func, int param_index) {
 }
 
 int asm_params_t::translate(translator_t*) {
-    
-} 
+    return 0;
+}
 
 int var_decl_t::translate(translator_t* t) {
     
     if (t->symbol_table.is_global_scope()) {
         
         if (t->symbol_table.get_current_scope()->at(id)) {
-            translation_error::throw_error("Multiple declaration of global symbol \"" + id + "\"", this);
+            translation_error::throw_error("Multiple declaration of global symbol \"" + symbol_name(id) + "\"", this);
         }
 
         type_descriptor_t* type_desc = t->type_table.at(type);
         
-        global_addr_info_t* addr = new global_addr_info_t(id);
+        global_addr_info_t* addr = new global_addr_info_t(symbol_name(id));
 
         // Size is zero since the variable is allocated statically
         var_info_t* var = t->symbol_table.add_var(id, type, 0, addr);
@@ -1512,7 +977,7 @@ int var_decl_t::translate(translator_t* t) {
 
         // Global variable
         if (value == nullptr) {
-            t->static_alloc(id, size, 0);
+            if (used) t->static_alloc(symbol_name(id), size, 0);
             return 0;    
         };
 
@@ -1520,12 +985,12 @@ int var_decl_t::translate(translator_t* t) {
         bool evaluated = value->evaluate(&constant_value);
 
         if (evaluated) {
-            t->static_alloc(id, size, constant_value);
+            if (used) t->static_alloc(symbol_name(id), size, constant_value);
             return 0;
         }
 
         // Allocate space for the variable
-        t->static_alloc(id, size, 0);
+        t->static_alloc(symbol_name(id), size, 0);
 
         t->set_data_mode(true);
 
@@ -1561,7 +1026,7 @@ int var_decl_t::translate(translator_t* t) {
         // Local variable
 
         if (t->symbol_table.get_current_scope()->at(id)) {
-            translation_error::throw_error("Multiple definition of local symbol \"" + id + "\"", this);
+            translation_error::throw_error("Multiple definition of local symbol \"" + symbol_name(id) + "\"", this);
         }
 
         // Try to evaluate the expression
@@ -1599,6 +1064,7 @@ int var_decl_t::translate(translator_t* t) {
         local_addr_info_t* addr = new local_addr_info_t(variable_base_offset);
         var_info_t* var = t->symbol_table.add_var(id, type, size_to_allocate, addr);
         var->is_pointer = is_pointer;
+        var->range = t->liveness.range_of(this);
 
         // Allocate memory for the variable
         subi_instr(t, STACK_POINTER, STACK_POINTER, alignment + size_to_allocate);
@@ -1626,6 +1092,9 @@ int var_decl_t::translate(translator_t* t) {
                 // If it was another register give ownership of the register to the new variable
                 } else {
 
+                    // A variable that is not read after this statement does not need to be stored
+                    if (is_dying_variable(t, value, var)) t->reg_alloc.free(t->symbol_table.get_var(static_cast<id_term_t*>(value)->identifier), false);
+
                     var_info_t* temp_info = t->reg_alloc.give_ownership(value_reg, var);
                     t->reg_alloc.touch(value_reg, true);
                     
@@ -1638,6 +1107,8 @@ int var_decl_t::translate(translator_t* t) {
             }
         } 
     }
+
+    return 0;
 }
 
 int simple_array_decl_t::translate(translator_t* t) {
@@ -1655,23 +1126,23 @@ int simple_array_decl_t::translate(translator_t* t) {
     if (t->symbol_table.is_global_scope()) {
         
         if (t->symbol_table.get_current_scope()->at(identifier)) {
-            translation_error::throw_error("Multiple definition of global symbol \"" + identifier + "\"", this);
+            translation_error::throw_error("Multiple definition of global symbol \"" + symbol_name(identifier) + "\"", this);
         }
 
-        global_addr_info_t* addr = new global_addr_info_t(identifier);
+        global_addr_info_t* addr = new global_addr_info_t(symbol_name(identifier));
 
         // Size is zero since the variable is allocated statically
         var_info_t* var = t->symbol_table.add_var(identifier, type, 0, addr);
         var->is_pointer = true;
         var->is_array = true;
 
-        t->static_alloc_array(identifier, element_size, array_size);
+        if (used) t->static_alloc_array(symbol_name(identifier), element_size, array_size);
 
     } else {
         
         // Local variable
         if (t->symbol_table.get_current_scope()->at(identifier)) {
-            translation_error::throw_error("Multiple definition of local symbol \"" + identifier + "\"", this);
+            translation_error::throw_error("Multiple definition of local symbol \"" + symbol_name(identifier) + "\"", this);
         }
 
         scope_t* current_scope = t->symbol_table.get_current_scope();
@@ -1693,11 +1164,14 @@ int simple_array_decl_t::translate(translator_t* t) {
         var_info_t* var = t->symbol_table.add_var(identifier, type, 0, addr);
         var->is_pointer = true;
         var->is_array = true;
+        var->range = t->liveness.range_of(this);
 
         int total_stack_size = pre_alignment + element_size * array_size + post_alignment;
         subi_instr(t, STACK_POINTER, STACK_POINTER, total_stack_size);
     
     }
+
+    return 0;
 }
 
 int init_list_array_decl_t::translate(translator_t* t) {
@@ -1714,17 +1188,17 @@ int init_list_array_decl_t::translate(translator_t* t) {
     if (t->symbol_table.is_global_scope()) {
         
         if (t->symbol_table.get_current_scope()->at(identifier)) {
-            translation_error::throw_error("Multiple definition of global symbol \"" + identifier + "\"", this);
+            translation_error::throw_error("Multiple definition of global symbol \"" + symbol_name(identifier) + "\"", this);
         }
 
-        global_addr_info_t* addr = new global_addr_info_t(identifier);
+        global_addr_info_t* addr = new global_addr_info_t(symbol_name(identifier));
 
         // Size is zero since the variable is allocated statically
         var_info_t* var = t->symbol_table.add_var(identifier, type, 0, addr);
         var->is_pointer = true;
         var->is_array = true;
 
-        t->static_alloc_array_init(identifier, element_size, values);
+        if (used) t->static_alloc_array_init(symbol_name(identifier), element_size, values);
     
     } else {
 
@@ -1761,38 +1235,39 @@ int init_list_array_decl_t::translate(translator_t* t) {
         var_info_t* var = t->symbol_table.add_var(identifier, type, 0, addr);
         var->is_pointer = true;
         var->is_array = true;
+        var->range = t->liveness.range_of(this);
 
     }
+
+    return 0;
 }
 
 int str_array_decl_t::translate(translator_t* t) {
 
     if (t->type_table.at(type)->name != "char") {
-        translation_error::throw_error("Allocating string literal to an array with type other than char. Symbol: \"" + identifier + "\"", this);
+        translation_error::throw_error("Allocating string literal to an array with type other than char. Symbol: \"" + symbol_name(identifier) + "\"", this);
     }
     
     type_descriptor_t* type_desc = t->type_table.at(type);
     int element_size = type_desc->size;
 
-    str_lit_to_str(string_literal, string_literal);
-    
-    // -2 for quotation marks and +1 for null character
-    int array_size = string_literal.size() - 2 + 1;
+    std::string str;
+    str_lit_to_str(std::string(string_literal), str);
     
     if (t->symbol_table.is_global_scope()) {
         
         if (t->symbol_table.get_current_scope()->at(identifier)) {
-            translation_error::throw_error("Multiple definition of global symbol \"" + identifier + "\"", this);
+            translation_error::throw_error("Multiple definition of global symbol \"" + symbol_name(identifier) + "\"", this);
         }
 
-        global_addr_info_t* addr = new global_addr_info_t(identifier);
+        global_addr_info_t* addr = new global_addr_info_t(symbol_name(identifier));
 
         // Size is zero since the variable is allocated statically
         var_info_t* var = t->symbol_table.add_var(identifier, type, 0, addr);
         var->is_pointer = true;
         var->is_array = true;
 
-        t->static_alloc_array_str(identifier, string_literal);
+        if (used) t->static_alloc_array_str(symbol_name(identifier), str);
 
     } else {
 
@@ -1806,9 +1281,9 @@ int str_array_decl_t::translate(translator_t* t) {
         load_immediate(t, reg, 0);
         push_instr(t, reg, element_size);
 
-        for (int i = string_literal.size() - 2; i >= 1; i--) {
+        for (int i = str.size() - 2; i >= 1; i--) {
 
-            load_immediate(t, reg, string_literal[i]);
+            load_immediate(t, reg, str[i]);
             push_instr(t, reg, element_size);
 
         }
@@ -1827,15 +1302,17 @@ int str_array_decl_t::translate(translator_t* t) {
         var_info_t* var = t->symbol_table.add_var(identifier, type, 0, addr);
         var->is_pointer = true;
         var->is_array = true;
+        var->range = t->liveness.range_of(this);
     }
+
+    return 0;
 }
 
 int stmts_t::translate(translator_t* t) {
     
-    first->translate(t);
-
-    if (rest != nullptr) rest->translate(t);
+    for (stmt_t* stmt : *this) stmt->translate(t);
 
+    return 0;
 }
 
 int block_stmt_t::translate(translator_t* t) {
@@ -1856,6 +1333,8 @@ int block_stmt_t::translate(translator_t* t) {
     t->reg_alloc.free_scope(t->symbol_table.get_current_scope());
     
     t->symbol_table.pop_scope();
+
+    return -1;
 }
 
 int if_stmt_t::translate(translator_t* t) {
@@ -1877,85 +1356,125 @@ int if_stmt_t::translate(translator_t* t) {
 
     } else {
 
-        int cond_reg = cond->translate(t);
         std::string else_label = t->label_allocator.get_label_name();
         std::string end_label = t->label_allocator.get_label_name();
 
-        t->reg_alloc.store_context();
-        
-        // Test if true or false
-        cmpi_instr(t, cond_reg, 0);
-
-        branch_instr(t, BREQ_INSTR, else_label);
+        // Registers stay as they are on both paths, they only have to agree again at the end
+        register_state_t before = translate_condition(t, cond, else_label);
 
         actions->translate(t);
 
-        t->reg_alloc.store_context();
+        // Keep what both the if and the else path start with, the else path reconciles to it as well
+        register_state_t after = t->reg_alloc.join_state(before, t->reg_alloc.get_state());
+        t->reg_alloc.reconcile(after);
         
-        branch_instr(t, JMP_INSTR, end_label);
+        branch_instr(t, IR_JMP, end_label);
 
         print_label(t, else_label);
 
+        t->reg_alloc.set_state(before);
+
         if (else_actions != nullptr) else_actions->translate(t);
 
-        t->reg_alloc.store_context();
+        t->reg_alloc.reconcile(after);
 
         print_label(t, end_label);
     }
-}
 
-int while_stmt_t::translate(translator_t* t) {
+    return -1;
+}
 
-    int constant_value = 0;
-    bool cond_evaluated = cond->evaluate(&constant_value);
+// Loads the variables used most in the loop while registers are free, so they stay in registers through it
+static void preload_loop_variables(translator_t* t, while_stmt_t* loop) {
 
-    if (cond_evaluated) {
-        
-        if (!constant_value) return -1;
+    for (symbol_t name : t->liveness.variables_of(loop)) {
 
-        std::string start_label = t->label_allocator.get_label_name();
-        std::string end_label   = t->label_allocator.get_label_name();
+        var_info_t* var = t->symbol_table.get_var(name);
+        if (var == nullptr || var->is_array) continue;
+        if (var->range == nullptr || var->range->address_taken) continue;
 
-        t->loop_info.push_back((loop_info_t){start_label, end_label});
+        if (!t->reg_alloc.preload(var, SCRATCH_COUNT)) break;
+    }
+}
 
-        t->reg_alloc.store_context();
+// Adds the names the statement assigns or declares to assigned, returns false if it has inline assembly,
+// which may write any register
+static bool find_assigned(stmt_t* stmt, std::unordered_set<symbol_t>& assigned) {
 
-        print_label(t, start_label);
+    switch (stmt->kind) {
+        case NODE_BLOCK_STMT: {
+            block_stmt_t* block = static_cast<block_stmt_t*>(stmt);
+            bool result = true;
+            if (block->statements != nullptr) {
+                for (stmt_t* s : *block->statements) result &= find_assigned(s, assigned);
+            }
+            return result;
+        }
+        case NODE_IF_STMT: {
+            if_stmt_t* if_stmt = static_cast<if_stmt_t*>(stmt);
+            bool result = find_assigned(if_stmt->actions, assigned);
+            if (if_stmt->else_actions != nullptr) result &= find_assigned(if_stmt->else_actions, assigned);
+            return result;
+        }
+        case NODE_WHILE_STMT:
+            return find_assigned(static_cast<while_stmt_t*>(stmt)->actions, assigned);
+        case NODE_ASSIGNMENT_STMT:
+            assigned.insert(static_cast<assignment_stmt_t*>(stmt)->identifier);
+            return true;
+        case NODE_VAR_DECL:
+            assigned.insert(static_cast<var_decl_t*>(stmt)->id);
+            return true;
+        case NODE_ASM_STMT:
+            return false;
+        default:
+            return true;
+    }
+}
 
-        actions->translate(t);
+int while_stmt_t::translate(translator_t* t) {
 
-        t->reg_alloc.store_context();
+    int constant_value = 0;
+    bool cond_evaluated = cond->evaluate(&constant_value);
 
-        branch_instr(t, JMP_INSTR, start_label);
+    if (cond_evaluated && !constant_value) return -1;
 
-        print_label(t, end_label);
+    std::string start_label = t->label_allocator.get_label_name();
+    std::string end_label   = t->label_allocator.get_label_name();
 
-    } else {
+    // The registers at the start of the loop are kept through it, every path back to the start reconciles to them
+    t->reg_alloc.free_temporaries();
+    preload_loop_variables(t, this);
 
-        std::string start_label = t->label_allocator.get_label_name();
-        std::string end_label   = t->label_allocator.get_label_name();
+    // Only the variables the loop assigns can differ from memory at the back edge
+    std::unordered_set<symbol_t> assigned;
+    bool known = find_assigned(actions, assigned);
 
-        t->loop_info.push_back((loop_info_t){start_label, end_label});
+    register_state_t start_state = t->reg_alloc.loop_state(known ? &assigned : nullptr);
+    t->reg_alloc.reconcile(start_state);
 
-        t->reg_alloc.store_context();
+    int stack_offset = t->symbol_table.get_current_scope()->get_end_offset();
+    t->loop_info.push_back((loop_info_t){start_label, end_label, stack_offset, start_state, start_state});
 
-        print_label(t, start_label);
+    print_label(t, start_label);
 
-        int cond_reg = cond->translate(t);
+    if (!cond_evaluated) {
 
-        cmpi_instr(t, cond_reg, 0);
+        // Breaks leave the loop with the registers the condition exits with
+        t->loop_info.back().end_state = translate_condition(t, cond, end_label);
+    }
 
-        branch_instr(t, BREQ_INSTR, end_label);
+    actions->translate(t);
 
-        actions->translate(t);
+    t->reg_alloc.reconcile(t->loop_info.back().start_state);
 
-        t->reg_alloc.store_context();
+    branch_instr(t, IR_JMP, start_label);
 
-        branch_instr(t, JMP_INSTR, start_label);
+    print_label(t, end_label);
 
-        print_label(t, end_label);
+    t->reg_alloc.set_state(t->loop_info.back().end_state);
+    t->loop_info.pop_back();
 
-    }
+    return -1;
 }
 
 int asm_stmt_t::translate(translator_t* t) {
@@ -1963,19 +1482,17 @@ int asm_stmt_t::translate(translator_t* t) {
     std::vector<term_t*> param_vector;
     std::vector<int> temp_registers;
 
-    asm_params_t* current = params;
-    while (current != nullptr) {
-        param_vector.push_back(dynamic_cast<term_t*>(current->first));
-        current = current->rest;
+    for (term_t* param : *params) {
+        param_vector.push_back(param);
     }
 
     int first_reg = -1;
-    std::string result = literal; 
+    std::string result(literal); 
     for (term_t* term : param_vector) {
         
         int reg;
         // If the current parameter is a literal, load it into a register
-        if (dynamic_cast<lit_term_t*>(term)) {
+        if (term->kind == NODE_LIT_TERM) {
             
             var_info_t* var;
             int value = 0;
@@ -1999,41 +1516,57 @@ int asm_stmt_t::translate(translator_t* t) {
 
     t->reg_alloc.touch(first_reg, true);
 
-    t->print_instruction_row(result, true, false);
+    ir_instr_t instr(IR_ASM);
+    instr.symbol = result;
+    t->emit(instr);
     
     // Free temporary registers
     for (int reg : temp_registers) {
         if (reg == first_reg) translation_error::throw_error("First operand of inline asm should not be a temporary value", this);
         t->reg_alloc.free(reg);
     }
+
+    return -1;
 }
 
 int break_stmt_t::translate(translator_t* t) {
 
-    if (loop_id >= t->loop_info.size()) {
+    if (loop_id >= (int) t->loop_info.size()) {
         translation_error::throw_error("Break loop index " + std::to_string(loop_id) + " has no corresponding loop", this);
     }
 
     int index = t->loop_info.size() - 1 - loop_id;
     std::string end_label = t->loop_info[index].end_label;
 
-    t->reg_alloc.store_context();
+    t->reg_alloc.reconcile(t->loop_info[index].end_state);
 
-    branch_instr(t, JMP_INSTR, end_label);
+    // Pop the variables of the scopes left by the jump
+    int scope_size = t->symbol_table.get_current_scope()->get_end_offset() - t->loop_info[index].stack_offset;
+    if (scope_size != 0) addi_instr(t, STACK_POINTER, STACK_POINTER, scope_size);
+
+    branch_instr(t, IR_JMP, end_label);
+
+    return -1;
 }
 
 int continue_stmt_t::translate(translator_t* t) {
 
-    if (loop_id >= t->loop_info.size()) {
+    if (loop_id >= (int) t->loop_info.size()) {
         translation_error::throw_error("Continue loop index " + std::to_string(loop_id) + " has no corresponding loop", this);
     }
 
     int index = t->loop_info.size() - 1 - loop_id;
     std::string start_label = t->loop_info[index].start_label;
 
-    t->reg_alloc.store_context();
+    t->reg_alloc.reconcile(t->loop_info[index].start_state);
 
-    branch_instr(t, JMP_INSTR, start_label);
+    // Pop the variables of the scopes left by the jump
+    int scope_size = t->symbol_table.get_current_scope()->get_end_offset() - t->loop_info[index].stack_offset;
+    if (scope_size != 0) addi_instr(t, STACK_POINTER, STACK_POINTER, scope_size);
+
+    branch_instr(t, IR_JMP, start_label);
+
+    return -1;
 }
 
 int assignment_stmt_t::translate(translator_t* t) {
@@ -2059,13 +1592,21 @@ int assignment_stmt_t::translate(translator_t* t) {
             // If the variable is already stored in a register, deallocate that register, without storing
             t->reg_alloc.free(var, false);
 
-            var_info_t* temp_var = t->reg_alloc.give_ownership(right_register, var);
+            t->reg_alloc.give_ownership(right_register, var);
             t->reg_alloc.touch(right_register, true);
 
             // Remove old variable
             // t->symbol_table.get_current_scope()->remove(temp_var->name);
             // delete temp_var;
 
+        } else if (is_dying_variable(t, rvalue, var)) {
+
+            // If the right value is a variable that is not read after this statement, its register is reused without a move
+            t->reg_alloc.free(var, false);
+            t->reg_alloc.free(t->symbol_table.get_var(static_cast<id_term_t*>(rvalue)->identifier), false);
+            t->reg_alloc.give_ownership(right_register, var);
+            t->reg_alloc.touch(right_register, true);
+
         } else {
 
             // If it is not temporary, allocate a register and move
@@ -2076,6 +1617,8 @@ int assignment_stmt_t::translate(translator_t* t) {
             move_instr(t, reg, right_register);
         }
     }
+
+    return -1;
 }
 
 int deref_assignment_stmt_t::translate(translator_t* t) {
@@ -2084,7 +1627,7 @@ int deref_assignment_stmt_t::translate(translator_t* t) {
     int var_size = t->type_table.at(var->type)->size;
     bool is_global = dynamic_cast<global_addr_info_t*>(var->address) != nullptr;
 
-    if (!var->is_pointer) output_warning("Dereferencing non-pointer variable " + var->name, this);
+    if (!var->is_pointer) output_warning("Dereferencing non-pointer variable " + symbol_name(var->name), this);
 
     int constant_value = 0;
     bool value_evaluated = rvalue->evaluate(&constant_value);
@@ -2097,6 +1640,9 @@ int deref_assignment_stmt_t::translate(translator_t* t) {
         addi_instr(t, ptr_reg, base_reg, var->address->get_address_string());
     }
 
+    // The pointer is saved on the stack while a call in the value is made
+    bool value_calls = !value_evaluated && contains_call(rvalue);
+
     if (value_evaluated) {
 
 
@@ -2106,6 +1652,22 @@ int deref_assignment_stmt_t::translate(translator_t* t) {
         store_instr(t, ptr_reg, const_reg, nullptr, var_size);
         t->reg_alloc.free(temp_var, false);
 
+    } else if (value_calls) {
+
+        var_info_t* ptr_temp = give_ownership_temp(t, "__temp__", ptr_reg);
+        push_temp(t, ptr_reg);
+
+        // A computed value must not be evicted when the pointer is restored
+        int right_register = rvalue->translate(t);
+        if (right_register != RETURN_REGISTER) {
+            right_register = take_ownership_or_allocate(t, "__temp__", right_register);
+            t->reg_alloc.touch(right_register, false);
+        }
+
+        ptr_reg = pop_temp(t, ptr_temp);
+        store_instr(t, ptr_reg, right_register, nullptr, var_size);
+        t->reg_alloc.free(ptr_temp, false);
+
     } else {
         
         int right_register = rvalue->translate(t);
@@ -2116,6 +1678,8 @@ int deref_assignment_stmt_t::translate(translator_t* t) {
 
         store_instr(t, ptr_reg, right_register, nullptr, var_size);
     }
+
+    return -1;
 }
 
 int indexed_assignment_stmt_t::translate(translator_t* t) {
@@ -2126,10 +1690,21 @@ int indexed_assignment_stmt_t::translate(translator_t* t) {
     
     bool array_needs_loading = t->reg_alloc.already_allocated(var);
 
-    if (!var->is_pointer) output_warning("Dereferencing non-pointer variable " + var->name, this);
+    if (!var->is_pointer) output_warning("Dereferencing non-pointer variable " + symbol_name(var->name), this);
 
     int constant_value = 0;
     bool value_evaluated = rvalue->evaluate(&constant_value);
+
+    int constant_index = 0;
+    bool index_evaluated = index->evaluate(&constant_index);
+
+    // A call changes the registers, an index making one is translated before the address is loaded
+    int index_register = -1;
+    if (!index_evaluated && contains_call(index)) {
+        index_register = take_ownership_or_allocate(t, "__temp__", index->translate(t));
+        array_needs_loading = t->reg_alloc.already_allocated(var);
+    }
+
     int ptr_reg = t->reg_alloc.allocate(var, !var->is_array, false);
 
     // If the variable being dereferenced is an array, load the address of the array instead of the variable
@@ -2138,26 +1713,30 @@ int indexed_assignment_stmt_t::translate(translator_t* t) {
         addi_instr(t, ptr_reg, base_reg, var->address->get_address_string());
     }
 
-    int constant_index = 0;
-    bool index_evaluated = index->evaluate(&constant_index);
+    // The address is saved on the stack while a call in the value is made
+    bool value_calls = !value_evaluated && contains_call(rvalue);
 
     var_info_t* ptr_temp;
-    if (!index_evaluated || constant_index) ptr_temp = give_ownership_temp(t, "__temp__", ptr_reg);
+    if (!index_evaluated || constant_index || value_calls) ptr_temp = give_ownership_temp(t, "__temp__", ptr_reg);
     
     if (index_evaluated && constant_index < std::numeric_limits<unsigned short>().max()) {
         
         if (constant_index) addi_instr(t, ptr_reg, ptr_reg, var_size * constant_index);
 
     } else {
-        var_info_t* size_const_var;
-        
-        int index_register = index->translate(t);
-        int size_const_reg = allocate_temp_imm(t, "__temp__", var_size, &size_const_var);
+        if (index_register == -1) index_register = index->translate(t);
 
-        mult_instr(t, size_const_reg, index_register, size_const_reg);
-        add_instr(t, ptr_reg, ptr_reg, size_const_reg);
+        if (var_size == 1) {
+            add_instr(t, ptr_reg, ptr_reg, index_register);
+        } else {
+            var_info_t* offset_var;
+            int offset_reg = allocate_temp(t, "__temp__", &offset_var);
+
+            mult_imm(t, offset_reg, index_register, var_size);
+            add_instr(t, ptr_reg, ptr_reg, offset_reg);
 
-        t->reg_alloc.free(size_const_var, false);
+            t->reg_alloc.free(offset_var, false);
+        }
     }
 
     if (value_evaluated) {
@@ -2168,6 +1747,20 @@ int indexed_assignment_stmt_t::translate(translator_t* t) {
         store_instr(t, ptr_reg, const_reg, nullptr, var_size);
         t->reg_alloc.free(temp_var, false);
 
+    } else if (value_calls) {
+
+        push_temp(t, ptr_reg);
+
+        // A computed value must not be evicted when the address is restored
+        int right_register = rvalue->translate(t);
+        if (right_register != RETURN_REGISTER) {
+            right_register = take_ownership_or_allocate(t, "__temp__", right_register);
+            t->reg_alloc.touch(right_register, false);
+        }
+
+        ptr_reg = pop_temp(t, ptr_temp);
+        store_instr(t, ptr_reg, right_register, nullptr, var_size);
+
     } else {
         
         int right_register = rvalue->translate(t);
@@ -2178,11 +1771,23 @@ int indexed_assignment_stmt_t::translate(translator_t* t) {
 
         store_instr(t, ptr_reg, right_register, nullptr, var_size);
     }
-    if (!index_evaluated || constant_index)  t->reg_alloc.free(ptr_temp, false);
+    if (!index_evaluated || constant_index || value_calls)  t->reg_alloc.free(ptr_temp, false);
+
+    return -1;
 }
 
 
 int return_stmt_t::translate(translator_t* t) {
+
+    // A call whose value is returned is jumped to, the function called returns in place of this one
+    expr_t* value = return_value;
+    while (value->kind == NODE_TERM_EXPR || value->kind == NODE_EXPR_TERM) {
+        value = (value->kind == NODE_TERM_EXPR) ? static_cast<term_expr_t*>(value)->t : static_cast<expr_term_t*>(value)->expr;
+    }
+
+    if (value->kind == NODE_CALL_TERM && static_cast<call_term_t*>(value)->can_jump(t)) {
+        return static_cast<call_term_t*>(value)->translate_jump(t);
+    }
     
     int constant_value = 0;
     bool value_evaluated = return_value->evaluate(&constant_value);
@@ -2212,6 +1817,8 @@ int return_stmt_t::translate(translator_t* t) {
     if (total_scope_size != 0) addi_instr(t, STACK_POINTER, STACK_POINTER, total_scope_size);
 
     ret_instr(t);
+
+    return -1;
 }
 
 int expr_stmt_t::translate(translator_t* t) {
@@ -2225,18 +1832,13 @@ int neg_expr_t::translate(translator_t* t) {
     std::stringstream output;
 
     int reg = value->translate(t);
-    std::string register_string = t->reg_alloc.get_register_string(reg);
-    
-     // If the allocated register is not temporary, take ownership of it
-    if (!t->reg_alloc.is_temporary(reg) && reg != RETURN_REGISTER) {
-        
-        give_ownership_temp(t, "__temp__", reg);
 
-    }
+    // A variable read again later keeps its register, the result goes to another one
+    int result_register = (reg == RETURN_REGISTER) ? reg : allocate_result(t, "__temp__", reg);
     
     // Print neg instr
-    neg_instr(t, reg, reg);
-    return reg;
+    neg_instr(t, result_register, reg);
+    return result_register;
 }
 
 int not_expr_t::translate(translator_t* t) {
@@ -2244,18 +1846,25 @@ int not_expr_t::translate(translator_t* t) {
     std::stringstream output;
 
     int reg = value->translate(t);
-    std::string register_string = t->reg_alloc.get_register_string(reg);
-    
-     // If the allocated register is not temporary, take ownership of it
-    if (!t->reg_alloc.is_temporary(reg) && reg != RETURN_REGISTER) {
-        
-        give_ownership_temp(t, "__temp__", reg);
 
-    }
-    
-    // Print not instr
-    not_instr(t, reg, reg);
-    return reg;
+    // A variable read again later keeps its register, the result goes to another one
+    int result_register = (reg == RETURN_REGISTER) ? reg : allocate_result(t, "__temp__", reg);
+
+    // ! is logical, it gives 1 for zero and 0 for anything else like value == 0, which is what evaluate
+    // folds and what conditions test
+    std::string true_label = t->label_allocator.get_label_name();
+    std::string end_label = t->label_allocator.get_label_name();
+
+    cmpi_instr(t, reg, 0);
+    branch_instr(t, IR_BREQ, true_label);
+    addi_instr(t, result_register, NULL_REGISTER, 0);
+    branch_instr(t, IR_JMP, end_label);
+
+    print_label(t, true_label);
+    addi_instr(t, result_register, NULL_REGISTER, 1);
+
+    print_label(t, end_label);
+    return result_register;
 }
 
 int term_expr_t::translate(translator_t* t) {
@@ -2264,7 +1873,12 @@ int term_expr_t::translate(translator_t* t) {
 }
 
 int id_term_t::translate(translator_t* t) {
-    
+
+    if (is_constant) {
+        var_info_t* temp_var;
+        return allocate_temp_imm(t, "__temp__", constant, &temp_var);
+    }
+
     // Find variable, allocate register, return index
     var_info_t* var = t->symbol_table.get_var(identifier);
 
@@ -2288,12 +1902,12 @@ int addr_of_term_t::translate(translator_t* t) {
     var_info_t* var = t->symbol_table.get_var(identifier);
 
     bool is_local = dynamic_cast<local_addr_info_t*>(var->address) != nullptr;
-    bool is_global = dynamic_cast<global_addr_info_t*>(var->address) != nullptr;
 
-    std::string temp_name = t->name_allocator.get_name("__temp__");
+    symbol_t temp_name = t->name_allocator.get_name("__temp__");
 
     // Add temporary variable to scope to allow register allocation
     var_info_t* temp_var = t->symbol_table.add_var(temp_name, 0, 0, nullptr);
+    temp_var->is_temp = true;
 
     int reg = t->reg_alloc.allocate(temp_var, false, false);
 
@@ -2307,7 +1921,7 @@ int addr_of_term_t::translate(translator_t* t) {
 
         global_addr_info_t* g_addr = dynamic_cast<global_addr_info_t*>(var->address);
 
-        tri_operand_imm_str_instr(t, ADD_IMM_INSTR, reg, NULL_REGISTER, g_addr->label);
+        tri_operand_imm_str_instr(t, IR_ADDI, reg, NULL_REGISTER, g_addr->label);
 
     }
 
@@ -2319,16 +1933,10 @@ int deref_term_t::translate(translator_t* t) {
     var_info_t* var = t->symbol_table.get_var(identifier);
     int var_size = t->type_table.at(var->type)->size;
 
-    if (!var->is_pointer) output_warning("Dereferencing non-pointer variable " + var->name, this);
+    if (!var->is_pointer) output_warning("Dereferencing non-pointer variable " + symbol_name(var->name), this);
 
-    bool is_local = dynamic_cast<local_addr_info_t*>(var->address) != nullptr;
     bool is_global = dynamic_cast<global_addr_info_t*>(var->address) != nullptr;
 
-    std::string temp_name = t->name_allocator.get_name("__temp__");
-
-    // Add temporary variable to scope to allow register allocation
-    var_info_t* temp_var = t->symbol_table.add_var(temp_name, 0, 0, nullptr);
-
     int reg = t->reg_alloc.allocate(var, !var->is_array, false);
 
     // If the variable being dereferenced is an array, load the address of the array instead of the variable
@@ -2337,13 +1945,13 @@ int deref_term_t::translate(translator_t* t) {
         addi_instr(t, reg, base_reg, var->address->get_address_string());
     }
 
-    // Take ownership of register
-    t->reg_alloc.give_ownership(reg, temp_var);
+    // The pointer keeps its register if it is read again later
+    int result_register = allocate_result(t, "__temp__", reg);
 
-    // Load the value pointed to by reg into reg with offset 0
-    load_instr(t, reg, reg, nullptr, var_size);
+    // Load the value pointed to by reg with offset 0
+    load_instr(t, result_register, reg, nullptr, var_size);
 
-    return reg;
+    return result_register;
 }
 
 int indexed_term_t::translate(translator_t* t) {
@@ -2352,15 +1960,22 @@ int indexed_term_t::translate(translator_t* t) {
 
     int var_size = t->type_table.at(var->type)->size;
 
-    if (!var->is_pointer) output_warning("Dereferencing non-pointer variable " + var->name, this);
+    if (!var->is_pointer) output_warning("Dereferencing non-pointer variable " + symbol_name(var->name), this);
 
-    bool is_local = dynamic_cast<local_addr_info_t*>(var->address) != nullptr;
     bool is_global = dynamic_cast<global_addr_info_t*>(var->address) != nullptr;
 
-    std::string temp_name = t->name_allocator.get_name("__temp__");
+    symbol_t temp_name = t->name_allocator.get_name("__temp__");
 
     // Add temporary variable to scope to allow register allocation
     var_info_t* temp_var = t->symbol_table.add_var(temp_name, 0, 0, nullptr);
+    temp_var->is_temp = true;
+
+    int constant_index = 0;
+    bool index_evaluated = index->evaluate(&constant_index);
+
+    // A call changes the registers, an index making one is translated before the address is loaded
+    int index_reg = -1;
+    if (!index_evaluated && contains_call(index)) index_reg = take_ownership_or_allocate(t, "__temp__", index->translate(t));
 
     int reg = t->reg_alloc.allocate(var, !var->is_array, false);
 
@@ -2370,9 +1985,6 @@ int indexed_term_t::translate(translator_t* t) {
         addi_instr(t, reg, base_reg, var->address->get_address_string());
     }
 
-    int constant_index = 0;
-    bool index_evaluated = index->evaluate(&constant_index);
-
     if (index_evaluated) {
 
         int temp_reg = t->reg_alloc.allocate(temp_var, false, false);
@@ -2381,17 +1993,10 @@ int indexed_term_t::translate(translator_t* t) {
 
     } else {
 
-        int index_reg = index->translate(t);
-
-        index_reg = take_ownership_or_allocate(t, "__temp__", index_reg);
+        if (index_reg == -1) index_reg = take_ownership_or_allocate(t, "__temp__", index->translate(t));
         
         // If variable size is not one, multiply by it
-        if (var_size != 1) {
-            var_info_t* size_const_var;
-            int size_const_reg = allocate_temp_imm(t, "__temp__", var_size, &size_const_var);
-            mult_instr(t, index_reg, index_reg, size_const_reg);
-            t->reg_alloc.free(size_const_var, false);
-        }
+        if (var_size != 1) mult_imm(t, index_reg, index_reg, var_size);
 
         add_instr(t, index_reg, reg, index_reg);
         load_instr(t, index_reg, index_reg, nullptr, var_size);
@@ -2400,23 +2005,63 @@ int indexed_term_t::translate(translator_t* t) {
     }
 }
 
+// Moves the arguments evaluated by params_t::translate_registers into r0 and up. A move waits until no other
+// move reads its destination, a cycle is broken by moving one of the values to the return register, which
+// is free until the call
+static void move_arguments(translator_t* t, params_t* params, std::vector<int>& registers) {
+
+    std::vector<int> pending;
+    for (int i = 0; i < (int) registers.size(); i++) {
+        if (registers[i] != -1 && registers[i] != i) pending.push_back(i);
+    }
+
+    while (!pending.empty()) {
+
+        auto next = std::find_if(pending.begin(), pending.end(), [&](int destination) {
+            return std::none_of(pending.begin(), pending.end(), [&](int other) { return registers[other] == destination; });
+        });
+
+        if (next == pending.end()) {
+            int blocked = pending.front();
+            move_instr(t, RETURN_REGISTER, blocked);
+            for (int other : pending) {
+                if (registers[other] == blocked) registers[other] = RETURN_REGISTER;
+            }
+            continue;
+        }
+
+        move_instr(t, *next, registers[*next]);
+        pending.erase(next);
+    }
+
+    // Constant arguments are loaded into their registers
+    for (int i = 0; i < (int) registers.size(); i++) {
+
+        int value = 0;
+        if (registers[i] == -1 && (*params)[i]->evaluate(&value)) load_immediate(t, i, value);
+    }
+}
+
 int call_term_t::translate(translator_t* t) {
     
     // TODO: Fix alignment?
 
     func_info_t* func = t->symbol_table.get_func(function_identifier);
 
-    if (func == nullptr) translation_error::throw_error("Function " + function_identifier + " is not declared.", this);
+    if (func == nullptr) translation_error::throw_error("Function " + symbol_name(function_identifier) + " is not declared.", this);
     
     scope_t* current_scope = t->symbol_table.get_current_scope();
     
-    int context_size = current_scope->get_end_offset() + 2;//(func->param_vector.size()) ? 2 : 0;
+    // A function without a frame leaves the base pointer as it is
+    bool save_base_pointer = !func->frameless;
+
+    int context_size = current_scope->get_end_offset() + ((save_base_pointer) ? 2 : 0);
     
     int alignment = (context_size % 4) ? 4 - (context_size % 4) : 0;
     int alignment_done = 0;
 
     // Push base pointer to stack
-    push_instr(t, BASE_POINTER, POINTER_SIZE);
+    if (save_base_pointer) push_instr(t, BASE_POINTER, POINTER_SIZE);
 
     // Align the stack to 4
     if (alignment && ((alignment == 2) == (func->total_stack_size != 0))) {
@@ -2426,7 +2071,11 @@ int call_term_t::translate(translator_t* t) {
     }
 
     // Push parameters to stack
-    if (params != nullptr) params->translate(t, func, 0);
+    std::vector<int> registers;
+    if (params != nullptr) {
+        params->translate(t, func);
+        params->translate_registers(t, registers);
+    }
     if (params == nullptr && func->param_vector.size()) {
         translation_error::throw_error("Too few arguments in function call", this);
     } 
@@ -2434,6 +2083,8 @@ int call_term_t::translate(translator_t* t) {
     // Store current context
     t->reg_alloc.store_context();
 
+    move_arguments(t, params, registers);
+
     // If the parameters are 4 aligned, stack wont be because of return pointer, offset it with 2
     if (current_scope->get_end_offset() % 4 != 2) {
 
@@ -2445,7 +2096,7 @@ int call_term_t::translate(translator_t* t) {
     }
 
     // Call function
-    call_instr(t, function_identifier);
+    call_instr(t, symbol_name(function_identifier));
 
     // Pop parameters and alignment
     current_scope->pop(alignment_done + func->total_stack_size);
@@ -2454,13 +2105,60 @@ int call_term_t::translate(translator_t* t) {
     if (alignment_done + func->total_stack_size) addi_instr(t, STACK_POINTER, STACK_POINTER, func->total_stack_size + alignment_done);
 
     // Pop base pointer from stack
-    pop_instr(t, BASE_POINTER, POINTER_SIZE);
+    if (save_base_pointer) pop_instr(t, BASE_POINTER, POINTER_SIZE);
 
     return RETURN_REGISTER; 
 }
 
+bool call_term_t::can_jump(translator_t* t) {
+
+    if (!t->options.tail_calls) return false;
+
+    // Arguments on the stack would have to replace those of the caller
+    func_info_t* func = t->symbol_table.get_func(function_identifier);
+    if (func == nullptr || func->param_vector.size() > REGISTER_PARAM_COUNT) return false;
+
+    // The locals are popped before the jump, pointers to them must not reach the callee
+    return !t->liveness.has_addressed_locals();
+}
+
+int call_term_t::translate_jump(translator_t* t) {
+
+    func_info_t* func = t->symbol_table.get_func(function_identifier);
+
+    std::vector<int> registers;
+    if (params != nullptr) {
+        params->translate(t, func);
+        params->translate_registers(t, registers);
+    }
+    if (params == nullptr && func->param_vector.size()) {
+        translation_error::throw_error("Too few arguments in function call", this);
+    }
+
+    // Nothing but the globals is needed after the jump
+    t->reg_alloc.free_scope(t->symbol_table.get_current_scope(), true);
+    for (int i = 0; i < (int) registers.size(); i++) {
+
+        var_info_t* var = t->reg_alloc.get_content(i);
+        if (var != nullptr) t->reg_alloc.free(var, false);
+    }
+
+    move_arguments(t, params, registers);
+
+    int total_scope_size = t->symbol_table.get_current_scope()->get_end_offset();
+    if (total_scope_size != 0) addi_instr(t, STACK_POINTER, STACK_POINTER, total_scope_size);
+
+    if (!func->frameless) t->frame.jumps_to_frame(symbol_name(function_identifier));
+
+    branch_instr(t, IR_JMP, symbol_name(function_identifier));
+
+    return -1;
+}
+
 int lit_term_t::translate(translator_t* t) {
     
+    var_info_t* var;
+    return allocate_temp_imm(t, "__temp__", literal, &var);
 }
 
 int expr_term_t::translate(translator_t* t) {
@@ -2470,46 +2168,62 @@ int expr_term_t::translate(translator_t* t) {
 }
 
 int add_binop_t::translate(translator_t* t) {
-    return translate_binop_imm(t, this, ADD_INSTR, ADD_IMM_INSTR);
+    return translate_binop_imm(t, this, IR_ADD, IR_ADDI);
 }
 
 int sub_binop_t::translate(translator_t* t) {
-    return translate_binop_imm(t, this, SUB_INSTR, SUB_IMM_INSTR);
+    return translate_binop_imm(t, this, IR_SUB, IR_SUBI);
 }
 
 int and_binop_t::translate(translator_t* t) {
-    return translate_binop(t, this, AND_INSTR);
+    return translate_binop(t, this, IR_AND);
 }
 
 int or_binop_t::translate(translator_t* t) {
-    return translate_binop(t, this, OR_INSTR);
+    return translate_binop(t, this, IR_OR);
+}
+
+int logical_and_binop_t::translate(translator_t* t) {
+    return translate_logical(t, this);
+}
+
+int logical_or_binop_t::translate(translator_t* t) {
+    return translate_logical(t, this);
 }
 
 int mult_binop_t::translate(translator_t* t) {
-    return translate_binop(t, this, MULT_INSTR);
+    return translate_mult(t, this);
+}
+
+int shift_left_binop_t::translate(translator_t* t) {
+    return translate_binop_imm(t, this, IR_LSL, IR_LSLI);
+}
+
+int shift_right_binop_t::translate(translator_t* t) {
+    return translate_binop_imm(t, this, IR_ASR, IR_ASRI);
 }
 
 
 int eq_binop_t::translate(translator_t* t) {
-    return translate_binop_relational(t, this, BREQ_INSTR);
+    return translate_binop_relational(t, this, IR_BREQ);
 }
 
 int neq_binop_t::translate(translator_t* t) {
-    return translate_binop_relational(t, this, BRNE_INSTR);
+    return translate_binop_relational(t, this, IR_BRNE);
 }
 
 int less_binop_t::translate(translator_t* t) {
-    return translate_binop_relational(t, this, BRLT_INSTR);
+    return translate_binop_relational(t, this, IR_BRLT);
 }
 
 int greater_binop_t::translate(translator_t* t) {
-    return translate_binop_relational(t, this, BRGT_INSTR);
+    return translate_binop_relational(t, this, IR_BRGT);
 }
 
 int less_eq_binop_t::translate(translator_t* t) {
-    return translate_binop_relational(t, this, BRLE_INSTR);
+    return translate_binop_relational(t, this, IR_BRLE);
 }
 
 int greater_eq_binop_t::translate(translator_t* t) {
-    return translate_binop_relational(t, this, BRGE_INSTR);
+    return translate_binop_relational(t, this, IR_BRGE);
 }
\ No newline at end of file
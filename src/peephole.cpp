@@ -0,0 +1,217 @@
+#include "../include/peephole.h"
+#include "../include/translator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+struct peephole_pattern_t {
+    const char* name;
+
+    // Rewrites the instructions starting at index of the block, returns false if the pattern does not match there
+    bool (*rewrite)(std::vector<ir_block_t>& blocks, int block, int index);
+};
+
+static bool same_address(const ir_instr_t& a, const ir_instr_t& b) {
+    return a.ra == b.ra && a.imm == b.imm && a.symbol == b.symbol && a.size == b.size;
+}
+
+// Replaces an instruction with a move, or removes it if the registers are the same
+static void replace_with_move(std::vector<ir_instr_t>& instrs, int index, vreg_t rd, vreg_t ra) {
+
+    if (rd == ra) instrs.erase(instrs.begin() + index);
+    else instrs[index] = ir_instr_t(IR_MOVE, rd, ra);
+}
+
+// Number of instructions searched for a load of a stored address
+#define LOAD_WINDOW 8
+
+// store[n] base, rX, offset followed by load[n] rY, base, offset: the value is still in rX. Instructions in
+// between may not write base or rX, or write to memory
+static bool load_after_store(std::vector<ir_block_t>& blocks, int block, int index) {
+
+    std::vector<ir_instr_t>& instrs = blocks[block].instrs;
+
+    const ir_instr_t& store = instrs[index];
+    if (store.op != IR_STORE) return false;
+
+    for (int i = index + 1; i < (int) instrs.size() && i <= index + LOAD_WINDOW; i++) {
+
+        const ir_instr_t& instr = instrs[i];
+
+        if (instr.op == IR_LOAD && same_address(store, instr)) {
+            replace_with_move(instrs, i, instr.rd, store.rb);
+            return true;
+        }
+
+        if (instr.op == IR_STORE || instr.op == IR_PUSH || instr.op == IR_CALL || instr.op == IR_ASM) return false;
+
+        vreg_t def = instr.get_def();
+        if (def == store.ra || def == store.rb) return false;
+    }
+    return false;
+}
+
+// move rX, rX
+static bool self_move(std::vector<ir_block_t>& blocks, int block, int index) {
+
+    std::vector<ir_instr_t>& instrs = blocks[block].instrs;
+    const ir_instr_t& instr = instrs[index];
+
+    if (instr.op != IR_MOVE || instr.rd != instr.ra) return false;
+
+    instrs.erase(instrs.begin() + index);
+    return true;
+}
+
+// addi rX, rX, 0 and subi rX, rX, 0, like popping an empty scope with addi SP, SP, 0
+static bool add_zero(std::vector<ir_block_t>& blocks, int block, int index) {
+
+    std::vector<ir_instr_t>& instrs = blocks[block].instrs;
+    const ir_instr_t& instr = instrs[index];
+
+    if (instr.op != IR_ADDI && instr.op != IR_SUBI) return false;
+    if (instr.rd != instr.ra || instr.imm != 0 || !instr.symbol.empty()) return false;
+
+    instrs.erase(instrs.begin() + index);
+    return true;
+}
+
+// Change of SP made by the instruction if it is addi SP, SP, imm or subi SP, SP, imm, otherwise 0
+static int stack_adjustment(const ir_instr_t& instr) {
+
+    if (instr.op != IR_ADDI && instr.op != IR_SUBI) return 0;
+    if (instr.rd != STACK_POINTER || instr.ra != STACK_POINTER || !instr.symbol.empty()) return 0;
+
+    return (instr.op == IR_ADDI) ? instr.imm : -instr.imm;
+}
+
+static bool uses_stack_pointer(const ir_instr_t& instr) {
+
+    if (instr.op == IR_PUSH || instr.op == IR_POP || instr.op == IR_CALL || instr.op == IR_RET || instr.op == IR_ASM) return true;
+    if (instr.get_def() == STACK_POINTER) return true;
+
+    std::vector<vreg_t> uses = instr.get_uses();
+    return std::find(uses.begin(), uses.end(), STACK_POINTER) != uses.end();
+}
+
+// Two adjustments of SP with no instruction reading SP in between, like the scopes of an inlined body, are
+// merged into the first. Space is never released earlier than before over a load or store
+static bool stack_adjustments(std::vector<ir_block_t>& blocks, int block, int index) {
+
+    std::vector<ir_instr_t>& instrs = blocks[block].instrs;
+
+    int first = stack_adjustment(instrs[index]);
+    if (first == 0) return false;
+
+    bool memory = false;
+    for (int i = index + 1; i < (int) instrs.size(); i++) {
+
+        const ir_instr_t& instr = instrs[i];
+        int next = stack_adjustment(instr);
+
+        if (next != 0) {
+            if (next > 0 && memory) return false;
+
+            int total = first + next;
+            instrs[index] = ir_instr_t((total >= 0) ? IR_ADDI : IR_SUBI, STACK_POINTER, STACK_POINTER, NO_REGISTER, std::abs(total));
+            instrs.erase(instrs.begin() + i);
+            return true;
+        }
+
+        if (uses_stack_pointer(instr)) return false;
+        if (instr.op == IR_LOAD || instr.op == IR_STORE) memory = true;
+    }
+    return false;
+}
+
+// push[n] rX followed by pop[n] rY
+static bool push_pop(std::vector<ir_block_t>& blocks, int block, int index) {
+
+    std::vector<ir_instr_t>& instrs = blocks[block].instrs;
+    if (index + 1 >= (int) instrs.size()) return false;
+
+    const ir_instr_t& push = instrs[index];
+    const ir_instr_t& pop = instrs[index + 1];
+
+    if (push.op != IR_PUSH || pop.op != IR_POP || push.size != pop.size) return false;
+
+    vreg_t rd = pop.rd;
+    vreg_t ra = push.ra;
+
+    instrs.erase(instrs.begin() + index);
+    replace_with_move(instrs, index, rd, ra);
+    return true;
+}
+
+// rjmp L directly followed by L:, possibly with empty blocks in between
+static bool jump_to_next(std::vector<ir_block_t>& blocks, int block, int index) {
+
+    std::vector<ir_instr_t>& instrs = blocks[block].instrs;
+    if (index + 1 != (int) instrs.size() || instrs[index].op != IR_JMP) return false;
+
+    for (int next = block + 1; next < (int) blocks.size(); next++) {
+
+        if (blocks[next].label == instrs[index].symbol) {
+            instrs.erase(instrs.begin() + index);
+            return true;
+        }
+
+        if (!blocks[next].instrs.empty()) break;
+    }
+    return false;
+}
+
+// Instructions of an unlabeled block after rjmp or ret, like a jump emitted after a continue
+static bool unreachable(std::vector<ir_block_t>& blocks, int block, int index) {
+
+    if (index != 0 || block == 0 || !blocks[block].label.empty()) return false;
+
+    const std::vector<ir_instr_t>& previous = blocks[block - 1].instrs;
+    if (previous.empty() || !previous.back().is_terminator()) return false;
+
+    blocks[block].instrs.clear();
+    return true;
+}
+
+static const peephole_pattern_t patterns[] = {
+    { "load after store",   load_after_store },
+    { "self move",          self_move },
+    { "add zero",           add_zero },
+    { "stack adjustments",  stack_adjustments },
+    { "push pop",           push_pop },
+    { "jump to next",       jump_to_next },
+    { "unreachable",        unreachable }
+};
+
+peephole_optimizer_t::peephole_optimizer_t() {
+    removed = 0;
+}
+
+int peephole_optimizer_t::optimize(ir_function_t& func) {
+
+    std::vector<ir_block_t>& blocks = func.get_blocks();
+    int size_before = func.size();
+
+    for (int block = 0; block < (int) blocks.size(); block++) {
+
+        int index = 0;
+        while (index < (int) blocks[block].instrs.size()) {
+
+            bool matched = false;
+            for (const peephole_pattern_t& pattern : patterns) {
+                if (pattern.rewrite(blocks, block, index)) {
+                    matched = true;
+                    break;
+                }
+            }
+
+            // A rewrite can make the previous instruction match a pattern
+            if (matched) index = std::max(index - 1, 0);
+            else index++;
+        }
+    }
+
+    int result = size_before - func.size();
+    removed += result;
+    return result;
+}
@@ -7,14 +7,15 @@
 
 
 #include <algorithm>
-#include <functional>
 #include <sstream>
 #include <iostream>
+#include <limits>
 
 reg_t::reg_t() {
     index        = 0;
     content      = nullptr;
     last_changed = 0L;
+    position     = 0;
 
     locked      = false;
     temp        = false;
@@ -23,15 +24,11 @@ reg_t::reg_t() {
 
 }
 
-struct reg_ptr_cmp {
-    bool operator()(const reg_t* left, const reg_t* right) {
-        return left->last_changed > right->last_changed;
-    }
-};
-
 register_allocator_t::register_allocator_t() {
     //registers = std::vector<reg_t*>(REGISTER_COUNT);
 
+    position = 0;
+
     for (int i = 0; i < REGISTER_COUNT; i++) {
         
         reg_t* reg = new reg_t();
@@ -43,8 +40,6 @@ register_allocator_t::register_allocator_t() {
             reg->last_changed = std::numeric_limits<long>::max();
         }
     }
-
-    //std::make_heap(registers.begin(), registers.end(), reg_ptr_cmp());
 }
 
 register_allocator_t::~register_allocator_t() {
@@ -59,47 +54,181 @@ void register_allocator_t::set_parent(translator_t* _parent) {
     parent = _parent;
 }
 
+void register_allocator_t::set_position(int _position) {
+    position = _position;
+}
+
+bool register_allocator_t::is_dead(const reg_t* reg) {
+
+    var_info_t* var = reg->content;
+    if (var == nullptr) return true;
+
+    // Temporaries never outlive the statement computing them
+    if (var->is_temp) return reg->position < position;
+
+    return var->range != nullptr && !var->range->is_live_at(position);
+}
+
+bool register_allocator_t::is_last_use(var_info_t* var) {
+    const live_range_t* range = var->range;
+    if (range == nullptr || range->address_taken) return false;
+
+    return range->end < position || (range->end == position && !range->repeated_at_end);
+}
+
+bool register_allocator_t::is_preserved(const var_info_t* var) {
+    return var->range != nullptr && var->range->last_call >= position;
+}
+
+reg_t* register_allocator_t::choose_register(bool preserved) {
+
+    // Prefer, in order: an empty register, a register whose content is dead, the variable of an earlier
+    // statement that is live the furthest, and last the least recently used register. With graph coloring,
+    // empty and dead registers that are the home of a live variable are only taken after the others.
+    // Free registers are looked for among the callee saved registers first if the variable is preserved,
+    // otherwise among the caller saved ones, so functions that make no calls rarely have to save any
+    reg_t* empty[2] = { nullptr, nullptr };
+    reg_t* dead[2] = { nullptr, nullptr };
+    reg_t* claimed[2] = { nullptr, nullptr };
+    reg_t* furthest = nullptr;
+    reg_t* lru = nullptr;
+    reg_t* lru_temp = nullptr;
+
+    int furthest_end = -1;
+
+    for (reg_t* reg : registers) {
+
+        if (reg->reserved || reg->locked) continue;
+
+        if (reg->content == nullptr || is_dead(reg)) {
+
+            int group = ((reg->index < CALLER_SAVED_COUNT) == preserved) ? 1 : 0;
+
+            if (parent->coloring.is_claimed(reg->index, position)) {
+                if (claimed[group] == nullptr) claimed[group] = reg;
+            } else if (reg->content == nullptr) {
+                if (empty[group] == nullptr) empty[group] = reg;
+            } else {
+                if (dead[group] == nullptr) dead[group] = reg;
+            }
+            continue;
+        }
+
+        // Registers used by the current statement may hold operands, they are only taken if nothing else is left
+        if (reg->position < position && !reg->content->is_temp) {
+
+            // Globals and variables whose address is taken are assumed to be used until the end of the function
+            const live_range_t* range = reg->content->range;
+            int end = (range != nullptr && !range->address_taken) ? range->end : std::numeric_limits<int>::max();
+
+            if (end > furthest_end || (end == furthest_end && reg->last_changed < furthest->last_changed)) {
+                furthest = reg;
+                furthest_end = end;
+            }
+            continue;
+        }
+
+        reg_t*& oldest = (reg->content->is_temp) ? lru_temp : lru;
+        if (oldest == nullptr || reg->last_changed < oldest->last_changed) oldest = reg;
+    }
+
+    for (int group = 0; group < 2; group++) {
+        if (empty[group] != nullptr) return empty[group];
+        if (dead[group] != nullptr) return dead[group];
+        if (claimed[group] != nullptr) return claimed[group];
+    }
+
+    if (furthest != nullptr) return furthest;
+    if (lru != nullptr) return lru;
+    return lru_temp;
+}
+
+reg_t* register_allocator_t::choose_home(var_info_t* var) {
+
+    if (var->range == nullptr || var->range->home < 0) return nullptr;
+
+    reg_t* home = get_register(var->range->home);
+    if (home->locked) return nullptr;
+
+    // The home is only taken if that does not evict an operand of the current statement
+    if (home->content == nullptr || is_dead(home)) return home;
+    if (home->position < position && !home->content->is_temp) return home;
+
+    return nullptr;
+}
+
 reg_t* register_allocator_t::get_register(int index) {
 
-    for (int i = 0; i < registers.size(); i++) {
+    for (int i = 0; i < (int) registers.size(); i++) {
         if (registers[i]->index == index) return registers[i];
     }
     return nullptr;
 }
 
-void register_allocator_t::free(reg_t* reg, bool store, bool sort) {
+void register_allocator_t::free(reg_t* reg, bool store) {
 
 
     // If the register has no content, there is nothing to free
     if (reg->content == nullptr) return;
 
     var_info_t* old_data = reg->content;
-    int size = (old_data->is_pointer) ? POINTER_SIZE : parent->type_table.at(old_data->type)->size;
 
-    if (store && reg->changed) {
-        
-        int base_or_null;
-
-        if (dynamic_cast<global_addr_info_t*>(reg->content->address) != nullptr) {
-            // If variable is global is zero
-            base_or_null = NULL_REGISTER;
-        } else {
-            // If variable is local address is base pointer
-            base_or_null = BASE_POINTER;
-        }
-
-        // Store variable
-        store_instr(parent, base_or_null, reg->index, old_data->address, size);
-    }
+    // Temporaries have no memory and dead variables are never read again
+    if (store && reg->changed && !old_data->is_temp && !is_dead(reg)) write_back(reg);
     
     // Update register
     reg->temp = false;
+    reg->locked = false;
     reg->content = nullptr;
     reg->last_changed = 0;
+    reg->position = 0;
     reg->changed = false;
-    
-    // re-heapify the vector
-    //if (sort) std::make_heap(registers.begin(), registers.end(), std::greater<reg_t*>());
+}
+
+void register_allocator_t::load(reg_t* reg, var_info_t* var) {
+
+    int base_or_null;
+    if (dynamic_cast<global_addr_info_t*>(var->address) != nullptr) {
+        // If the variable is global use null register
+        base_or_null = NULL_REGISTER;
+
+    } else {
+        // If the variable is local use base pointer
+        base_or_null = BASE_POINTER;
+    }
+
+    // The register holds the address of the array, not a value in memory
+    if (var->is_array) {
+        addi_instr(parent, reg->index, base_or_null, var->address->get_address_string());
+        return;
+    }
+
+    int size = (var->is_pointer) ? POINTER_SIZE : parent->type_table.at(var->type)->size;
+
+    // Print instruction
+    load_instr(parent, reg->index, base_or_null, var->address, size);
+}
+
+void register_allocator_t::write_back(reg_t* reg) {
+
+    var_info_t* var = reg->content;
+
+    // The register holds the address of the array, not a value to store
+    if (var->is_array) return;
+
+    int base_or_null;
+    if (dynamic_cast<global_addr_info_t*>(var->address) != nullptr) {
+        // If variable is global is zero
+        base_or_null = NULL_REGISTER;
+    } else {
+        // If variable is local address is base pointer
+        base_or_null = BASE_POINTER;
+    }
+
+    int size = (var->is_pointer) ? POINTER_SIZE : parent->type_table.at(var->type)->size;
+
+    // Store variable
+    store_instr(parent, base_or_null, reg->index, var->address, size);
 }
 
 int register_allocator_t::allocate(var_info_t* var_to_alloc, bool load_variable, bool temp) {
@@ -109,7 +238,7 @@ int register_allocator_t::allocate(var_info_t* var_to_alloc, bool load_variable,
         translation_error::throw_error("Allocating register to non-existent variable", nullptr);
     }
 
-    for (int i = 0; i < registers.size(); i++) {
+    for (int i = 0; i < (int) registers.size(); i++) {
         reg_t* reg = registers[i];
 
         if (reg->content == nullptr) continue;
@@ -117,54 +246,37 @@ int register_allocator_t::allocate(var_info_t* var_to_alloc, bool load_variable,
         if (reg->content == var_to_alloc) {
             // If the allocation is temporary, make it available instantly
             reg->last_changed = (temp) ? 0 : parent->instr_cnt;
+            reg->position = position;
             return reg->index;
         }
     }
 
-    long min = std::numeric_limits<long>().max();
-    reg_t* front = nullptr; 
+    // Variables colored by graph coloring go to their home register
+    reg_t* front = choose_home(var_to_alloc);
+    if (front == nullptr) front = choose_register(is_preserved(var_to_alloc));
 
-    for (auto* reg : registers) {
-        if (reg->last_changed < min) {
-            front = reg;
-            min = reg->last_changed;
-        }
-    }
-    
-    // Free the register, store the variable and dont sort the heap
-    // if the variable contained is temporary, don't store
-    if (front->content != nullptr) free(front, !(front->temp), false);
+    assign(front, var_to_alloc, load_variable, temp);
+
+    return front->index;
+}
+
+void register_allocator_t::assign(reg_t* reg, var_info_t* var, bool load_variable, bool temp) {
+
+    // Free the register, if the variable contained is temporary, don't store
+    if (reg->content != nullptr) free(reg, !(reg->temp));
 
     // ----- Variable loading -----
     
-    if (load_variable) {
-        // Load the variable into the register
-        
-        int base_or_null;
-        if (dynamic_cast<global_addr_info_t*>(var_to_alloc->address) != nullptr) {
-            // If the variable is global use null register
-            base_or_null = NULL_REGISTER;
-
-        } else {
-            // If the variable is local use base pointer
-            base_or_null = BASE_POINTER;
-        }
-
-        int size = (var_to_alloc->is_pointer) ? POINTER_SIZE : parent->type_table.at(var_to_alloc->type)->size;
-        
-        // Print instruction
-        load_instr(parent, front->index, base_or_null, var_to_alloc->address, size);
-    }
+    if (load_variable) load(reg, var);
 
     // ----------------------------
 
     // Update the register
-    front->temp = temp;
-    front->content = var_to_alloc;
-    front->last_changed = (temp) ? 0 : parent->instr_cnt;
-    front->changed = false;
-
-    return front->index;
+    reg->temp = temp;
+    reg->content = var;
+    reg->last_changed = (temp) ? 0 : parent->instr_cnt;
+    reg->position = position;
+    reg->changed = false;
 }
 
 var_info_t* register_allocator_t::free(int index) {
@@ -173,8 +285,8 @@ var_info_t* register_allocator_t::free(int index) {
     reg_t* reg = get_register(index);
     var_info_t* old_content = reg->content;
     
-    // Free the register, store the variable and sort the heap
-    free(reg, true, true);
+    // Free the register and store the variable
+    free(reg, true);
     return old_content;
 }
 
@@ -183,7 +295,7 @@ void register_allocator_t::free(var_info_t* var, bool store) {
     for (auto* reg : registers) {
 
         if (reg->content == var) {
-            free(reg, store, false);
+            free(reg, store);
             return;
         }
         
@@ -193,19 +305,296 @@ void register_allocator_t::free(var_info_t* var, bool store) {
 
 void register_allocator_t::store_context() {
 
+    scope_t* global_scope = parent->symbol_table.get_global_scope();
+
     for (reg_t* reg : registers) {
         if (reg->content == nullptr) continue;
 
-        if (!parent->symbol_table.is_scope_reachable(reg->content->scope)) continue;
+        var_info_t* var = reg->content;
+        bool reachable = parent->symbol_table.is_scope_reachable(var->scope);
+
+        // The callee saves the register, so a local only it can change keeps its value
+        const live_range_t* range = var->range;
+        bool local = !var->is_temp && var->scope != global_scope && range != nullptr && !range->address_taken;
+        if (reg->index >= CALLER_SAVED_COUNT && local && reachable) continue;
+
+        if (local && reachable && is_preserved(var)) {
+
+            reg_t* preserved = nullptr;
+            for (int i = CALLER_SAVED_COUNT; i < (int) registers.size() && preserved == nullptr; i++) {
+
+                reg_t* candidate = registers[i];
+                if (candidate->reserved || candidate->locked || parent->coloring.is_claimed(i, position)) continue;
+                if (candidate->content == nullptr || is_dead(candidate)) preserved = candidate;
+            }
+
+            if (preserved != nullptr) {
+                free(preserved, false);
+                move_instr(parent, preserved->index, reg->index);
+
+                int index = preserved->index;
+                *preserved = *reg;
+                preserved->index = index;
+
+                free(reg, false);
+                continue;
+            }
+        }
+
+        // Free the register, store the variable if it is reachable
+        if (reachable || reg->index < CALLER_SAVED_COUNT) free(reg, reachable);
+
+    }
+}
 
-        // Free the register, store the variable and dont sort the heap
-        free(reg, true, false);
+void register_allocator_t::release_address_taken() {
+
+    for (reg_t* reg : registers) {
 
+        if (reg->content == nullptr) continue;
+
+        const live_range_t* range = reg->content->range;
+        if (range != nullptr && range->address_taken) free(reg, true);
     }
+}
 
-    // re-heapify the vector
-    //std::make_heap(registers.begin(), registers.end(), reg_ptr_cmp());
+void register_allocator_t::free_temporaries() {
 
+    for (reg_t* reg : registers) {
+        if (reg->content != nullptr && (reg->temp || reg->content->is_temp)) free(reg, false);
+    }
+}
+
+void register_allocator_t::free_temporaries(const register_state_t& keep) {
+
+    for (int i = 0; i < (int) registers.size(); i++) {
+
+        reg_t* reg = registers[i];
+        if (reg->content == nullptr || reg->content == keep[i].content) continue;
+
+        if (reg->temp || reg->content->is_temp) free(reg, false);
+    }
+}
+
+register_state_t register_allocator_t::get_state() {
+
+    register_state_t state;
+    for (reg_t* reg : registers) {
+        state.push_back(*reg);
+        state.back().locked = false;
+    }
+    return state;
+}
+
+void register_allocator_t::set_state(const register_state_t& state) {
+
+    for (int i = 0; i < (int) registers.size(); i++) {
+        bool locked = registers[i]->locked;
+        *registers[i] = state[i];
+        registers[i]->locked = locked;
+    }
+}
+
+register_state_t register_allocator_t::common_state(const register_state_t& a, const register_state_t& b) {
+
+    register_state_t state = a;
+
+    for (int i = 0; i < (int) state.size(); i++) {
+
+        reg_t& reg = state[i];
+        if (reg.content == nullptr) continue;
+
+        if (reg.content != b[i].content) {
+            reg.content = nullptr;
+            reg.temp = false;
+            reg.changed = false;
+            reg.last_changed = 0;
+            reg.position = 0;
+            continue;
+        }
+
+        reg.changed = reg.changed || b[i].changed;
+        reg.last_changed = std::max(reg.last_changed, b[i].last_changed);
+        reg.position = std::max(reg.position, b[i].position);
+    }
+
+    return state;
+}
+
+// Changed variables and temporaries are lost if their register is given to another variable on one path only
+static bool is_lockable(const reg_t* reg) {
+    return reg->content != nullptr && (reg->changed || reg->temp || reg->content->is_temp);
+}
+
+std::vector<bool> register_allocator_t::lock_registers() {
+
+    std::vector<bool> locks;
+    for (reg_t* reg : registers) {
+        locks.push_back(reg->locked);
+        if (is_lockable(reg)) reg->locked = true;
+    }
+    return locks;
+}
+
+void register_allocator_t::restore_locks(const std::vector<bool>& locks) {
+
+    for (int i = 0; i < (int) registers.size(); i++) registers[i]->locked = locks[i];
+}
+
+int register_allocator_t::count_lockable() {
+
+    int count = 0;
+    for (reg_t* reg : registers) {
+        if (is_lockable(reg)) count++;
+    }
+    return count;
+}
+
+void register_allocator_t::store_changed() {
+
+    for (reg_t* reg : registers) {
+
+        if (reg->content == nullptr || !reg->changed || reg->temp || reg->content->is_temp) continue;
+
+        if (!is_dead(reg)) write_back(reg);
+        reg->changed = false;
+    }
+}
+
+register_state_t register_allocator_t::join_state(const register_state_t& a, const register_state_t& b) {
+
+    register_state_t state = a;
+
+    for (int i = 0; i < (int) state.size(); i++) {
+
+        reg_t& reg = state[i];
+        if (reg.content == nullptr) continue;
+
+        // Temporaries do not survive statements and variables whose address is taken may change through pointers
+        bool keep = reg.content == b[i].content && !reg.temp && !reg.content->is_temp && !is_dead(&reg);
+        if (keep && reg.content->range != nullptr && reg.content->range->address_taken) keep = false;
+
+        if (!keep) {
+            reg.content = nullptr;
+            reg.temp = false;
+            reg.changed = false;
+            reg.last_changed = 0;
+            reg.position = 0;
+            continue;
+        }
+
+        // The variable has to be stored later if either path changed it
+        reg.changed = reg.changed || b[i].changed;
+        reg.last_changed = std::max(reg.last_changed, b[i].last_changed);
+        reg.position = std::max(reg.position, b[i].position);
+    }
+
+    return state;
+}
+
+register_state_t register_allocator_t::loop_state(const std::unordered_set<symbol_t>* assigned) {
+
+    register_state_t current = get_state();
+    register_state_t state = join_state(current, current);
+
+    for (reg_t& reg : state) {
+        if (reg.content == nullptr || reg.content->is_array) continue;
+        if (assigned == nullptr || assigned->count(reg.content->name)) reg.changed = true;
+    }
+    return state;
+}
+
+void register_allocator_t::reconcile(const register_state_t& state) {
+
+    // Registers holding a variable the state keeps in another register, paired with that register
+    std::vector<std::pair<reg_t*, reg_t*>> moves;
+
+    // Store and free the variables the state does not keep, and store changed variables the state
+    // assumes to be unchanged
+    for (int i = 0; i < (int) registers.size(); i++) {
+
+        reg_t* reg = registers[i];
+        if (reg->content == nullptr) continue;
+
+        if (reg->content == state[i].content) {
+            if (reg->changed && !state[i].changed && !is_dead(reg)) {
+                write_back(reg);
+                reg->changed = false;
+            }
+            continue;
+        }
+
+        reg_t* destination = nullptr;
+        for (int j = 0; j < (int) state.size() && !reg->temp; j++) {
+            if (state[j].content == reg->content) destination = registers[j];
+        }
+
+        if (destination != nullptr) moves.push_back({reg, destination});
+        else free(reg, !reg->temp);
+    }
+
+    // Move variables to where the state expects them. A move waits until its destination is empty,
+    // when the remaining moves form a cycle one of the variables is stored and loaded again instead
+    while (!moves.empty()) {
+
+        auto next = std::find_if(moves.begin(), moves.end(), [](const auto& m) { return m.second->content == nullptr; });
+
+        if (next == moves.end()) {
+            free(moves.front().first, true);
+            moves.erase(moves.begin());
+            continue;
+        }
+
+        reg_t* source = next->first;
+        reg_t* destination = next->second;
+        moves.erase(next);
+
+        move_instr(parent, destination->index, source->index);
+
+        destination->content = source->content;
+        destination->changed = source->changed;
+        free(source, false);
+
+        if (destination->changed && !state[destination->index].changed) {
+            write_back(destination);
+            destination->changed = false;
+        }
+    }
+
+    // Load the variables the state expects in registers
+    for (int i = 0; i < (int) registers.size(); i++) {
+
+        reg_t* reg = registers[i];
+
+        // A variable that is no longer live is not read again, like a parameter whose stack slot was never written
+        bool dead = state[i].content != nullptr && !state[i].content->is_temp && is_dead(&state[i]);
+        if (state[i].content != nullptr && reg->content != state[i].content && !dead) load(reg, state[i].content);
+
+        bool locked = reg->locked;
+        *reg = state[i];
+        if (dead) free(reg, false);
+        reg->locked = locked;
+    }
+}
+
+bool register_allocator_t::preload(var_info_t* var, int spare) {
+
+    if (already_allocated(var)) return true;
+
+    int free_count = 0;
+    for (reg_t* reg : registers) {
+        if (!reg->reserved && (reg->content == nullptr || is_dead(reg))) free_count++;
+    }
+
+    if (free_count <= spare) return false;
+
+    // Same choice as allocate, but only registers whose content is not needed
+    reg_t* front = choose_home(var);
+    if (front == nullptr || (front->content != nullptr && !is_dead(front))) front = choose_register(is_preserved(var));
+    if (front->content != nullptr && !is_dead(front)) return false;
+
+    assign(front, var, true, false);
+    return true;
 }
 
 void register_allocator_t::free_scope(scope_t* scope_to_free, bool store_globals) {
@@ -216,18 +605,12 @@ void register_allocator_t::free_scope(scope_t* scope_to_free, bool store_globals
 
         if (reg->content == nullptr) continue;
  
-        bool globals = store_globals != (reg->content->scope == global_scope);
-        if (reg->content->scope != scope_to_free && globals) continue;
-
-        bool store = reg->content->scope != scope_to_free;
+        bool is_global = reg->content->scope == global_scope;
+        if (reg->content->scope != scope_to_free && !(is_global && store_globals)) continue;
 
-        // Free the register and store it if it is a global or belongs to an outer scope
-        free(reg, store, false);
+        // Free the register and store it if it is a global, variables of outer scopes stay in their registers
+        free(reg, is_global);
     }
-
-    // re-heapify the vector
-    //std::make_heap(registers.begin(), registers.end(), reg_ptr_cmp());
-
 }
 
 void register_allocator_t::touch(int register_index, bool has_changed) {
@@ -237,10 +620,8 @@ void register_allocator_t::touch(int register_index, bool has_changed) {
 
     // Update timer
     reg->last_changed = parent->instr_cnt;
+    reg->position     = position;
     reg->changed      = has_changed;
-
-    // Re-heapify the vector
-    //std::make_heap(registers.begin(), registers.end(), reg_ptr_cmp());
 } 
 
 var_info_t* register_allocator_t::give_ownership(int register_index, var_info_t* new_owner) {
@@ -255,15 +636,14 @@ var_info_t* register_allocator_t::give_ownership(int register_index, var_info_t*
     var_info_t* old_content = reg->content;
 
     // If variable is not temporary, store it
-    free(reg, !reg->temp, false);
+    free(reg, !reg->temp);
 
     reg->content = new_owner;
     reg->last_changed = parent->instr_cnt;
+    reg->position = position;
     reg->temp = false;  
     reg->changed = false;
 
-    //std::make_heap(registers.begin(), registers.end(), reg_ptr_cmp());
-
     return old_content;
 }
 
@@ -274,6 +654,11 @@ bool register_allocator_t::is_temporary(int register_index) {
     return reg->content->is_temp;
 }
 
+var_info_t* register_allocator_t::get_content(int register_index) {
+    reg_t* reg = get_register(register_index);
+    return (reg != nullptr) ? reg->content : nullptr;
+}
+
 bool register_allocator_t::already_allocated(var_info_t* var) {
 
     for (auto reg : registers) {
@@ -0,0 +1,234 @@
+#include "../include/register_coloring.h"
+
+#include <algorithm>
+#include <tuple>
+
+void register_coloring_t::clear() {
+    nodes.clear();
+    node_index.clear();
+    claims.clear();
+}
+
+void register_coloring_t::color(liveness_t& liveness) {
+
+    clear();
+
+    build(liveness);
+    coalesce(liveness);
+    simplify_and_select();
+
+    for (int i = 0; i < (int) nodes.size(); i++) {
+
+        int color = nodes[find(i)].color;
+        nodes[i].range->home = color;
+
+        if (color >= 0) claims.push_back((claim_t){color, nodes[i].range->start, nodes[i].range->end});
+    }
+}
+
+bool register_coloring_t::is_claimed(int reg, int position) const {
+
+    for (const claim_t& claim : claims) {
+        if (claim.home == reg && claim.start <= position && position <= claim.end) return true;
+    }
+    return false;
+}
+
+int register_coloring_t::arrives_in(int node) {
+
+    for (int i = 0; i < (int) nodes.size(); i++) {
+        if (find(i) == node && nodes[i].range->arrives_in >= 0) return nodes[i].range->arrives_in;
+    }
+    return -1;
+}
+
+int register_coloring_t::find(int node) {
+    while (nodes[node].alias != node) node = nodes[node].alias;
+    return node;
+}
+
+int register_coloring_t::degree(int node, const std::vector<bool>& removed) {
+
+    int result = 0;
+    for (int neighbour : nodes[node].adjacent) {
+        if (!removed[neighbour]) result++;
+    }
+    return result;
+}
+
+void register_coloring_t::build(liveness_t& liveness) {
+
+    // Arrays keep their address in a register and variables whose address is taken live in memory
+    std::vector<std::pair<const node_t*, live_range_t*>> candidates;
+    for (auto& kv : liveness.get_ranges()) {
+
+        live_range_t* range = &kv.second;
+        range->home = -1;
+
+        bool is_array = kv.first->kind == NODE_SIMPLE_ARRAY_DECL || kv.first->kind == NODE_INIT_LIST_ARRAY_DECL || kv.first->kind == NODE_STR_ARRAY_DECL;
+        if (is_array || range->address_taken || range->end < range->start) continue;
+
+        candidates.push_back({kv.first, range});
+    }
+
+    // Number the nodes in declaration order so the coloring does not depend on the hash order of the ranges
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        const lex::token* ta = a.first->tokens.front();
+        const lex::token* tb = b.first->tokens.front();
+        return std::make_tuple(a.second->start, ta->line_number, ta->column_number) < std::make_tuple(b.second->start, tb->line_number, tb->column_number);
+    });
+
+    for (auto& candidate : candidates) {
+        node_index[candidate.first] = nodes.size();
+        nodes.push_back((node_info_t){candidate.second, {}, (int)nodes.size(), candidate.second->weight, -1});
+    }
+
+    for (int i = 0; i < (int) nodes.size(); i++) {
+        for (int j = i + 1; j < (int) nodes.size(); j++) {
+
+            const live_range_t* a = nodes[i].range;
+            const live_range_t* b = nodes[j].range;
+
+            int overlap_start = std::max(a->start, b->start);
+            int overlap_end = std::min(a->end, b->end);
+
+            if (overlap_start > overlap_end) continue;
+
+            // A copy from a variable ending at the statement to one starting there does not make them interfere
+            bool copy_only = false;
+            if (overlap_start == overlap_end) {
+                for (const copy_t& copy : liveness.get_copies()) {
+                    if (copy.position != overlap_start) continue;
+
+                    auto dest = node_index.find(copy.dest);
+                    auto src = node_index.find(copy.src);
+                    if (dest == node_index.end() || src == node_index.end()) continue;
+
+                    if ((dest->second == i && src->second == j) || (dest->second == j && src->second == i)) copy_only = true;
+                }
+            }
+
+            if (copy_only) continue;
+
+            nodes[i].adjacent.insert(j);
+            nodes[j].adjacent.insert(i);
+        }
+    }
+}
+
+void register_coloring_t::coalesce(liveness_t& liveness) {
+
+    std::vector<bool> removed(nodes.size(), false);
+
+    for (const copy_t& copy : liveness.get_copies()) {
+
+        auto dest = node_index.find(copy.dest);
+        auto src = node_index.find(copy.src);
+        if (dest == node_index.end() || src == node_index.end()) continue;
+
+        int a = find(dest->second);
+        int b = find(src->second);
+
+        if (a == b || nodes[a].adjacent.count(b)) continue;
+
+        // Briggs test: the merged node has fewer than COLOR_COUNT neighbours of significant degree
+        std::set<int> merged = nodes[a].adjacent;
+        merged.insert(nodes[b].adjacent.begin(), nodes[b].adjacent.end());
+
+        int significant = 0;
+        for (int neighbour : merged) {
+            int d = degree(neighbour, removed);
+
+            // A neighbour of both loses one edge when they merge
+            if (nodes[a].adjacent.count(neighbour) && nodes[b].adjacent.count(neighbour)) d--;
+            if (d >= COLOR_COUNT) significant++;
+        }
+
+        if (significant >= COLOR_COUNT) continue;
+
+        // Merge b into a
+        for (int neighbour : nodes[b].adjacent) {
+            nodes[neighbour].adjacent.erase(b);
+            nodes[neighbour].adjacent.insert(a);
+            nodes[a].adjacent.insert(neighbour);
+        }
+        nodes[b].adjacent.clear();
+        nodes[b].alias = a;
+        nodes[a].weight += nodes[b].weight;
+        removed[b] = true;
+    }
+}
+
+void register_coloring_t::simplify_and_select() {
+
+    std::vector<bool> removed(nodes.size(), false);
+    std::vector<int> stack;
+
+    int remaining = 0;
+    for (int i = 0; i < (int) nodes.size(); i++) {
+        if (find(i) != i) removed[i] = true;
+        else remaining++;
+    }
+
+    while (remaining > 0) {
+
+        int chosen = -1;
+
+        // Remove a node that is guaranteed to get a color
+        for (int i = 0; i < (int) nodes.size() && chosen == -1; i++) {
+            if (!removed[i] && degree(i, removed) < COLOR_COUNT) chosen = i;
+        }
+
+        // Otherwise optimistically push the cheapest node to spill, it may still get a color
+        if (chosen == -1) {
+            double min_cost = 0;
+            for (int i = 0; i < (int) nodes.size(); i++) {
+                if (removed[i]) continue;
+
+                double cost = (double)nodes[i].weight / degree(i, removed);
+                if (chosen == -1 || cost < min_cost) {
+                    chosen = i;
+                    min_cost = cost;
+                }
+            }
+        }
+
+        removed[chosen] = true;
+        stack.push_back(chosen);
+        remaining--;
+    }
+
+    while (!stack.empty()) {
+
+        int node = stack.back();
+        stack.pop_back();
+
+        // Parameters passed in registers keep them, the colors of those not colored yet are left to them
+        std::vector<bool> used(COLOR_COUNT, false);
+        for (int neighbour : nodes[node].adjacent) {
+            int color = nodes[neighbour].color;
+            if (color < 0) color = arrives_in(neighbour);
+            if (color >= 0) used[color] = true;
+        }
+
+        int arrival = arrives_in(node);
+        if (arrival >= 0 && !used[arrival]) {
+            nodes[node].color = arrival;
+            continue;
+        }
+
+        // Variables live across a call try the callee saved registers first
+        bool preserved = false;
+        for (int i = 0; i < (int) nodes.size(); i++) {
+            if (find(i) == node) preserved |= nodes[i].range->last_call >= 0;
+        }
+
+        for (int i = 0; i < COLOR_COUNT; i++) {
+            int color = (preserved) ? (i + CALLER_SAVED_COUNT) % COLOR_COUNT : i;
+            if (!used[color]) {
+                nodes[node].color = color;
+                break;
+            }
+        }
+    }
+}
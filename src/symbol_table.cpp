@@ -30,21 +30,25 @@ std::string label_allocator_t::get_label_name() {
     return result;
 }
 
-std::string scope_name_allocator_t::get_name(const std::string& id) {
+symbol_t scope_name_allocator_t::get_name(const std::string& id) {
 
     if (name_counter.count(id)) {
-        return id + ":" + std::to_string(name_counter[id]++);
+        return get_interner().intern(id + ":" + std::to_string(name_counter[id]++));
     } else {
         name_counter.insert({id, 1});
-        return id + ":0";
+        return get_interner().intern(id + ":0");
     }
 }
 
 bool var_info_t::operator==(const var_info_t& other) {
 
+    // Parameters passed in registers have no address
+    bool same_address = (address == nullptr || other.address == nullptr) ? address == other.address :
+                        address->get_address_string() == other.address->get_address_string();
+
     return  name    == other.name &&
             type    == other.type &&
-            address->get_address_string() == other.address->get_address_string() &&
+            same_address &&
             is_pointer == other.is_pointer;
 }
 
@@ -60,25 +64,22 @@ func_info_t::func_info_t(const func_decl_t* decl, translator_t* t) {
     // If the function has no parameters, finish
     if (decl->param_list == nullptr) return;
 
-    // Loop over parameters and add them to the param_info vector
-    param_decls_t* current = decl->param_list;
-
     // Loop over params and build param type vector
     std::vector<int> param_types;
     int param_count = 0;
-    while (current != nullptr) {
-        if (current->first->is_pointer) {
+    for (param_decl_t* param : *decl->param_list) {
+        if (param->is_pointer) {
             param_types.push_back(0);
         } else {
-            param_types.push_back(current->first->type);
+            param_types.push_back(param->type);
         }
         param_count++;
-        current = current->rest;
     }
     
-    // Loop backwards over param_types and calculate stack alignment for passing parameters
+    // Loop backwards over param_types and calculate stack alignment for passing parameters, the first
+    // parameters are passed in registers
     int total = 0;
-    while (!param_types.empty()) {
+    while (param_types.size() > REGISTER_PARAM_COUNT) {
         
         int current_type = param_types.back();
         int current_size = t->type_table.at(current_type)->size;
@@ -97,21 +98,25 @@ func_info_t::func_info_t(const func_decl_t* decl, translator_t* t) {
 
     total_stack_size = total;
 
-    // Loop over parameters and add them to the param_info vector
-    current = decl->param_list;
-
     // If the parameters on stack are 4 aligned, two bytes will be pushed for alignment
     // Therefore offset start will be 4, otherwise 2
     int current_base_offset = 2 + (6 - total_stack_size % 4) % 4;
     int param_index = 0;
 
-    while (current != nullptr) {
+    // Loop over parameters and add them to the param_info vector
+    for (param_decl_t* param : *decl->param_list) {
         
         var_info_t param_info;
-        param_info.name = current->first->id;
-        param_info.id = current->first->id;
-        param_info.type = current->first->type;
-        param_info.is_pointer = current->first->is_pointer;
+        param_info.name = param->id;
+        param_info.type = param->type;
+        param_info.is_pointer = param->is_pointer;
+
+        if (param_index < REGISTER_PARAM_COUNT) {
+            param_info.address = nullptr;
+            param_vector.push_back(param_info);
+            param_index++;
+            continue;
+        }
 
         int current_size = (param_info.is_pointer) ? POINTER_SIZE : t->type_table.at(param_info.type)->size;
 
@@ -139,7 +144,6 @@ func_info_t::func_info_t(const func_decl_t* decl, translator_t* t) {
         }
 
         param_vector.push_back(param_info);        
-        current = current->rest;
         param_index++;
     }
 }
@@ -171,16 +175,16 @@ int func_info_t::get_alignment(int param_index) {
 }
 
 scope_t::scope_t() : total_size(0), base_offset(0), inherit_scope(false) {
-    data = std::unordered_map<std::string, var_info_t*>();
+    data = std::unordered_map<symbol_t, var_info_t*>();
 }
 
 scope_t::scope_t(bool _inherit_scope, int _base_offset) : total_size(0), base_offset(_base_offset), inherit_scope(_inherit_scope) {
-    data = std::unordered_map<std::string, var_info_t*>();
+    data = std::unordered_map<symbol_t, var_info_t*>();
 }
 
 scope_t::~scope_t() {
     
-    for (std::pair<std::string, var_info_t*> kv_pair : data) {
+    for (std::pair<symbol_t, var_info_t*> kv_pair : data) {
         delete kv_pair.second;
     }
     data.clear();
@@ -217,30 +221,26 @@ int scope_t::align(int size_to_align_to) {
     return alignment;
 }
 
-var_info_t* scope_t::at(const std::string& key) {
-    if (data.count(key)) {
-        return data[key];
-    } else {
-        return nullptr;
-    }
+var_info_t* scope_t::at(symbol_t key) {
+    auto it = data.find(key);
+    return (it != data.end()) ? it->second : nullptr;
 }
 
-var_info_t* scope_t::operator[](const std::string& key) {
+var_info_t* scope_t::operator[](symbol_t key) {
     return data[key];
 }
 
-void scope_t::add(const std::string& name, int size, var_info_t* varinfo) {
+void scope_t::add(symbol_t name, int size, var_info_t* varinfo) {
     total_size += size;
     data.insert({name, varinfo});
 }
 
-void scope_t::remove(const std::string& name) {
+void scope_t::remove(symbol_t name) {
     data.erase(name);
 }
 
 
 symbol_table_t::symbol_table_t() {
-    name_alloc = scope_name_allocator_t(); 
 
     // Create global scope
     push_scope(false);
@@ -258,7 +258,7 @@ symbol_table_t::~symbol_table_t() {
     function_table.clear();
 }
 
-var_info_t* symbol_table_t::get_var(const std::string& key) {
+var_info_t* symbol_table_t::get_var(symbol_t key) {
 
     var_info_t* result = nullptr;
 
@@ -273,11 +273,11 @@ var_info_t* symbol_table_t::get_var(const std::string& key) {
     // If symbol not found yet, look at the global scope
     result = scope_stack.front()->at(key);
 
-    if (!result) translation_error::throw_error("Variable " + key + " does not exist in the symbol table", nullptr);
+    if (!result) translation_error::throw_error("Variable " + symbol_name(key) + " does not exist in the symbol table", nullptr);
     return result;
 }
 
-var_info_t* symbol_table_t::add_var(const std::string& name, const int type, const int size, addr_info_t* addr) {
+var_info_t* symbol_table_t::add_var(symbol_t name, const int type, const int size, addr_info_t* addr) {
 
     var_info_t* varinfo = new var_info_t();
     varinfo->name = name;
@@ -286,31 +286,22 @@ var_info_t* symbol_table_t::add_var(const std::string& name, const int type, con
     varinfo->address = addr;
     varinfo->is_pointer = false;
 
-    if (is_global_scope()) {
-        varinfo->id = name;
-    } else {
-        varinfo->id = name_alloc.get_name(name);
-    }
-
     get_current_scope()->add(name, size, varinfo);
     return varinfo;
 }
 
-func_info_t* symbol_table_t::get_func(const std::string& name) {
-    if (function_table.count(name)) {
-        return function_table[name];
-    } else {
-        return nullptr;
-    }
+func_info_t* symbol_table_t::get_func(symbol_t name) {
+    auto it = function_table.find(name);
+    return (it != function_table.end()) ? it->second : nullptr;
 }
 
-void symbol_table_t::add_func(const std::string& name, func_info_t* f) {
+void symbol_table_t::add_func(symbol_t name, func_info_t* f) {
 
     // TODO: Check if a function with that name already exists
     function_table.insert(std::make_pair(name, f));
 }
 
-void symbol_table_t::remove_func(const std::string& name) {
+void symbol_table_t::remove_func(symbol_t name) {
     
     func_info_t* info = get_func(name);
 
@@ -0,0 +1,33 @@
+#include "../include/token_arena.h"
+
+using namespace lex;
+
+token_arena_t::token_arena_t() {
+    used = TOKEN_BLOCK_SIZE;
+}
+
+token_arena_t::~token_arena_t() {
+    clear();
+}
+
+token* token_arena_t::allocate(tag_t tag, int line, int column) {
+
+    // Start a new block when the current one is full
+    if (used == TOKEN_BLOCK_SIZE) {
+        blocks.push_back(new token[TOKEN_BLOCK_SIZE]);
+        used = 0;
+    }
+
+    token* result = &blocks.back()[used++];
+    result->tag = tag;
+    result->line_number = line;
+    result->column_number = column;
+    result->lexeme = { 0, 0 };
+    return result;
+}
+
+void token_arena_t::clear() {
+    for (token* block : blocks) delete[] block;
+    blocks.clear();
+    used = TOKEN_BLOCK_SIZE;
+}
@@ -4,7 +4,7 @@
 #include <ostream>
 #include <iostream>
 
-void translation_error::throw_error(const std::string& error, const undoable_t* node) {
+void translation_error::throw_error(const std::string& error, const node_t* node) {
 
     if (node) {
         auto line = std::to_string(node->tokens.front()->line_number);
@@ -15,7 +15,7 @@ void translation_error::throw_error(const std::string& error, const undoable_t*
     }
 }
 
-translator_t::translator_t() {
+translator_t::translator_t(const translator_options_t& _options) : options(_options) {
 
     reg_alloc.set_parent(this);
     // print standard defines into file
@@ -66,6 +66,43 @@ void translator_t::print_instruction_row(const std::string& instr, bool tab, boo
     instr_cnt++;
 }
 
+void translator_t::emit(const ir_instr_t& instr) {
+
+    // Initializers of globals run before main, they are printed with the global data
+    if (data_mode) ir_print_instr(defines_and_global_output, instr, special_registers);
+    else code.emit(instr);
+
+    last_was_ret = instr.op == IR_RET;
+    instr_cnt++;
+}
+
+void translator_t::emit_label(const std::string& label) {
+
+    if (data_mode) defines_and_global_output << label << ":\n";
+    else code.label(label);
+
+    last_was_ret = false;
+    instr_cnt++;
+}
+
+bool translator_t::build_frame(bool save_registers) {
+    return frame.build(code, save_registers);
+}
+
+void translator_t::end_function() {
+
+    if (options.peephole) peephole.optimize(code);
+
+    code.print(output, special_registers);
+    code.clear();
+
+    print_instruction_row("", false, false);
+}
+
+void translator_t::discard_function() {
+    code.clear();
+}
+
 void translator_t::static_alloc(const std::string& name, int size, int value) {
 
     set_data_mode(true);
@@ -186,5 +223,8 @@ void translator_t::print_to_file(std::ofstream& file) {
 
     set_data_mode(false);
 
+    // Instructions outside of any function
+    if (!code.empty()) end_function();
+
     file << defines_and_global_output.str() << "\n" << output.str();
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "../../include/lexer.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Measures the throughput of the lexer. Lexes the file given on the command line, or a generated source
+// with every kind of token, the given number of times and prints the best time. Only uses the constructor
+// and get_next_token, so it builds against every version of the lexer.
+//
+// Usage: lexer_benchmark [file.cm] [runs]
+
+#define GENERATED_FUNCTIONS 50000
+#define DEFAULT_RUNS 5
+
+// Writes a source of globals and functions with identifiers, keywords, decimal, hex and char literals,
+// strings, comments and every operator
+static void generate_source(const std::string& filename) {
+
+    std::ofstream out(filename);
+
+    for (int i = 0; i < GENERATED_FUNCTIONS; i++) {
+        out << "int g" << i << " = " << i % 1000 << ";\n";
+        out << "char s" << i << "[] = \"string number " << i << "\";\n";
+    }
+
+    for (int i = 0; i < GENERATED_FUNCTIONS; i++) {
+        out << "// Function " << i << "\n";
+        out << "long f" << i << "(int a int* b) {\n";
+        out << "    int c = a + g" << i << " * 0x" << std::hex << i << std::dec << ";\n";
+        out << "    char d = '" << (char) ('a' + i % 26) << "';\n";
+        out << "    /* loop over the values */\n";
+        out << "    while ((c < 100) && !(c == a) || (c >= 7)) {\n";
+        out << "        c = (c << 1) - (c >> 2) & 255 | *b;\n";
+        out << "        if (c != d) { break 0; } else { continue; }\n";
+        out << "    }\n";
+        out << "    return c <= a;\n";
+        out << "}\n";
+    }
+}
+
+int main(int argc, char const *argv[]) {
+
+    std::string filename = (argc > 1) ? argv[1] : "lexer_benchmark_input.cm";
+    int runs = (argc > 2) ? std::stoi(argv[2]) : DEFAULT_RUNS;
+
+    if (argc <= 1) generate_source(filename);
+
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in) {
+        std::cout << "Could not open " << filename << std::endl;
+        return 1;
+    }
+    double megabytes = in.tellg() / (1024.0 * 1024.0);
+
+    double best = 0;
+    long tokens = 0;
+
+    for (int run = 0; run < runs; run++) {
+
+        auto start = std::chrono::steady_clock::now();
+
+        lex::lexer lexer(filename);
+
+        tokens = 0;
+        while (lexer.get_next_token()->tag != lex::tag_t::eof) tokens++;
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (run == 0 || elapsed.count() < best) best = elapsed.count();
+    }
+
+    std::cout << filename << ": " << tokens << " tokens, " << megabytes << " MB" << std::endl;
+    std::cout << "Best of " << runs << ": " << best << " s, " << megabytes / best << " MB/s, "
+              << tokens / best / 1e6 << " million tokens/s" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+# Compiles every program in this directory with each optimization turned off in turn, runs it and checks
+# that main returns the value given on its first line, "// Returns <value>". Prints the number of
+# instructions executed with every pass, and without those passes that change it.
+#
+# Usage: python3 tests/optimization_tests/run_tests.py [path to compiler] [program.cm ...]
+import glob
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import simulator
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+
+CONFIGURATIONS = [
+    [],
+    ["--regalloc=graph"],
+    ["--no-peephole"],
+    ["--no-constant-propagation"],
+    ["--no-dead-code-elimination"],
+    ["--no-inline"],
+    ["--no-loop-invariant-motion"],
+    ["--no-tail-calls"],
+    ["--no-unroll"],
+    ["--unroll=2"],
+    ["--regalloc=graph", "--no-unroll", "--no-inline"],
+    ["--no-peephole", "--no-constant-propagation", "--no-dead-code-elimination", "--no-inline",
+     "--no-loop-invariant-motion", "--no-tail-calls", "--no-unroll"],
+]
+
+def expected_result(path):
+    with open(path) as f:
+        words = f.readline().split()
+    if len(words) != 3 or words[:2] != ["//", "Returns"]:
+        return None
+    return int(words[2])
+
+# Returns the value main returns and the instructions executed, or an error message
+def compile_and_run(compiler, path, flags):
+    with tempfile.TemporaryDirectory() as work:
+        # The compiler takes a path relative to the directory it runs in and writes output.a there
+        shutil.copy(path, os.path.join(work, "test.cm"))
+        done = subprocess.run([compiler, "test.cm"] + flags, cwd = work, capture_output = True, text = True)
+
+        output = os.path.join(work, "output.a")
+        if done.returncode != 0 or not os.path.exists(output):
+            errors = [line for line in done.stdout.split("\n") if "Error" in line]
+            return None, "compilation failed" + (": " + re.sub(r"\x1b\[[0-9;]*m", "", errors[0]) if errors else "")
+
+        with open(output) as f:
+            text = f.read()
+
+    try:
+        result, executed, _ = simulator.run(text)
+    except (simulator.SimulationError, KeyError, ValueError) as e:
+        return None, str(e)
+
+    return result, executed
+
+def main():
+    compiler = os.path.abspath(sys.argv[1] if len(sys.argv) > 1 else "compiler")
+    programs = sys.argv[2:] or sorted(glob.glob(os.path.join(TEST_DIR, "*.cm")))
+
+    failures = 0
+    for path in programs:
+        name = os.path.basename(path)
+        expected = expected_result(path)
+        if expected is None:
+            print("%s: missing \"// Returns <value>\" on the first line" % name)
+            failures += 1
+            continue
+
+        counts = []
+        default = None
+        for flags in CONFIGURATIONS:
+            result, executed = compile_and_run(compiler, path, flags)
+            label = " ".join(flags) or "default"
+
+            if result is None:
+                print("%s [%s]: %s" % (name, label, executed))
+                failures += 1
+            elif result != expected:
+                print("%s [%s]: returned %d, expected %d" % (name, label, result, expected))
+                failures += 1
+            elif default is None:
+                default = executed
+                counts.append("%s=%d" % (label, executed))
+            elif executed != default:
+                counts.append("[%s]=%d" % (label, executed))
+
+        print("%-28s %s" % (name, " ".join(counts)))
+
+    print("%d failure(s)" % failures)
+    sys.exit(1 if failures else 0)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+# Runs the assembly written by the compiler and returns the value main returns, with the number of
+# instructions executed and of memory accesses. Covers the instructions the compiler emits
+import sys
+import re
+
+SP = 15
+NULL = 14
+RR = 12
+
+STACK_TOP = 0x8000
+DATA_START = 0x100
+MAX_STEPS = 5000000
+
+class SimulationError(Exception):
+    pass
+
+def to_signed(value, bits = 32):
+    value &= (1 << bits) - 1
+    return value - (1 << bits) if value & (1 << (bits - 1)) else value
+
+def write(memory, address, value, size):
+    for i in range(size):
+        memory[address + i] = (value >> (8 * i)) & 0xFF
+
+def read(memory, address, size):
+    value = 0
+    for i in range(size):
+        # Memory that was never written reads as a pattern that is easy to spot
+        value |= memory.get(address + i, 0xCD) << (8 * i)
+    return to_signed(value, 8 * size)
+
+# Splits the program into instructions, labels, constants and the contents of memory
+def assemble(text):
+    constants = {}
+    labels = {}
+    data = {}
+    memory = {}
+    instructions = []
+    address = DATA_START
+
+    for line in text.split("\n"):
+        line = line.split(";")[0].strip()
+        if not line:
+            continue
+
+        if line.startswith("const "):
+            _, name, value = line.split()
+            constants[name] = value
+            continue
+
+        if line.startswith(".data "):
+            data[line.split()[1]] = address
+            continue
+
+        directive = re.match(r"^\.(db|dh|dw|ds)\s+(.*)$", line)
+        if directive:
+            kind, values = directive.groups()
+            if kind == "ds":
+                for char in values.strip('"'):
+                    memory[address] = ord(char) & 0xFF
+                    address += 1
+                memory[address] = 0
+                address += 1
+            else:
+                size = {"db": 1, "dh": 2, "dw": 4}[kind]
+                for value in values.split():
+                    write(memory, address, int(value, 0), size)
+                    address += size
+            continue
+
+        if line.endswith(":") and " " not in line:
+            labels[line[:-1]] = len(instructions)
+            continue
+
+        instruction = re.match(r"^(\w+)(?:\[(\d+)\])?\s*(.*)$", line)
+        op, size, args = instruction.groups()
+        operands = [a.strip() for a in args.split(",")] if args else []
+        instructions.append((op, int(size) if size else 0, operands, line))
+
+    return instructions, labels, constants, data, memory
+
+# Loads of memory that was never written are errors unless allow_uninitialized is set, the value loaded
+# is not used then in a correct program, but the load is wasted
+def run(text, max_steps = MAX_STEPS, allow_uninitialized = False):
+    instructions, labels, constants, data, memory = assemble(text)
+
+    def reg(name):
+        return int(constants.get(name, name)[1:])
+
+    def imm(name):
+        return data[name] if name in data else int(name, 0)
+
+    regs = [0] * 16
+    regs[SP] = STACK_TOP
+    compared = (0, 0)
+    pc = 0
+    executed = 0
+    accesses = 0
+
+    while True:
+        if pc >= len(instructions):
+            raise SimulationError("ran past the last instruction")
+        if executed >= max_steps:
+            raise SimulationError("no halt after %d instructions" % max_steps)
+
+        op, size, a, line = instructions[pc]
+        pc += 1
+        executed += 1
+
+        if op == "rjmp" and a[0] == "__halt":
+            return to_signed(regs[RR]), executed, accesses
+
+        if op in ("add", "sub", "mul", "and", "or", "xor", "lsl", "lsr", "asr"):
+            x, y = regs[reg(a[1])], regs[reg(a[2])]
+            result = {
+                "add": lambda: x + y, "sub": lambda: x - y, "mul": lambda: x * y,
+                "and": lambda: x & y, "or": lambda: x | y, "xor": lambda: x ^ y,
+                "lsl": lambda: x << (y & 31), "lsr": lambda: (x & 0xFFFFFFFF) >> (y & 31),
+                "asr": lambda: to_signed(x) >> (y & 31)}[op]()
+            regs[reg(a[0])] = to_signed(result)
+        elif op in ("addi", "subi", "lsli", "lsri", "asri"):
+            x, y = regs[reg(a[1])], imm(a[2])
+            result = {
+                "addi": lambda: x + y, "subi": lambda: x - y, "lsli": lambda: x << y,
+                "lsri": lambda: (x & 0xFFFFFFFF) >> y, "asri": lambda: to_signed(x) >> y}[op]()
+            regs[reg(a[0])] = to_signed(result)
+        elif op == "not":
+            regs[reg(a[0])] = to_signed(~regs[reg(a[1])])
+        elif op == "neg":
+            regs[reg(a[0])] = to_signed(-regs[reg(a[1])])
+        elif op == "move":
+            regs[reg(a[0])] = regs[reg(a[1])]
+        elif op == "movhi":
+            d = reg(a[0])
+            regs[d] = to_signed((regs[d] & 0xFFFF) | (imm(a[2]) << 16))
+        elif op == "movlo":
+            d = reg(a[0])
+            regs[d] = to_signed((regs[d] & ~0xFFFF) | (imm(a[2]) & 0xFFFF))
+        elif op == "cmp":
+            compared = (regs[reg(a[0])], regs[reg(a[1])])
+        elif op == "cmpi":
+            compared = (regs[reg(a[0])], imm(a[1]))
+        elif op in ("breq", "brne", "brlt", "brgt", "brle", "brge", "rjmp"):
+            x, y = compared
+            taken = {
+                "breq": x == y, "brne": x != y, "brlt": x < y, "brgt": x > y,
+                "brle": x <= y, "brge": x >= y, "rjmp": True}[op]
+            if taken:
+                pc = labels[a[0]]
+        elif op == "load":
+            accesses += 1
+            address = regs[reg(a[1])] + imm(a[2])
+            if not allow_uninitialized and any(address + i not in memory for i in range(size)):
+                raise SimulationError("load of memory that was never written: " + line)
+            regs[reg(a[0])] = read(memory, address, size)
+        elif op == "store":
+            accesses += 1
+            write(memory, regs[reg(a[0])] + imm(a[2]), regs[reg(a[1])], size)
+        elif op == "push":
+            accesses += 1
+            regs[SP] -= size
+            write(memory, regs[SP], regs[reg(a[0])], size)
+        elif op == "pop":
+            accesses += 1
+            regs[reg(a[0])] = read(memory, regs[SP], size)
+            regs[SP] += size
+        elif op == "call":
+            accesses += 1
+            regs[SP] -= 2
+            write(memory, regs[SP], pc, 2)
+            pc = labels[a[0]]
+        elif op == "ret":
+            accesses += 1
+            pc = read(memory, regs[SP], 2)
+            regs[SP] += 2
+        elif op == "in":
+            regs[reg(a[0])] = 0
+        else:
+            raise SimulationError("unknown instruction " + line)
+
+        # The zero register can not be written
+        regs[NULL] = 0
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print("Usage: simulator.py output.a")
+        sys.exit(1)
+
+    with open(sys.argv[1]) as f:
+        result, executed, accesses = run(f.read(), allow_uninitialized = True)
+    print(result, executed, accesses)